@@ -163,6 +163,249 @@ extern "C" {
 //! @}
 
 
+//! @defgroup buffer_cache_line Cache line separation
+//!
+//! @details Data of the producer/set thread and of the consumer/get thread is separated by
+//! ::BUFFER_CACHE_LINE_SIZE, e.g. in \ref buffer_enable_stats, \ref buffer_slot and
+//! \ref buffer_chain, so that both threads do not write to the same cache line.
+//!
+//! @{
+
+#ifndef BUFFER_CACHE_LINE_SIZE
+
+  //! @brief Size of a cache line, can be set for all files to match the target
+  #define BUFFER_CACHE_LINE_SIZE 64
+
+#endif
+
+//! @}
+
+
+//! @defgroup buffer_enable_stats Optional statistics counters
+//!
+//! @details The statistics counters of ::buffer_s::stats are activated by setting the
+//! ::BUFFER_ENABLE_STATS define. They count operations, bytes, full and skip events,
+//! wait iterations, the peak occupancy and the number of resets.
+//!
+//! - The define must be set for all files, otherwise not enough space is reserved during
+//!   use and problems occur when calling.
+//! - Each side only writes its own counters, the counters of the producer and the consumer
+//!   are separated by ::BUFFER_CACHE_LINE_SIZE so that they do not add contention.
+//! - Use ::buffer_stats_snapshot() to read the counters.
+
+
+//! @defgroup buffer_enable_snapshot Optional consistent snapshot
+//!
+//! @details ::buffer_copy() and ::buffer_equal() read the elements one after the other, a
+//! monitor thread therefore sees e.g. a ::buffer_s::length that does not match
+//! ::buffer_s::producer_ptr. The versions of ::buffer_s::versions are activated by setting
+//! the ::BUFFER_ENABLE_SNAPSHOT define, ::buffer_snapshot() then returns a consistent view.
+//!
+//! - The define must be set for all files, otherwise not enough space is reserved during
+//!   use and problems occur when calling.
+//! - Each side has its own version like a sequence lock. It is odd while the side changes
+//!   its positions, ::buffer_s::length and ::buffer_s::lines, these are two relaxed stores
+//!   per publish. Handlers are called outside of the change.
+//! - The versions of the producer and the consumer are separated by ::BUFFER_CACHE_LINE_SIZE.
+//! - ::buffer_snapshot() never blocks a side, it reads again if a version has changed and
+//!   gives up after ::BUFFER_SNAPSHOT_RETRIES attempts.
+//! - ::buffer_clear() belongs to the consumer side, like ::buffer_s::consumer_ptr.
+//! - A copy of the unread characters is counted in ::buffer_versions_s::readers,
+//!   ::buffer_grow() keeps retired regions while it is not zero.
+//!
+//! @{
+
+#ifndef BUFFER_SNAPSHOT_RETRIES
+
+  //! @brief Number of attempts of ::buffer_snapshot()
+  #define BUFFER_SNAPSHOT_RETRIES 64
+
+#endif
+
+//! @}
+
+
+//! @defgroup buffer_enable_usdt Optional static tracepoints
+//!
+//! @details Static tracepoints (USDT) are placed on the hot paths by setting the
+//! ::BUFFER_ENABLE_USDT define, the header `sys/sdt.h` (SystemTap) is required.
+//! A probe that is not attached is a single `nop` instruction, the probes can therefore
+//! remain in production builds and be attached to running processes by `bpftrace` or `perf`.
+//!
+//! All probes belong to the provider `buffer` and pass the same arguments:
+//! - `arg0` The buffer object, `buffer_t *`
+//! - `arg1` The value of ::buffer_s::length after the event
+//! - `arg2` The event type ::buffer_probe_event_e
+//!
+//! | Probe      | Event                                                                  |
+//! |------------|------------------------------------------------------------------------|
+//! | `set`      | A character was saved                                                  |
+//! | `get`      | A character was read                                                   |
+//! | `full`     | A set operation found the buffer full, or skipped the character        |
+//! | `empty`    | The last character was read                                            |
+//! | `reset`    | The reset to the start address succeeded, the compare-and-swap         |
+//! | `wait_set` | One wait iteration in ::buffer_set()                                   |
+//! | `wait_get` | One wait iteration in ::buffer_get()                                   |
+//!
+//! Example: `bpftrace -e 'usdt:./app:buffer:full { @[arg0] = count(); }'`
+//!
+//! - If the header is not available, the probes are removed.
+//!
+//! @{
+
+//! @brief Event type passed as third argument of every probe, see: \ref buffer_enable_usdt
+typedef enum buffer_probe_event_e
+{
+    BUFFER_PROBE_SET = 0,       ///< A character was saved
+    BUFFER_PROBE_GET = 1,       ///< A character was read
+    BUFFER_PROBE_FULL = 2,      ///< ::buffer_set() found the buffer full
+    BUFFER_PROBE_SKIP = 3,      ///< ::buffer_set_possible_or_skip() found the buffer full
+    BUFFER_PROBE_EMPTY = 4,     ///< The last character was read
+    BUFFER_PROBE_RESET = 5,     ///< The buffer was reset to the start address
+    BUFFER_PROBE_WAIT_SET = 6,  ///< Wait iteration while the buffer is full
+    BUFFER_PROBE_WAIT_GET = 7,  ///< Wait iteration while the buffer is empty
+}buffer_probe_event_t;
+
+//! @}
+
+
+//! @defgroup buffer_line_index Line offset index
+//!
+//! @details ::buffer_s::lines only tells that a line exists, to find the End-Of-Line character
+//! ::buffer_read_line() reads the characters one by one. With an attached ::buffer_line_index_t
+//! the producer records the position of each End-Of-Line character in a small lock-free side
+//! ring, see ::buffer_line_index_attach(). The consumer then jumps directly to the end of the
+//! line and copies it in one operation, or exposes it with ::buffer_look_line().
+//!
+//! - Costs the producer two stores per line.
+//! - If more lines are waiting than the side ring can hold, the End-Of-Line characters of
+//!   the further lines are searched.
+//!
+//! @{
+
+#ifndef BUFFER_LINE_INDEX_ENTRIES
+
+  //! @brief Number of entries in the side ring, must be a power of two
+  #define BUFFER_LINE_INDEX_ENTRIES 32
+
+#endif
+
+//! @}
+
+
+//! @defgroup buffer_delimiters Line delimiters
+//!
+//! @details A line ends with ::buffer_s::end_of_line_character. With an attached
+//! ::buffer_delimiters_t any character of a set ends a line, e.g. `\n`, `\r` and `;`,
+//! see ::buffer_delimiters_init() and ::buffer_delimiters_attach().
+//!
+//! - The characters drive ::buffer_s::lines, ::buffer_read_line(), ::buffer_look_line()
+//!   and ::buffer_skip_line() like the End-Of-Line character.
+//! - A terminator of several characters, e.g. `\r\n`, only ends a line when all of its
+//!   characters follow each other. Each side keeps the last characters of the stream in
+//!   ::buffer_s::tail_produced and ::buffer_s::tail_consumed, so that a terminator split
+//!   over several calls is found by both sides. ::buffer_read_line() removes the
+//!   terminator from the line.
+//! - Spans are searched with ::buffer_find_end_of_line(). With SSSE3 each character of
+//!   16 is classified at once with two shuffle tables indexed by its nibbles, a single
+//!   character is searched with `memchr()`.
+//!
+//! @{
+
+#ifndef BUFFER_TERMINATOR_SIZE
+
+  //! @brief Maximum number of characters of a terminator, at most 8
+  #define BUFFER_TERMINATOR_SIZE 8
+
+#endif
+
+//! @}
+
+
+//! @defgroup buffer_waiter One-shot waiters
+//!
+//! @details Instead of blocking a thread in ::buffer_get() or polling ::buffer_lines(),
+//! a ::buffer_waiter_t can be armed for one of the transitions ::buffer_wait_event_t,
+//! see ::buffer_waiter_arm(). The thread that causes the transition calls the wake
+//! handler ::buffer_waiter_s::wake once and disarms the waiter.
+//!
+//! - ::BUFFER_WAIT_DATA, a character or record was published. A consumer that needs more
+//!   than the readable characters, e.g. to find a pattern, sets ::buffer_waiter_s::seen
+//!   to their number and is woken by the next publish.
+//! - ::BUFFER_WAIT_LINE, a line was published.
+//! - ::BUFFER_WAIT_SPACE, the buffer was reset and has free space again. A producer whose
+//!   next unit does not fit sets ::buffer_waiter_s::seen to the free characters.
+//! - Stopping the buffer wakes all waiters.
+//! - Containers that manage ::buffer_s::length themselves, e.g. \ref buffer_chain, signal the
+//!   transitions with ::buffer_notify_published() and ::buffer_notify_consumed().
+//! - Without an armed waiter the producer and consumer only pay for one atomic load
+//!   per transition.
+//! - Each transition has one waiter, e.g. one coroutine waits for data and one for space.
+//!
+//! @{
+//! @}
+
+
+//! @defgroup buffer_record Length-prefixed records
+//!
+//! @details Variable-length binary records can be exchanged instead of text. Each record is
+//! stored as a header with its length followed by the payload, see ::buffer_push_record().
+//!
+//! - The producer reserves the whole record with one atomic addition, copies it and publishes
+//!   it with a single update of ::buffer_s::length. The consumer therefore only ever sees
+//!   complete records, see ::buffer_pop_record() and ::buffer_peek_record().
+//! - Records are not counted as lines, ::buffer_s::end_of_line_character has no meaning.
+//! - Records and characters must not be mixed in the same buffer.
+//! - Records are not empty, so a return value of 0 always means that no record was read.
+//!
+//! @{
+
+//! @brief Number of bytes of the header in front of each record
+#define BUFFER_RECORD_HEADER_SIZE (sizeof(size_t))
+
+//! @}
+
+
+//! @defgroup buffer_watermark High and low watermarks
+//!
+//! @details ::buffer_s::on_full is only called when a character is already rejected.
+//! With ::buffer_watermark() a producer can be slowed down before, e.g. with RTS/CTS or
+//! XON/XOFF of a UART.
+//!
+//! - When the occupancy ::buffer_s::length rises to the high watermark, ::buffer_s::watermark_reached
+//!   is set and ::buffer_s::on_watermark_high is called.
+//! - When the occupancy then falls to the low watermark, the flag is cleared and
+//!   ::buffer_s::on_watermark_low is called.
+//! - The signals are edge-triggered, between the watermarks nothing is signaled.
+//! - The edges are detected with the value returned by the atomic update of the length,
+//!   the producer and consumer only pay for a comparison per character.
+//! - The buffer is linear, the free space is only returned when the buffer was read empty,
+//!   see ::buffer_s::on_empty. A low watermark of 0 signals exactly this.
+//!
+//! @{
+//! @}
+
+
+//! @defgroup buffer_grow Capacity growth
+//!
+//! @details The capacity of a buffer is fixed with ::buffer_init(). With ::buffer_grow() the
+//! producer provides a larger region, e.g. in ::buffer_s::on_full, and the buffer moves to it
+//! without being stopped and without copying characters.
+//!
+//! - The buffer is linear, the consumer moves the buffer at the point where it would otherwise
+//!   reset it to ::buffer_s::data. The region is only taken if the buffer was full, until then
+//!   it stays pending in ::buffer_s::region_pending.
+//! - The consumer neither allocates nor frees memory, it puts the replaced region into
+//!   ::buffer_s::region_retired. The producer frees it with the next call of ::buffer_grow()
+//!   that does not overlap a copy of ::buffer_snapshot().
+//! - Only regions of ::buffer_grow() are freed, the memory passed to ::buffer_init() or
+//!   ::buffer_object_allocate() remains with the caller.
+//! - ::buffer_grow_free() frees all regions, ::buffer_object_free() calls it.
+//!
+//! @{
+//! @}
+
+
 /*---------------------------------------------------------------------*
  *  public: type test
  *---------------------------------------------------------------------*/
@@ -272,6 +515,8 @@ typedef enum buffer_flags_e
 //! - ::buffer_s::on_error
 //! - ::buffer_s::on_start
 //! - ::buffer_s::on_stop
+//! - ::buffer_s::on_watermark_high
+//! - ::buffer_s::on_watermark_low
 //!
 //! @param[in,out] object The buffer object
 typedef void (*buffer_action_handler_t)(buffer_t * object);
@@ -300,6 +545,180 @@ typedef char (*buffer_function_char_handler_t)(buffer_t * object);
 #endif
 
 
+//! @brief Transitions of a buffer object on which can be waited, see: \ref buffer_waiter
+typedef enum buffer_wait_event_e
+{
+    BUFFER_WAIT_DATA = 0,  ///< A character or record was published
+    BUFFER_WAIT_LINE = 1,  ///< A line was published
+    BUFFER_WAIT_SPACE = 2, ///< The buffer has free space again
+    BUFFER_WAIT_EVENTS = 3 ///< Number of transitions
+}buffer_wait_event_t;
+
+typedef struct buffer_waiter_s buffer_waiter_t;
+
+//! @brief Wake handler of a waiter
+//!
+//! @details Called once by the thread that caused the transition, the waiter is
+//! disarmed before. The handler may arm the waiter again.
+//!
+//! @param[in,out] waiter The waiter
+typedef void (*buffer_wake_handler_t)(buffer_waiter_t * waiter);
+
+//! @brief One-shot waiter, see: \ref buffer_waiter
+struct buffer_waiter_s
+{
+    buffer_wake_handler_t wake; ///< Called once on the transition
+    void * context;             ///< Freely usable, e.g. a coroutine handle
+    size_t seen;                ///< Number of readable (::BUFFER_WAIT_DATA) or free (::BUFFER_WAIT_SPACE) characters that are not enough, usually 0
+};
+
+
+#ifdef BUFFER_ENABLE_STATS
+
+//! @brief Counters written by the producer/set thread, see: \ref buffer_enable_stats
+typedef struct buffer_stats_producer_s
+{
+    volatile _Atomic(size_t) ops;      ///< Number of successful set operations
+    volatile _Atomic(size_t) bytes_in; ///< Number of saved characters
+    volatile _Atomic(size_t) full;     ///< Number of set operations that found the buffer full
+    volatile _Atomic(size_t) skip;     ///< Number of characters dropped by ::buffer_set_possible_or_skip()
+    volatile _Atomic(size_t) wait;     ///< Number of wait iterations in ::buffer_set()
+    volatile _Atomic(size_t) peak;     ///< Highest value of ::buffer_s::length
+}buffer_stats_producer_t;
+
+//! @brief Counters written by the consumer/get thread, see: \ref buffer_enable_stats
+typedef struct buffer_stats_consumer_s
+{
+    volatile _Atomic(size_t) ops;       ///< Number of successful get operations
+    volatile _Atomic(size_t) bytes_out; ///< Number of read characters
+    volatile _Atomic(size_t) wait;      ///< Number of wait iterations in ::buffer_get()
+    volatile _Atomic(size_t) resets;    ///< Number of times the buffer was reset to its start address
+}buffer_stats_consumer_t;
+
+//! @brief Statistics counters of a buffer object, see: \ref buffer_enable_stats
+//!
+//! @details The padding keeps the counters of each side on their own cache lines.
+typedef struct buffer_stats_s
+{
+    char padding_front[BUFFER_CACHE_LINE_SIZE];   ///< Separation from the previous elements
+    buffer_stats_producer_t producer;             ///< Counters of the producer/set thread
+    char padding_middle[BUFFER_CACHE_LINE_SIZE];  ///< Separation between producer and consumer
+    buffer_stats_consumer_t consumer;             ///< Counters of the consumer/get thread
+    char padding_back[BUFFER_CACHE_LINE_SIZE];    ///< Separation from the following memory
+}buffer_stats_t;
+
+//! @brief Copy of the statistics counters, see: ::buffer_stats_snapshot()
+typedef struct buffer_stats_snapshot_s
+{
+    size_t set_ops;   ///< See ::buffer_stats_producer_s::ops
+    size_t bytes_in;  ///< See ::buffer_stats_producer_s::bytes_in
+    size_t full;      ///< See ::buffer_stats_producer_s::full
+    size_t skip;      ///< See ::buffer_stats_producer_s::skip
+    size_t wait_set;  ///< See ::buffer_stats_producer_s::wait
+    size_t peak;      ///< See ::buffer_stats_producer_s::peak
+    size_t get_ops;   ///< See ::buffer_stats_consumer_s::ops
+    size_t bytes_out; ///< See ::buffer_stats_consumer_s::bytes_out
+    size_t wait_get;  ///< See ::buffer_stats_consumer_s::wait
+    size_t resets;    ///< See ::buffer_stats_consumer_s::resets
+}buffer_stats_snapshot_t;
+
+#endif
+
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+//! @brief Versions of both sides, see: \ref buffer_enable_snapshot
+//!
+//! @details The padding keeps the version of each side and the readers on their own cache line.
+typedef struct buffer_versions_s
+{
+    char padding_front[BUFFER_CACHE_LINE_SIZE];  ///< Separation from the previous elements
+    volatile _Atomic(size_t) producer;           ///< Odd while the producer/set thread changes the metadata
+    char padding_middle[BUFFER_CACHE_LINE_SIZE]; ///< Separation between producer and consumer
+    volatile _Atomic(size_t) consumer;           ///< Odd while the consumer/get thread changes the metadata
+    char padding_back[BUFFER_CACHE_LINE_SIZE];   ///< Separation between consumer and readers
+    volatile _Atomic(size_t) readers;            ///< Number of ::buffer_snapshot() calls copying unread characters
+    char padding_end[BUFFER_CACHE_LINE_SIZE];    ///< Separation from the following memory
+}buffer_versions_t;
+
+//! @brief Consistent view of the metadata, see: ::buffer_snapshot()
+typedef struct buffer_snapshot_s
+{
+    size_t capacity;         ///< Number of characters of the array, see ::buffer_s::last
+    size_t consumer_offset;  ///< Position of ::buffer_s::consumer_ptr from ::buffer_s::data
+    size_t producer_offset;  ///< Position of ::buffer_s::producer_ptr from ::buffer_s::data, includes reserved characters
+    size_t length;           ///< See ::buffer_s::length
+    size_t lines;            ///< See ::buffer_s::lines
+    size_t copied;           ///< Number of unread characters copied by ::buffer_snapshot()
+    size_t producer_version; ///< See ::buffer_versions_s::producer
+    size_t consumer_version; ///< See ::buffer_versions_s::consumer
+    unsigned char state;     ///< See ::buffer_s::state
+}buffer_snapshot_t;
+
+#endif
+
+
+#ifdef BUFFER_ENABLE_LATENCY
+
+//! @brief Forward declaration, see: \ref buffer_enable_latency
+struct buffer_latency_s;
+
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+
+//! @brief Forward declaration, see: \ref buffer_enable_crc
+struct buffer_crc_s;
+
+#endif
+
+
+typedef struct buffer_region_s buffer_region_t;
+
+//! @brief Header in front of the characters of a region, see: \ref buffer_grow
+struct buffer_region_s
+{
+    buffer_region_t * next; ///< Next retired region
+    size_t size;            ///< Number of characters behind the header
+};
+
+//! @brief Entry of the side ring, see: \ref buffer_line_index
+typedef struct buffer_line_index_entry_s
+{
+    volatile _Atomic(size_t) sequence; ///< Line number plus one, 0 if unused
+    volatile _Atomic(size_t) offset;   ///< Position of the End-Of-Line character relative to ::buffer_s::data
+}buffer_line_index_entry_t;
+
+//! @brief Line offset index, see: \ref buffer_line_index
+typedef struct buffer_line_index_s
+{
+    //! @brief Side ring with the positions of the published lines
+    buffer_line_index_entry_t entries[BUFFER_LINE_INDEX_ENTRIES];
+
+    //! @brief Number of published lines, only used by the producer/set thread
+    size_t published;
+
+    //! @brief Number of consumed lines, written by the consumer/get thread
+    volatile _Atomic(size_t) consumed;
+}buffer_line_index_t;
+
+
+//! @brief Set of characters that end a line, see: \ref buffer_delimiters
+typedef struct buffer_delimiters_s
+{
+    unsigned char low[16];  ///< Buckets of the characters per low nibble
+    unsigned char high[16]; ///< Bucket per high nibble
+    unsigned char set[32];  ///< One bit per character of the set
+    char terminator[BUFFER_TERMINATOR_SIZE]; ///< Terminator of several characters, empty for none
+    size_t terminator_length; ///< Number of characters of ::buffer_delimiters_s::terminator
+    uint64_t terminator_prefix; ///< The characters in front of the last one, packed like ::buffer_line_tail()
+    uint64_t terminator_mask;   ///< Selects the characters of ::buffer_delimiters_s::terminator_prefix
+    bool terminator_required;   ///< The last character only ends a line after the rest of the terminator
+    size_t count;           ///< Number of characters of the set
+    char single;            ///< The character if the set has only one
+}buffer_delimiters_t;
+
+
 //! @brief Struct to create a buffer object, like an instance of a class
 //!
 //! @details The buffer struct can be used to exchange data between threads or a thread and an interrupt.
@@ -313,13 +732,15 @@ struct buffer_s {
 
     //! @brief Buffer start address
     //!
-    //! @details Start address of the `char` array which stores the data
-    char * data;
+    //! @details Start address of the `char` array which stores the data. Atomic because
+    //! the consumer moves the buffer to a new region, see: \ref buffer_grow
+    volatile _Atomic(char *) data;
 
     //! @brief Buffer last address
     //!
-    //! @details Last address of the `char` array
-    char * last;
+    //! @details Last address of the `char` array, `NULL` while the buffer is moved to a new
+    //! region, see: \ref buffer_grow
+    volatile _Atomic(char *) last;
 
     //! @brief End-Of-Line character
     //!
@@ -399,6 +820,22 @@ struct buffer_s {
     //! - Function must not block or must itself monitor ::buffer_s::state and react to a forced stop.
     buffer_function_char_handler_t on_wait_get;
 
+    //! @brief High watermark handler
+    //!
+    //! @details Handler that is called when the occupancy rises to the high watermark,
+    //! see: \ref buffer_watermark
+    //! - `NULL` is allowed.
+    //! - Called from the thread that causes the transition, usually the producer/set thread.
+    buffer_action_handler_t on_watermark_high;
+
+    //! @brief Low watermark handler
+    //!
+    //! @details Handler that is called when the occupancy falls to the low watermark after
+    //! the high watermark was reached, see: \ref buffer_watermark
+    //! - `NULL` is allowed.
+    //! - Called from the thread that causes the transition, usually the consumer/get thread.
+    buffer_action_handler_t on_watermark_low;
+
 #endif
 
     //! @brief Consumer pointer
@@ -415,6 +852,13 @@ struct buffer_s {
     //! - Use ::atomic_load() if you need to use the element directly.
     volatile _Atomic(char *) producer_ptr;
 
+    //! @brief Position of a missed reset
+    //!
+    //! @details Set by the consumer when it has read the buffer empty but could not reset it,
+    //! because a reservation of ::buffer_write_reserve() was open. The producer resets the
+    //! buffer when it releases the reservation unused, see ::buffer_write_commit().
+    volatile _Atomic(char *) rewind_ptr;
+
     //! @brief Number of characters is buffer
     //!
     //! @details Current number of characters stored in the buffer.
@@ -437,6 +881,119 @@ struct buffer_s {
 
     //! @brief Optional pointer to user data, `NULL` is allowed
     void * user_data;
+
+    //! @brief Line offset index
+    //!
+    //! @details See: \ref buffer_line_index
+    //! - `NULL` is allowed.
+    //! - Use ::buffer_line_index_attach() to set the element.
+    buffer_line_index_t * line_index;
+
+    //! @brief Characters that end a line
+    //!
+    //! @details See: \ref buffer_delimiters
+    //! - `NULL` uses ::buffer_s::end_of_line_character.
+    //! - Use ::buffer_delimiters_attach() to set the element.
+    const buffer_delimiters_t * delimiters;
+
+    //! @brief Last characters published by the producer, see ::buffer_line_tail()
+    //!
+    //! @details Only used with a terminator of several characters, see: \ref buffer_delimiters
+    uint64_t tail_produced;
+
+    //! @brief Last characters removed by the consumer, see ::buffer_line_tail()
+    //!
+    //! @details Only used with a terminator of several characters, see: \ref buffer_delimiters
+    uint64_t tail_consumed;
+
+    //! @brief Number of characters removed by the consumer/get thread since the initialization
+    //!
+    //! @details A consumer that keeps a position in the unread characters, e.g. ::buffer_match_read_to(),
+    //! detects with it that another read function removed characters in the meantime.
+    uint64_t removed;
+
+    //! @brief Armed waiters, one per transition
+    //!
+    //! @details See: \ref buffer_waiter
+    //! - Use ::buffer_waiter_arm() and ::buffer_waiter_cancel() to set the elements.
+    volatile _Atomic(buffer_waiter_t *) waiters[BUFFER_WAIT_EVENTS];
+
+    //! @brief High watermark, 0 disables the watermarks
+    //!
+    //! @details See: \ref buffer_watermark
+    //! - Use ::buffer_watermark() to set the element.
+    size_t watermark_high;
+
+    //! @brief Low watermark
+    //!
+    //! @details See: \ref buffer_watermark
+    //! - Use ::buffer_watermark() to set the element.
+    size_t watermark_low;
+
+    //! @brief The high watermark was reached and the low watermark not yet
+    //!
+    //! @details See: \ref buffer_watermark
+    //! - Use ::buffer_watermark_is_high() to read the element.
+    volatile _Atomic(bool) watermark_reached;
+
+    //! @brief Region of ::buffer_s::data if it was allocated by ::buffer_grow(), otherwise `NULL`
+    //!
+    //! @details See: \ref buffer_grow
+    //! - Only used by the consumer/get thread.
+    buffer_region_t * region;
+
+    //! @brief Larger region that the consumer/get thread moves to
+    //!
+    //! @details See: \ref buffer_grow
+    //! - Use ::buffer_grow() to set the element.
+    volatile _Atomic(buffer_region_t *) region_pending;
+
+    //! @brief Replaced regions that are freed by the producer/set thread
+    //!
+    //! @details See: \ref buffer_grow
+    volatile _Atomic(buffer_region_t *) region_retired;
+
+#ifdef BUFFER_ENABLE_STATS
+
+    //! @brief Statistics counters
+    //!
+    //! @details See: \ref buffer_enable_stats
+    //! - Use ::buffer_stats_snapshot() to read the counters.
+    buffer_stats_t stats;
+
+#endif
+
+#ifdef BUFFER_ENABLE_LATENCY
+
+    //! @brief Latency measurement
+    //!
+    //! @details See: \ref buffer_enable_latency
+    //! - `NULL` is allowed.
+    //! - Use ::buffer_latency_attach() to set the element.
+    struct buffer_latency_s * latency;
+
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+
+    //! @brief Checksums of the lines and records
+    //!
+    //! @details See: \ref buffer_enable_crc
+    //! - `NULL` is allowed.
+    //! - Use ::buffer_crc_attach() to set the element.
+    struct buffer_crc_s * crc;
+
+#endif
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+    //! @brief Versions of the metadata
+    //!
+    //! @details See: \ref buffer_enable_snapshot
+    //! - Use ::buffer_snapshot() to read the metadata.
+    buffer_versions_t versions;
+
+#endif
 };
 
 //! @brief Represents a simplified form of a class
@@ -447,29 +1004,61 @@ struct buffer_sc
 {
     bool       (* Clear    ) (      buffer_t * object);     ///< @brief See ::buffer_clear()
     void       (* Copy     ) (const buffer_t * object, buffer_t * dest);          ///< @brief See ::buffer_copy()
+    bool       (* DelimitersAttach) (buffer_t * object, const buffer_delimiters_t * delimiters); ///< @brief See ::buffer_delimiters_attach()
+    bool       (* DelimitersInit) (buffer_delimiters_t * delimiters, const char * ends, const char * terminator); ///< @brief See ::buffer_delimiters_init()
     bool       (* Equal    ) (const buffer_t * object, const buffer_t * object2); ///< @brief See ::buffer_equal()
+    const char * (* FindEndOfLine) (const buffer_t * object, const char * ptr, size_t n); ///< @brief See ::buffer_find_end_of_line()
+    const char * (* FindLineEnd) (const buffer_t * object, uint64_t tail, const char * ptr, size_t n); ///< @brief See ::buffer_find_line_end()
     char       (* Get      ) (      buffer_t * object);     ///< @brief See ::buffer_get()
     char       (* GetAvailableOrNull ) (buffer_t * object); ///< @brief See ::buffer_get_available_or_null()
+    bool       (* Grow     ) (      buffer_t * object, size_t sizeof_data); ///< @brief See ::buffer_grow()
+    void       (* GrowFree ) (      buffer_t * object);     ///< @brief See ::buffer_grow_free()
     bool       (* Init     ) (      buffer_t * object, char * data, size_t sizeof_data, bool start); ///< @brief See ::buffer_init()
     bool       (* IsEmpty  ) (const buffer_t * object);     ///< @brief See ::buffer_is_empty()
     bool       (* IsFull   ) (const buffer_t * object);     ///< @brief See ::buffer_is_full()
     bool       (* IsStopped) (const buffer_t * object);     ///< @brief See ::buffer_is_stoped()
     size_t     (* Length   ) (const buffer_t * object);     ///< @brief See ::buffer_length()
+    bool       (* LineIndexAttach) (buffer_t * object, buffer_line_index_t * line_index); ///< @brief See ::buffer_line_index_attach()
+    uint64_t   (* LineTail ) (uint64_t tail, const char * ptr, size_t n); ///< @brief See ::buffer_line_tail()
     size_t     (* Lines    ) (const buffer_t * object);     ///< @brief See ::buffer_lines()
     char       (* LookAvailableOrNull) (buffer_t * object); ///< @brief See ::buffer_look_available_or_null()
+    size_t     (* LookLine ) (      buffer_t * object, const char ** line); ///< @brief See ::buffer_look_line()
+    void       (* NotifyConsumed ) (buffer_t * object, size_t length, size_t n, bool space); ///< @brief See ::buffer_notify_consumed()
+    void       (* NotifyPublished) (buffer_t * object, size_t length, size_t n, size_t lines); ///< @brief See ::buffer_notify_published()
     buffer_t * (* ObjectAllocate) (char * data, size_t sizeof_data, bool start); ///< @brief See ::buffer_object_allocate()
     bool       (* ObjectFree)(buffer_t * object);           ///< @brief See ::buffer_object_free()
+    size_t     (* PeekRecord) (buffer_t * object, const void ** record); ///< @brief See ::buffer_peek_record()
+    size_t     (* PopRecord ) (buffer_t * object, void * dest, size_t n); ///< @brief See ::buffer_pop_record()
+    size_t     (* PopRecords) (buffer_t * object, size_t n, size_t records); ///< @brief See ::buffer_pop_records()
+    bool       (* PushRecord) (buffer_t * object, const void * src, size_t n); ///< @brief See ::buffer_push_record()
+    bool       (* PushRecordCommit ) (buffer_t * object, void * record); ///< @brief See ::buffer_push_record_commit()
+    void *     (* PushRecordReserve) (buffer_t * object, size_t n); ///< @brief See ::buffer_push_record_reserve()
     size_t     (* Read     ) (      buffer_t * object, char * dest, size_t n); ///< @brief See ::buffer_read()
+    size_t     (* ReadConsume) (    buffer_t * object, size_t n); ///< @brief See ::buffer_read_consume()
     size_t     (* ReadLine ) (      buffer_t * object, char * dest, size_t n); ///< @brief See ::buffer_read_line()
+    size_t     (* ReadSpan ) (      buffer_t * object, const char ** span); ///< @brief See ::buffer_read_span()
     size_t     (* ReadTo   ) (      buffer_t * object, char * dest, size_t n, const char * to, size_t to_length); ///< @brief See ::buffer_read_to()
     bool       (* Reset    ) (      buffer_t * object, bool start); ///< @brief See ::buffer_reset()
     bool       (* Set      ) (      buffer_t * object, char c);     ///< @brief See ::buffer_set()
     bool       (* SetPossibleOrSkip  ) (buffer_t * object, char c); ///< @brief See ::buffer_set_possible_or_skip()
+    bool       (* SkipLine ) (      buffer_t * object); ///< @brief See ::buffer_skip_line()
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    bool       (* Snapshot ) (const buffer_t * object, buffer_snapshot_t * dest, char * unread, size_t n); ///< @brief See ::buffer_snapshot()
+#endif
     size_t     (* Space    ) (const buffer_t * object); ///< @brief See ::buffer_space()
     bool       (* Start    ) (      buffer_t * object); ///< @brief See ::buffer_start()
+#ifdef BUFFER_ENABLE_STATS
+    void       (* StatsSnapshot) (const buffer_t * object, buffer_stats_snapshot_t * dest); ///< @brief See ::buffer_stats_snapshot()
+#endif
     bool       (* StopForce) (      buffer_t * object); ///< @brief See ::buffer_stop_force()
     bool       (* StopTry  ) (      buffer_t * object); ///< @brief See ::buffer_stop_try()
+    bool       (* WaiterArm) (      buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter); ///< @brief See ::buffer_waiter_arm()
+    bool       (* WaiterCancel) (   buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter); ///< @brief See ::buffer_waiter_cancel()
+    bool       (* Watermark) (      buffer_t * object, size_t low, size_t high); ///< @brief See ::buffer_watermark()
+    bool       (* WatermarkIsHigh) (const buffer_t * object); ///< @brief See ::buffer_watermark_is_high()
     size_t     (* Write    ) (      buffer_t * object, const char *src, size_t n); ///< @brief See ::buffer_write()
+    size_t     (* WriteCommit ) (   buffer_t * object, char * span, size_t n); ///< @brief See ::buffer_write_commit()
+    size_t     (* WriteReserve) (   buffer_t * object, char ** span); ///< @brief See ::buffer_write_reserve()
 };
 
 
@@ -508,7 +1097,8 @@ bool buffer_clear(buffer_t * object);
 
 //! @brief Copying one structure to another
 //!
-//! @details Compares all elements of the structure
+//! @details Copies all elements of the structure except the regions of ::buffer_grow(),
+//! which stay owned by @p object. The copy must not be used after @p object was freed.
 //!
 //! Can be use in:
 //! - producer/set thread.
@@ -518,9 +1108,39 @@ bool buffer_clear(buffer_t * object);
 //! @param[out] dest Target which is overwritten
 void buffer_copy(const buffer_t * object, buffer_t * dest);
 
+//! @brief Sets the characters that end a line
+//!
+//! @details `NULL` uses ::buffer_s::end_of_line_character again. The set is not copied,
+//! it must exist as long as it is attached. See: \ref buffer_delimiters
+//!
+//! @attention Must not be used if one of the threads is used. The lines already counted
+//! would no longer match, the buffer must therefore be empty. A terminator that was partly written
+//! before is forgotten.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in] delimiters The set, `NULL` is allowed
+//! @return Returns whether the set could be attached
+//! @retval true  Attached or detached
+//! @retval false @p object was `NULL` or the buffer is not empty
+bool buffer_delimiters_attach(buffer_t * object, const buffer_delimiters_t * delimiters);
+
+//! @brief Initializes a set of characters that end a line
+//!
+//! @details Example: `buffer_delimiters_init(&delimiters, ";", "\r\n")` ends a line with
+//! `;` or `\r\n`, a `\n` alone does not end a line. ::buffer_read_line() removes the `\r\n`.
+//! A last character of the terminator that is also in @p ends always ends a line.
+//!
+//! @param[out] delimiters The set
+//! @param[in] ends Characters that each end a line, `NULL` is allowed
+//! @param[in] terminator Terminator of up to ::BUFFER_TERMINATOR_SIZE characters, only its
+//! characters together end a line, `NULL` is allowed
+//! @return Returns whether the set was initialized
+//! @retval false @p delimiters was `NULL`, the set is empty or the terminator is too long
+bool buffer_delimiters_init(buffer_delimiters_t * delimiters, const char * ends, const char * terminator);
+
 //! @brief Compares two struct objects of type ::buffer_s and returns whether they are equal
 //!
-//! @details Compares all elements of the structure
+//! @details Compares all elements of the structure except the regions of ::buffer_grow()
 //!
 //! Can be use in:
 //! - producer/set thread, with stopped buffer
@@ -533,6 +1153,31 @@ void buffer_copy(const buffer_t * object, buffer_t * dest);
 //! @retval false Struct objects are different
 bool buffer_equal(const buffer_t * object, const buffer_t * object2);
 
+//! @brief Returns the first character within @p n characters that can end a line
+//!
+//! @details Uses ::buffer_s::delimiters or ::buffer_s::end_of_line_character, see: \ref buffer_delimiters
+//! The last character of a terminator is returned without the characters in front of it,
+//! use ::buffer_find_line_end() to find complete terminators.
+//!
+//! @param[in] object The buffer object
+//! @param[in] ptr The characters
+//! @param n The number of characters
+//! @return The position of the character, `NULL` if none was found
+const char * buffer_find_end_of_line(const buffer_t * object, const char * ptr, size_t n);
+
+//! @brief Returns the first character within @p n characters that ends a line
+//!
+//! @details Like ::buffer_find_end_of_line(), the last character of a terminator only ends
+//! a line if the characters in front of it complete the terminator. These are taken from
+//! the characters before @p ptr and then from @p tail. See: \ref buffer_delimiters
+//!
+//! @param[in] object The buffer object
+//! @param tail The last characters in front of @p ptr, see ::buffer_line_tail()
+//! @param[in] ptr The characters
+//! @param n The number of characters
+//! @return The position of the character, `NULL` if none was found
+const char * buffer_find_line_end(const buffer_t * object, uint64_t tail, const char * ptr, size_t n);
+
 //! @brief Reads a character or waits until it can be executed.
 //!
 //! @details Reads a character in the buffer, blocks as long as the character can be read
@@ -557,6 +1202,32 @@ char buffer_get(buffer_t * object);
 //! @retval else The read character
 char buffer_get_available_or_null(buffer_t * object);
 
+//! @brief Provides a larger region for the buffer
+//!
+//! @details The consumer moves the buffer to the region when it was read empty after it was
+//! full, see: \ref buffer_grow. If a region is already pending, nothing is allocated.
+//! First the regions replaced in the meantime are freed.
+//!
+//! Can be use in:
+//! - producer/set thread, e.g. in ::buffer_s::on_full.
+//!
+//! @param[in,out] object The buffer object
+//! @param sizeof_data Number of characters of the new region, larger than the current capacity
+//! @return Returns whether a larger region is pending
+//! @retval false The size is not larger, the buffer has no data or ::malloc() failed
+bool buffer_grow(buffer_t * object, size_t sizeof_data);
+
+//! @brief Stops the buffer and frees all regions of ::buffer_grow()
+//!
+//! @details If the buffer uses such a region, ::buffer_s::data is set to `NULL`.
+//!
+//! Can be use in:
+//! - producer/set thread, with stopped consumer
+//! - consumer/get thread, with stopped producer
+//!
+//! @param[in,out] object The buffer object, `NULL` is allowed
+void buffer_grow_free(buffer_t * object);
+
 //! @brief Function for initialization
 //!
 //! @details Function for initialization the buffer object. First, the buffer is
@@ -631,6 +1302,33 @@ bool buffer_is_stopped(const buffer_t * object);
 //! @return Positive number of used characters
 size_t buffer_length(const buffer_t * object);
 
+//! @brief Attaches a line offset index to the buffer
+//!
+//! @details Clears the side ring, `NULL` detaches the index. See: \ref buffer_line_index
+//!
+//! Lines that are already in the buffer are read without index.
+//!
+//! @attention Must not be used if one of the threads is used. Stop the buffer with
+//! ::buffer_stop_force() or ::buffer_stop_try() and check the return value.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in,out] line_index The line offset index, `NULL` is allowed
+//! @return Returns whether the index could be attached
+//! @retval true  Attached or detached
+//! @retval false @p object was `NULL`
+bool buffer_line_index_attach(buffer_t * object, buffer_line_index_t * line_index);
+
+//! @brief Appends characters to the last characters of a stream
+//!
+//! @details The newest character is kept in the lowest byte, only the last 8 characters
+//! are kept. Used for terminators of several characters, see: \ref buffer_delimiters
+//!
+//! @param tail The last characters in front of @p ptr, 0 at the start of a stream
+//! @param[in] ptr The characters
+//! @param n The number of characters
+//! @return The last characters behind @p ptr
+uint64_t buffer_line_tail(uint64_t tail, const char * ptr, size_t n);
+
 //! @brief Returns the lines currently used
 //!
 //! @details Returns the currently used lines in the array.
@@ -658,6 +1356,49 @@ size_t buffer_lines(const buffer_t * object);
 //! @retval else The read character
 char buffer_look_available_or_null(buffer_t * object);
 
+//! @brief Exposes the next line without copying or deleting it
+//!
+//! @details Returns the position and the length of the next complete line, without the
+//! End-Of-Line character. The line stays valid until it is removed with ::buffer_skip_line()
+//! or another read function. With a line offset index the end of the line is found in O(1),
+//! see: \ref buffer_line_index
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] line Start of the line, `NULL` if no line is available
+//! @return Returns the number of characters of the line without End-Of-Line character
+size_t buffer_look_line(buffer_t * object, const char ** line);
+
+//! @brief Signals that characters were removed by a container that manages ::buffer_s::length
+//!
+//! @details Signals the low watermark and wakes the waiter of ::BUFFER_WAIT_SPACE,
+//! see \ref buffer_waiter. The buffer functions do this themselves.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param length ::buffer_s::length after the removal
+//! @param n Number of characters removed
+//! @param space `true` if the producer has free space again
+void buffer_notify_consumed(buffer_t * object, size_t length, size_t n, bool space);
+
+//! @brief Signals that characters were published by a container that manages ::buffer_s::length
+//!
+//! @details Signals the high watermark and wakes the waiters of ::BUFFER_WAIT_DATA and
+//! ::BUFFER_WAIT_LINE, see \ref buffer_waiter. The buffer functions do this themselves.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param length ::buffer_s::length after the publication
+//! @param n Number of characters published
+//! @param lines Number of lines published
+void buffer_notify_published(buffer_t * object, size_t length, size_t n, size_t lines);
+
 //! @brief Dynamic allocation of memory for the object
 //!
 //! @details Always check if the function returns a `NULL` pointer.
@@ -680,6 +1421,8 @@ buffer_t * buffer_object_allocate(char * data, size_t sizeof_data, bool start);
 //!
 //! @details Which was previously allocated by the function ::buffer_object_allocate().
 //!
+//! The regions of ::buffer_grow() are freed with ::buffer_grow_free().
+//!
 //! If it is ensured that the buffer is stopped (::buffer_stop_force(), ::buffer_stop_try())
 //! then the standard function ::free() can be used.
 //!
@@ -689,6 +1432,97 @@ buffer_t * buffer_object_allocate(char * data, size_t sizeof_data, bool start);
 //! @retval false The buffer could not be stopped or object was `NULL`.
 bool buffer_object_free(buffer_t * object);
 
+//! @brief Exposes the next record without copying or deleting it
+//!
+//! @details The record stays valid until it is removed with ::buffer_pop_record().
+//! See: \ref buffer_record
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] record Start of the payload, `NULL` if no record is available
+//! @return Returns the number of bytes of the payload, 0 if no record is available
+size_t buffer_peek_record(buffer_t * object, const void ** record);
+
+//! @brief Reads and removes the next record
+//!
+//! @details The record is only removed if it fits into @p dest, otherwise it remains in the
+//! buffer and 0 is returned, the required size can be determined with ::buffer_peek_record().
+//! If @p dest is `NULL` the record is removed without copying. See: \ref buffer_record
+//!
+//! Does not block and does not guarantee a read.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] dest The payload is written in this buffer, `NULL` is allowed
+//! @param n The length of the buffer (@p dest parameter)
+//! @return Returns the number of bytes of the payload, 0 if no record was removed
+size_t buffer_pop_record(buffer_t * object, void * dest, size_t n);
+
+//! @brief Removes records that were read directly from the buffer
+//!
+//! @details Removes the first @p n bytes of the span returned by ::buffer_read_span(), they
+//! hold @p records complete records, each a ::BUFFER_RECORD_HEADER_SIZE header followed by its
+//! payload. A batch of records is released with one update of ::buffer_s::length.
+//! See: \ref buffer_record
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param n The number of bytes, including the headers
+//! @param records The number of records
+//! @return Returns the number of bytes removed, 0 if @p n exceeds the readable bytes
+size_t buffer_pop_records(buffer_t * object, size_t n, size_t records);
+
+//! @brief Writes a record
+//!
+//! @details The record is written completely or not at all, see: \ref buffer_record
+//!
+//! Does not block, if there is not enough space the record is skipped.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in] src The payload
+//! @param n The number of bytes of the payload, at least 1
+//! @return Returns whether the record was written
+//! @retval false Skipped, not enough space, an empty record or the buffer is stopped
+//! @retval true  The record was written
+bool buffer_push_record(buffer_t * object, const void * src, size_t n);
+
+//! @brief Publishes a record reserved with ::buffer_push_record_reserve()
+//!
+//! @details See: \ref buffer_record
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in] record The payload returned by ::buffer_push_record_reserve()
+//! @return Returns whether the record was published
+//! @retval false The buffer was stopped during the reservation, the space is returned with the next reset
+//! @retval true  The record was published
+bool buffer_push_record_commit(buffer_t * object, void * record);
+
+//! @brief Reserves a record so that the payload can be written in place
+//!
+//! @details Like ::buffer_write_reserve() for characters, the payload is written directly into
+//! the buffer and published with ::buffer_push_record_commit(). No other record may be written
+//! in the meantime. See: \ref buffer_record
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param n The number of bytes of the payload, at least 1
+//! @return Returns the start of the payload, `NULL` if there is not enough space or the buffer is stopped
+void * buffer_push_record_reserve(buffer_t * object, size_t n);
+
 //! @brief Reads a string from the buffer
 //!
 //! @details Reads a string from the buffer,
@@ -709,6 +1543,19 @@ bool buffer_object_free(buffer_t * object);
 //! @return Returns the number of characters read
 size_t buffer_read(buffer_t * object, char * dest, size_t n);
 
+//! @brief Removes characters that were read directly from the buffer
+//!
+//! @details Removes the first @p n characters of the span returned by ::buffer_read_span(),
+//! the End-Of-Line characters in it are counted.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param n The number of characters, at most the length of the span
+//! @return Returns the number of characters removed
+size_t buffer_read_consume(buffer_t * object, size_t n);
+
 //! @brief Reads a line from the buffer
 //!
 //! @details Reads a string from the buffer,
@@ -719,6 +1566,8 @@ size_t buffer_read(buffer_t * object, char * dest, size_t n);
 //! Does not block and does not guarantee a read. The return value must
 //! be checked to ensure that everything has been read.
 //!
+//! With a line offset index the line is copied in one operation, see: \ref buffer_line_index
+//!
 //! Can be use in:
 //! - consumer/get thread.
 //!
@@ -729,6 +1578,20 @@ size_t buffer_read(buffer_t * object, char * dest, size_t n);
 //! @return Returns the number of characters read
 size_t buffer_read_line(buffer_t * object, char * dest, size_t n);
 
+//! @brief Exposes all readable characters without copying or deleting them
+//!
+//! @details The buffer is linear, all readable characters are in one contiguous span.
+//! The span stays valid until it is removed with ::buffer_read_consume() or another
+//! read function, e.g. it can be passed directly to `write()`.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] span Start of the characters, `NULL` if the buffer is empty
+//! @return Returns the number of readable characters
+size_t buffer_read_span(buffer_t * object, const char ** span);
+
 //! @brief Reads the characters if the character string of the parameter @p to is contained
 //! @details Then only returns the characters up to the string parameter @p to.
 //!
@@ -798,6 +1661,42 @@ bool buffer_set(buffer_t * object, char c);
 //! @retval true  Character could be saved
 bool buffer_set_possible_or_skip(buffer_t * object, char c);
 
+//! @brief Removes the next line
+//!
+//! @details Removes the next complete line including the End-Of-Line character,
+//! usually after it was exposed with ::buffer_look_line().
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @return Returns whether a line was removed
+//! @retval false No complete line available
+//! @retval true  The line was removed
+bool buffer_skip_line(buffer_t * object);
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+//! @brief Takes a consistent snapshot of the metadata and optionally of the unread characters
+//!
+//! @details Reads the metadata between two equal and even versions of both sides, neither
+//! side waits for it. See: \ref buffer_enable_snapshot
+//!
+//! The region of the unread characters is not freed by ::buffer_grow() during the copy.
+//!
+//! Can be use in:
+//! - any thread.
+//!
+//! @param[in] object The buffer object
+//! @param[out] dest The metadata
+//! @param[out] unread Up to @p n unread characters are copied to it, `NULL` for none
+//! @param n The length of @p unread
+//! @return Returns whether the snapshot is consistent
+//! @retval false The sides changed the metadata in all ::BUFFER_SNAPSHOT_RETRIES attempts or a parameter is invalid
+bool buffer_snapshot(const buffer_t * object, buffer_snapshot_t * dest, char * unread, size_t n);
+
+#endif
+
 //! @brief Returns the free space
 //!
 //! @details Returns the available space in the array.
@@ -824,6 +1723,25 @@ size_t buffer_space(const buffer_t * object);
 //! @retval false The buffer could not be started.
 bool buffer_start(buffer_t * object);
 
+#ifdef BUFFER_ENABLE_STATS
+
+//! @brief Copies the statistics counters
+//!
+//! @details Reads each counter once with a relaxed atomic load, the hot paths are not disturbed.
+//! The counters are read one after the other, the snapshot is therefore not taken
+//! at a single point in time. See: \ref buffer_enable_stats
+//!
+//! Can be use in:
+//! - producer/set thread.
+//! - consumer/get thread.
+//! - any other thread.
+//!
+//! @param[in] object The buffer object
+//! @param[out] dest The copy of the counters
+void buffer_stats_snapshot(const buffer_t * object, buffer_stats_snapshot_t * dest);
+
+#endif
+
 //! @brief Stops further calls of the buffer
 //!
 //! @details Stops the buffer; no new functions can be called from this
@@ -853,6 +1771,63 @@ bool buffer_stop_force(buffer_t * object);
 //! @retval false The buffer could not be stopped.
 bool buffer_stop_try(buffer_t * object);
 
+//! @brief Arms a one-shot waiter for a transition
+//!
+//! @details The waiter is only armed if the condition of the transition is not yet
+//! fulfilled, checked after arming so that no transition is lost. If the function
+//! returns `true`, the wake handler may already be running in another thread.
+//! See: \ref buffer_waiter
+//!
+//! Can be use in:
+//! - consumer/get thread for ::BUFFER_WAIT_DATA and ::BUFFER_WAIT_LINE.
+//! - producer/set thread for ::BUFFER_WAIT_SPACE.
+//!
+//! @param[in,out] object The buffer object
+//! @param event The transition
+//! @param[in,out] waiter The waiter, must stay valid until it is woken or canceled
+//! @return Returns whether the waiter is armed
+//! @retval true  Armed, the wake handler is called once
+//! @retval false Not armed, the condition is fulfilled, the buffer is stopped or a parameter is invalid
+bool buffer_waiter_arm(buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter);
+
+//! @brief Disarms a waiter
+//!
+//! @param[in,out] object The buffer object
+//! @param event The transition
+//! @param[in,out] waiter The waiter
+//! @return Returns whether the waiter was disarmed before it was woken
+//! @retval true  Disarmed, the wake handler is not called
+//! @retval false Not armed, the wake handler was or is being called
+bool buffer_waiter_cancel(buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter);
+
+//! @brief Sets the high and low watermarks
+//!
+//! @details See: \ref buffer_watermark
+//! If the occupancy is already at the high watermark, the high watermark is signaled.
+//! The watermarks are kept by ::buffer_reset().
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param low Low watermark, must be less than @p high
+//! @param high High watermark, 0 disables the watermarks
+//! @return Returns whether the watermarks were set
+//! @retval false @p low is not less than @p high or @p high is greater than the buffer
+bool buffer_watermark(buffer_t * object, size_t low, size_t high);
+
+//! @brief Returns whether the high watermark was reached and the low watermark not yet
+//!
+//! @details See: \ref buffer_watermark
+//!
+//! Can be use in:
+//! - producer/set thread.
+//! - consumer/get thread.
+//!
+//! @param[in] object The buffer object
+//! @return Returns ::buffer_s::watermark_reached
+bool buffer_watermark_is_high(const buffer_t * object);
+
 //! @brief Writes a string to the buffer
 //!
 //! @details Writes a string to the buffer.
@@ -873,10 +1848,94 @@ bool buffer_stop_try(buffer_t * object);
 //! @return Returns the number of characters written
 size_t buffer_write(buffer_t * object, const char *src, size_t n);
 
+//! @brief Publishes characters that were written directly into the buffer
+//!
+//! @details Publishes the first @p n characters of the span reserved with
+//! ::buffer_write_reserve(), the rest of the reservation is released again.
+//! Counts the lines and calls the handlers as ::buffer_set() does. If nothing is published
+//! and the consumer has read the buffer empty meanwhile, the buffer is reset here, see
+//! ::buffer_s::rewind_ptr.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in] span The span returned by ::buffer_write_reserve()
+//! @param n The number of characters written, at most the length of the span
+//! @return Returns the number of characters published, 0 if the buffer was stopped
+size_t buffer_write_commit(buffer_t * object, char * span, size_t n);
+
+//! @brief Reserves all free space to write directly into the buffer
+//!
+//! @details The buffer is linear, the free space is one contiguous span, e.g. it can be
+//! passed directly to `read()`. The characters are not visible to the consumer until
+//! ::buffer_write_commit() is called, which must always follow a reservation.
+//! Until then the buffer appears full.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] span Start of the free space, `NULL` if the buffer is full or stopped
+//! @return Returns the number of reserved characters
+size_t buffer_write_reserve(buffer_t * object, char ** span);
+
 /*---------------------------------------------------------------------*
  *  public: static inline functions
  *---------------------------------------------------------------------*/
 
+#ifdef BUFFER_ENABLE_STATS
+
+//! @brief Part of ::BUFFER_INIT for the element ::buffer_s::stats
+#define BUFFER_INIT_STATS \
+    /* .stats                 = */ { { 0 }, { 0, 0, 0, 0, 0, 0 }, { 0 }, { 0, 0, 0, 0 }, { 0 } },
+
+#else
+
+//! @brief Part of ::BUFFER_INIT, empty without ::BUFFER_ENABLE_STATS
+#define BUFFER_INIT_STATS
+
+#endif
+
+#ifdef BUFFER_ENABLE_LATENCY
+
+//! @brief Part of ::BUFFER_INIT for the element ::buffer_s::latency
+#define BUFFER_INIT_LATENCY \
+    /* .latency               = */ (NULL),
+
+#else
+
+//! @brief Part of ::BUFFER_INIT, empty without ::BUFFER_ENABLE_LATENCY
+#define BUFFER_INIT_LATENCY
+
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+
+//! @brief Part of ::BUFFER_INIT for the element ::buffer_s::crc
+#define BUFFER_INIT_CRC \
+    /* .crc                   = */ (NULL),
+
+#else
+
+//! @brief Part of ::BUFFER_INIT, empty without ::BUFFER_ENABLE_CRC
+#define BUFFER_INIT_CRC
+
+#endif
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+//! @brief Part of ::BUFFER_INIT for the element ::buffer_s::versions
+#define BUFFER_INIT_SNAPSHOT \
+    /* .versions              = */ { { 0 }, 0, { 0 }, 0, { 0 }, 0, { 0 } },
+
+#else
+
+//! @brief Part of ::BUFFER_INIT, empty without ::BUFFER_ENABLE_SNAPSHOT
+#define BUFFER_INIT_SNAPSHOT
+
+#endif
+
 #ifdef BUFFER_ENABLE_HANDLER
 
 //! @brief Define statement for initializing a new structure
@@ -897,12 +1956,31 @@ size_t buffer_write(buffer_t * object, const char *src, size_t n);
     /* .on_error              = */ (NULL), \
     /* .on_wait_set           = */ (NULL), \
     /* .on_wait_get           = */ (NULL), \
+    /* .on_watermark_high     = */ (NULL), \
+    /* .on_watermark_low      = */ (NULL), \
     /* .consumer_ptr          = */ (DATA), \
     /* .producer_ptr          = */ ATOMIC_VAR_INIT(DATA), \
+    /* .rewind_ptr            = */ ATOMIC_VAR_INIT(NULL), \
     /* .length                = */ ATOMIC_VAR_INIT(0), \
     /* .lines                 = */ ATOMIC_VAR_INIT(0), \
     /* .state                 = */ ATOMIC_VAR_INIT( ( (NULL != (DATA)) && (0 != (DATA_LENGTH)) && (START) ) ? BUFFER_FLAGS_IDLE : BUFFER_FLAGS_STOP ), \
     /* .user_data             = */ (NULL), \
+    /* .line_index            = */ (NULL), \
+    /* .delimiters            = */ (NULL), \
+    /* .tail_produced         = */ 0, \
+    /* .tail_consumed         = */ 0, \
+    /* .removed               = */ 0, \
+    /* .waiters               = */ { ATOMIC_VAR_INIT(NULL), ATOMIC_VAR_INIT(NULL), ATOMIC_VAR_INIT(NULL) }, \
+    /* .watermark_high        = */ 0, \
+    /* .watermark_low         = */ 0, \
+    /* .watermark_reached     = */ ATOMIC_VAR_INIT(false), \
+    /* .region                = */ (NULL), \
+    /* .region_pending        = */ ATOMIC_VAR_INIT(NULL), \
+    /* .region_retired        = */ ATOMIC_VAR_INIT(NULL), \
+    BUFFER_INIT_STATS \
+    BUFFER_INIT_LATENCY \
+    BUFFER_INIT_CRC \
+    BUFFER_INIT_SNAPSHOT \
 } //;
 
 
@@ -919,10 +1997,27 @@ size_t buffer_write(buffer_t * object, const char *src, size_t n);
     /* .end_of_line_character = */ '\n', \
     /* .consumer_ptr          = */ (DATA), \
     /* .producer_ptr          = */ ATOMIC_VAR_INIT(DATA), \
+    /* .rewind_ptr            = */ ATOMIC_VAR_INIT(NULL), \
     /* .length                = */ ATOMIC_VAR_INIT(0), \
     /* .lines                 = */ ATOMIC_VAR_INIT(0), \
     /* .state                 = */ ATOMIC_VAR_INIT( ( (NULL != (DATA)) && (0 != (DATA_LENGTH)) && (START) ) ? BUFFER_FLAGS_IDLE : BUFFER_FLAGS_STOP ), \
     /* .user_data             = */ (NULL), \
+    /* .line_index            = */ (NULL), \
+    /* .delimiters            = */ (NULL), \
+    /* .tail_produced         = */ 0, \
+    /* .tail_consumed         = */ 0, \
+    /* .removed               = */ 0, \
+    /* .waiters               = */ { ATOMIC_VAR_INIT(NULL), ATOMIC_VAR_INIT(NULL), ATOMIC_VAR_INIT(NULL) }, \
+    /* .watermark_high        = */ 0, \
+    /* .watermark_low         = */ 0, \
+    /* .watermark_reached     = */ ATOMIC_VAR_INIT(false), \
+    /* .region                = */ (NULL), \
+    /* .region_pending        = */ ATOMIC_VAR_INIT(NULL), \
+    /* .region_retired        = */ ATOMIC_VAR_INIT(NULL), \
+    BUFFER_INIT_STATS \
+    BUFFER_INIT_LATENCY \
+    BUFFER_INIT_CRC \
+    BUFFER_INIT_SNAPSHOT \
 } //;
 
 #endif
@@ -0,0 +1,303 @@
+//! @file
+//! @brief The buffer chunk chain header file.
+//!
+//! @details A growable character buffer made of fixed-size chunks from a shared pool.
+//! For more information see: @ref buffer_chain
+
+
+#ifndef INC_BUFFER_CHAIN_H_
+#define INC_BUFFER_CHAIN_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_CHAIN_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_chain Growable chunk chain
+//!
+//! @details The capacity of a ::buffer_t is fixed with ::buffer_init(). A ::buffer_chain_t
+//! instead links chunks of a fixed size from a ::buffer_chunk_pool_t, which many chains share.
+//!
+//! - The producer appends a chunk from the pool when the last chunk is full, up to
+//!   ::buffer_chain_s::max_chunks. The consumer returns a chunk to the pool as soon as it
+//!   has read past its end. Existing data is never copied.
+//! - The pool is a lock-free stack of chunk positions, the position is tagged with a
+//!   counter against the ABA problem. Producers and consumers of any chain may take and
+//!   return chunks at the same time.
+//! - The lifecycle, the handlers, ::buffer_s::length and ::buffer_s::lines are those of the
+//!   embedded ::buffer_chain_s::buffer, use ::buffer_start(), ::buffer_stop_force(),
+//!   ::buffer_stop_try(), ::buffer_length() and ::buffer_lines() with it.
+//! - The handlers buffer_s::on_full, buffer_s::on_new_character, buffer_s::on_new_line and
+//!   buffer_s::on_empty of the embedded buffer are called.
+//! - The waiters and watermarks of the embedded buffer are signaled, see \ref buffer_waiter
+//!   and \ref buffer_watermark. The free space of a chain depends on the shared pool,
+//!   ::buffer_waiter_arm() therefore reports ::BUFFER_WAIT_SPACE as fulfilled right away.
+//! - The character functions, e.g. ::buffer_set(), must not be used with the embedded buffer.
+//!   Its ::buffer_s::data and ::buffer_s::last point to the first chunk only so that it can be
+//!   started, they do not follow the chain and are not checked by these functions.
+//!
+//! @{
+
+#ifndef BUFFER_CHUNK_ALIGNMENT
+
+  //! @brief Alignment of the chunks, must be a power of two
+  #define BUFFER_CHUNK_ALIGNMENT 16
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+typedef struct buffer_chunk_s buffer_chunk_t;
+
+//! @brief Header in front of the characters of each chunk
+struct buffer_chunk_s
+{
+    //! @brief Next chunk of the chain, written by the producer/set thread
+    volatile _Atomic(buffer_chunk_t *) next;
+
+    //! @brief Position plus one of the next free chunk in the pool, 0 if there is none
+    volatile _Atomic(uint32_t) free_next;
+};
+
+//! @brief Shared pool of chunks, see: \ref buffer_chain
+typedef struct buffer_chunk_pool_s
+{
+    //! @brief Top of the free chunks, the position plus one in the lower and a tag in the upper 32 bits
+    volatile _Atomic(uint64_t) free;
+
+    //! @brief Number of free chunks
+    volatile _Atomic(size_t) available;
+
+    //! @brief Start of the first chunk, aligned to ::BUFFER_CHUNK_ALIGNMENT
+    char * chunks;
+
+    //! @brief Distance between two chunks
+    size_t stride;
+
+    //! @brief Number of characters of a chunk
+    size_t chunk_size;
+
+    //! @brief Number of chunks
+    size_t count;
+}buffer_chunk_pool_t;
+
+//! @brief Growable character buffer, see: \ref buffer_chain
+typedef struct buffer_chain_s
+{
+    //! @brief Buffer for the lifecycle, the handlers, the length, the lines and the user data
+    buffer_t buffer;
+
+    //! @brief Pool of the chunks
+    buffer_chunk_pool_t * pool;
+
+    //! @brief Maximum number of chunks of the chain
+    size_t max_chunks;
+
+    //! @brief Number of chunks of the chain
+    volatile _Atomic(size_t) chunks;
+
+    //! @brief To separate the position of the producer
+    char padding_producer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Last chunk, only used by the producer/set thread
+    buffer_chunk_t * tail;
+
+    //! @brief Position of the next character to write in the last chunk
+    size_t tail_offset;
+
+    //! @brief To separate the position of the consumer
+    char padding_consumer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief First chunk, only used by the consumer/get thread
+    buffer_chunk_t * head;
+
+    //! @brief Position of the next character to read in the first chunk
+    size_t head_offset;
+
+    //! @brief To separate the position of the consumer from the following data
+    char padding_back[BUFFER_CACHE_LINE_SIZE];
+}buffer_chain_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_chain can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_chain_sc
+{
+    size_t (* Chunks       ) (const buffer_chain_t * object); ///< @brief See ::buffer_chain_chunks()
+    void   (* Exit         ) (buffer_chain_t * object); ///< @brief See ::buffer_chain_exit()
+    char   (* Get          ) (buffer_chain_t * object); ///< @brief See ::buffer_chain_get()
+    bool   (* Init         ) (buffer_chain_t * object, buffer_chunk_pool_t * pool, size_t max_chunks, bool start); ///< @brief See ::buffer_chain_init()
+    size_t (* PoolAvailable) (const buffer_chunk_pool_t * pool); ///< @brief See ::buffer_chunk_pool_available()
+    bool   (* PoolInit     ) (buffer_chunk_pool_t * pool, char * data, size_t sizeof_data, size_t chunk_size); ///< @brief See ::buffer_chunk_pool_init()
+    size_t (* Read         ) (buffer_chain_t * object, char * dest, size_t n); ///< @brief See ::buffer_chain_read()
+    size_t (* ReadLine     ) (buffer_chain_t * object, char * dest, size_t n); ///< @brief See ::buffer_chain_read_line()
+    bool   (* Set          ) (buffer_chain_t * object, char c); ///< @brief See ::buffer_chain_set()
+    size_t (* Write        ) (buffer_chain_t * object, const char * src, size_t n); ///< @brief See ::buffer_chain_write()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the chunk chain
+extern const struct buffer_chain_sc buffer_chain;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Returns the number of chunks of the chain
+//!
+//! @param[in] object The chain
+//! @return Returns the number of chunks
+size_t buffer_chain_chunks(const buffer_chain_t * object);
+
+//! @brief Stops the chain and returns all chunks to the pool
+//!
+//! @details The characters that were not read are discarded. The producer and consumer
+//! must not use the chain anymore.
+//!
+//! @param[in,out] object The chain
+void buffer_chain_exit(buffer_chain_t * object);
+
+//! @brief Reads a character, see ::buffer_get_available_or_null()
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The chain
+//! @return Returns the character, '\\0' if the chain is empty or stopped
+char buffer_chain_get(buffer_chain_t * object);
+
+//! @brief Initializes the chain with one chunk of the pool
+//!
+//! @attention The embedded buffer points to the first chunk, see \ref buffer_chain. Characters
+//! written to it with the character functions overwrite the chain.
+//!
+//! @param[out] object The chain
+//! @param[in,out] pool The pool, see ::buffer_chunk_pool_init()
+//! @param max_chunks Maximum number of chunks, at least 1
+//! @param start Starts the chain, see ::buffer_start()
+//! @return Returns whether the chain was initialized
+//! @retval false A parameter is invalid or the pool has no free chunk
+bool buffer_chain_init(buffer_chain_t * object, buffer_chunk_pool_t * pool, size_t max_chunks, bool start);
+
+//! @brief Reads a string from the chain, see ::buffer_read()
+//!
+//! @details A string terminating character '\\0' is always written at the end.
+//! This means that one character less is read than is specified in parameter @p n.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The chain
+//! @param[out] dest The string is written in this buffer.
+//! @param n The length of the buffer (@p dest parameter) including the string terminator character '\\0'
+//! @return Returns the number of characters read
+size_t buffer_chain_read(buffer_chain_t * object, char * dest, size_t n);
+
+//! @brief Reads a line from the chain, see ::buffer_read_line()
+//!
+//! @details A string terminating character '\\0' is always written at the end.
+//! The End-Of-Line character is only removed if the whole line fits.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The chain
+//! @param[out] dest The line is written in this buffer.
+//! @param n The length of the buffer (@p dest parameter) including the string terminator character '\\0'
+//! @return Returns the number of characters read
+size_t buffer_chain_read_line(buffer_chain_t * object, char * dest, size_t n);
+
+//! @brief Writes a character, see ::buffer_set_possible_or_skip()
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The chain
+//! @param c The character
+//! @return Returns whether the character was written
+//! @retval false Skipped, the chain has ::buffer_chain_s::max_chunks chunks, the pool is
+//! empty or the chain is stopped
+bool buffer_chain_set(buffer_chain_t * object, char c);
+
+//! @brief Writes a string to the chain, see ::buffer_write()
+//!
+//! @details The characters are published together after they were copied.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The chain
+//! @param[in] src Contains the string or the characters.
+//! @param n The number of characters, the string terminator character '\\0' is not written
+//! @return Returns the number of characters written
+size_t buffer_chain_write(buffer_chain_t * object, const char * src, size_t n);
+
+//! @brief Returns the number of free chunks of the pool
+//!
+//! @param[in] pool The pool
+//! @return Returns the number of free chunks
+size_t buffer_chunk_pool_available(const buffer_chunk_pool_t * pool);
+
+//! @brief Divides the data array into chunks
+//!
+//! @param[out] pool The pool
+//! @param[in] data Memory of the chunks
+//! @param sizeof_data The length of @p data
+//! @param chunk_size Number of characters of a chunk
+//! @return Returns whether at least one chunk fits into @p data
+bool buffer_chunk_pool_init(buffer_chunk_pool_t * pool, char * data, size_t sizeof_data, size_t chunk_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_CHAIN_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_CHAIN_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_CHAIN_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
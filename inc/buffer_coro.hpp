@@ -0,0 +1,329 @@
+//! @file
+//! @brief The buffer coroutine header file.
+//!
+//! @details C++20 awaitables for a buffer object, based on the one-shot waiters.
+//! For more information see: @ref buffer_coro
+
+
+#ifndef INC_BUFFER_CORO_HPP_
+#define INC_BUFFER_CORO_HPP_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <coroutine>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_coro C++20 coroutine awaitables
+//!
+//! @details A ::buffer_coro::channel wraps a buffer object, its functions return awaitables:
+//! `co_await channel.read_line(dest)`, `co_await channel.read_to(pattern, dest)`,
+//! `co_await channel.write(src)` and `co_await channel.get()`.
+//!
+//! - If data or space is missing, the coroutine arms a waiter and suspends, no thread
+//!   blocks or spins, see: \ref buffer_waiter
+//! - The operation is continued by the thread that causes the transition, e.g. the producer
+//!   completes a pending read. The coroutine is then resumed in this thread or, if a
+//!   ::buffer_coro::scheduler_t is set, passed to it, e.g. an executor.
+//! - Only one coroutine may read and one may write a buffer object at a time.
+//! - If the buffer is stopped, the awaitables complete, the read functions return no value.
+//!
+//! @{
+//! @}
+
+
+namespace buffer_coro
+{
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Resumes a coroutine, e.g. posts it to an executor
+//!
+//! @param handle The coroutine to resume
+//! @param context The context passed to ::buffer_coro::channel
+using scheduler_t = void (*)(std::coroutine_handle<> handle, void * context);
+
+//! @brief Common part of all awaitables, @p Derived provides `step()` and `event()`
+//!
+//! @details `step()` tries to complete the operation and returns `true` if it is complete.
+template<class Derived, class Result>
+class basic_awaiter
+{
+public:
+    basic_awaiter(buffer_t * object, scheduler_t scheduler, void * context) noexcept
+        : object_(object), scheduler_(scheduler), context_(context)
+    {
+    }
+
+    bool await_ready() noexcept
+    {
+        return derived().step();
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        handle_ = handle;
+        waiter_.wake = &basic_awaiter::wake;
+        waiter_.context = this;
+
+        while(!arm())
+        {
+            if(derived().step()) { return false; }
+        }
+
+        // The waiter may already be woken, this object must not be used anymore
+        return true;
+    }
+
+    Result await_resume() noexcept
+    {
+        return result_;
+    }
+
+protected:
+    //! @brief Returns whether the buffer was stopped
+    bool stopped() const noexcept
+    {
+        return BUFFER_FLAGS_IDLE > atomic_load(&object_->state);
+    }
+
+    buffer_t * object_;
+    Result result_{};
+    size_t seen_ = 0; ///< Readable characters that do not complete the operation, see ::buffer_waiter_s::seen
+
+private:
+    Derived & derived() noexcept
+    {
+        return *static_cast<Derived *>(this);
+    }
+
+    static void wake(buffer_waiter_t * waiter) noexcept
+    {
+        basic_awaiter * self = static_cast<basic_awaiter *>(waiter->context);
+
+        while(!self->derived().step())
+        {
+            if(self->arm()) { return; }
+        }
+
+        if(nullptr != self->scheduler_)
+        {
+            self->scheduler_(self->handle_, self->context_);
+        }
+        else
+        {
+            self->handle_.resume();
+        }
+    }
+
+    bool arm() noexcept
+    {
+        waiter_.seen = seen_;
+
+        return buffer_waiter_arm(object_, derived().event(), &waiter_);
+    }
+
+    scheduler_t scheduler_;
+    void * context_;
+    buffer_waiter_t waiter_{};
+    std::coroutine_handle<> handle_;
+};
+
+//! @brief Awaitable of ::buffer_coro::channel::get()
+class get_awaiter : public basic_awaiter<get_awaiter, std::optional<char>>
+{
+public:
+    using basic_awaiter::basic_awaiter;
+
+    bool step() noexcept
+    {
+        if(0 < atomic_load(&object_->length))
+        {
+            result_ = buffer_get_available_or_null(object_);
+            return true;
+        }
+
+        return stopped();
+    }
+
+    buffer_wait_event_t event() const noexcept { return BUFFER_WAIT_DATA; }
+};
+
+//! @brief Awaitable of ::buffer_coro::channel::read_line()
+class read_line_awaiter : public basic_awaiter<read_line_awaiter, std::optional<size_t>>
+{
+public:
+    read_line_awaiter(buffer_t * object, scheduler_t scheduler, void * context, std::span<char> dest) noexcept
+        : basic_awaiter(object, scheduler, context), dest_(dest)
+    {
+    }
+
+    bool step() noexcept
+    {
+        if(0 < atomic_load(&object_->lines))
+        {
+            result_ = buffer_read_line(object_, dest_.data(), dest_.size());
+            return true;
+        }
+
+        return stopped();
+    }
+
+    buffer_wait_event_t event() const noexcept { return BUFFER_WAIT_LINE; }
+
+private:
+    std::span<char> dest_;
+};
+
+//! @brief Awaitable of ::buffer_coro::channel::read_to()
+class read_to_awaiter : public basic_awaiter<read_to_awaiter, std::optional<size_t>>
+{
+public:
+    read_to_awaiter(buffer_t * object, scheduler_t scheduler, void * context, std::string_view to, std::span<char> dest) noexcept
+        : basic_awaiter(object, scheduler, context), to_(to), dest_(dest)
+    {
+    }
+
+    bool step() noexcept
+    {
+        const char * span;
+        size_t length = buffer_read_span(object_, &span);
+
+        // Only the new characters and the overlap with a pattern that started before them are searched
+        size_t from = (!to_.empty() && (to_.size() <= seen_)) ? (seen_ - to_.size() + 1) : 0;
+
+        size_t i = (from < length) ? std::string_view(span, length).find(to_, from) : std::string_view::npos;
+
+        if(std::string_view::npos == i)
+        {
+            // The span only grows until the pattern is found, the waiter waits for more characters
+            seen_ = length;
+            return stopped();
+        }
+
+        // As buffer_read_to(), the characters in front of the pattern are copied
+        if(!dest_.empty())
+        {
+            size_t n = (i < dest_.size()) ? i : (dest_.size() - 1);
+            std::memcpy(dest_.data(), span, n);
+            dest_[n] = '\0';
+        }
+
+        buffer_read_consume(object_, i + to_.size());
+
+        result_ = i;
+        return true;
+    }
+
+    buffer_wait_event_t event() const noexcept { return BUFFER_WAIT_DATA; }
+
+private:
+    std::string_view to_;
+    std::span<char> dest_;
+};
+
+//! @brief Awaitable of ::buffer_coro::channel::write()
+class write_awaiter : public basic_awaiter<write_awaiter, size_t>
+{
+public:
+    write_awaiter(buffer_t * object, scheduler_t scheduler, void * context, std::span<const char> src) noexcept
+        : basic_awaiter(object, scheduler, context), src_(src)
+    {
+    }
+
+    bool step() noexcept
+    {
+        while(result_ < src_.size())
+        {
+            char * span;
+            size_t space = buffer_write_reserve(object_, &span);
+
+            if(0 == space) { break; }
+
+            size_t n = src_.size() - result_;
+            if(space < n) { n = space; }
+
+            std::memcpy(span, src_.data() + result_, n);
+            result_ += buffer_write_commit(object_, span, n);
+        }
+
+        return (result_ == src_.size()) || stopped();
+    }
+
+    buffer_wait_event_t event() const noexcept { return BUFFER_WAIT_SPACE; }
+
+private:
+    std::span<const char> src_;
+};
+
+//! @brief Wraps a buffer object for coroutines, see: \ref buffer_coro
+class channel
+{
+public:
+    //! @param object The buffer object
+    //! @param scheduler Resumes the coroutines, `nullptr` resumes them directly
+    //! @param context Passed to @p scheduler
+    explicit channel(buffer_t * object, scheduler_t scheduler = nullptr, void * context = nullptr) noexcept
+        : object_(object), scheduler_(scheduler), context_(context)
+    {
+    }
+
+    //! @brief Returns the buffer object
+    buffer_t * object() const noexcept { return object_; }
+
+    //! @brief Waits for a character and reads it
+    //! @return The character, no value if the buffer was stopped
+    get_awaiter get() const noexcept
+    {
+        return get_awaiter(object_, scheduler_, context_);
+    }
+
+    //! @brief Waits for a line and reads it, see ::buffer_read_line()
+    //! @return The number of characters read, no value if the buffer was stopped
+    read_line_awaiter read_line(std::span<char> dest) const noexcept
+    {
+        return read_line_awaiter(object_, scheduler_, context_, dest);
+    }
+
+    //! @brief Waits for the pattern @p to and reads the characters in front of it, see ::buffer_read_to()
+    //! @return The number of characters in front of the pattern, no value if the buffer was stopped
+    read_to_awaiter read_to(std::string_view to, std::span<char> dest) const noexcept
+    {
+        return read_to_awaiter(object_, scheduler_, context_, to, dest);
+    }
+
+    //! @brief Writes all characters, waits for space if necessary
+    //! @return The number of characters written, less only if the buffer was stopped
+    write_awaiter write(std::span<const char> src) const noexcept
+    {
+        return write_awaiter(object_, scheduler_, context_, src);
+    }
+
+private:
+    buffer_t * object_;
+    scheduler_t scheduler_;
+    void * context_;
+};
+
+} // namespace buffer_coro
+
+
+#endif /* INC_BUFFER_CORO_HPP_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,218 @@
+//! @file
+//! @brief The buffer checksum header file.
+//!
+//! @details Computes the CRC32C of each line or record while the producer publishes it,
+//! so that the consumer validates a frame with a single comparison.
+//! The module is activated with the ::BUFFER_ENABLE_CRC define.
+//! For more information see: @ref buffer_enable_crc
+
+
+#ifndef INC_BUFFER_CRC_H_
+#define INC_BUFFER_CRC_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_CRC_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_enable_crc Optional checksum on ingest
+//!
+//! @details The checksums are activated by setting the ::BUFFER_ENABLE_CRC define,
+//! a ::buffer_crc_t object is then attached with ::buffer_crc_attach().
+//!
+//! - The define must be set for all files, otherwise not enough space is reserved during
+//!   use and problems occur when calling.
+//! - A frame is a line without its End-Of-Line character or the data of a record.
+//!   The producer updates the CRC32C of the current frame with the characters it publishes,
+//!   ::buffer_write_commit() does it once per span. Each character is touched only once.
+//! - The CRC32C of a finished frame is stored in a lock-free side ring of
+//!   ::BUFFER_CRC_ENTRIES entries before the frame is published.
+//! - The consumer reads the CRC32C of the next frame with ::buffer_crc_frame() and compares
+//!   it with the expected value, the entry is released when the frame is read.
+//! - If more frames are waiting than the side ring can hold, the values of the further
+//!   frames are not stored and counted in ::buffer_crc_s::dropped.
+//! - ::buffer_crc32c() uses the `crc32` instruction of SSE4.2 if the CPU supports it,
+//!   otherwise a table. The values are the same, "123456789" gives `0xE3069283`.
+//!
+//! @{
+
+#ifndef BUFFER_CRC_ENTRIES
+
+  //! @brief Number of entries in the side ring, must be a power of two
+  #define BUFFER_CRC_ENTRIES 64
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Entry of the side ring
+typedef struct buffer_crc_entry_s
+{
+    volatile _Atomic(size_t) sequence; ///< Frame number plus one, 0 if unused
+    volatile _Atomic(uint32_t) value;  ///< CRC32C of the frame
+}buffer_crc_entry_t;
+
+//! @brief Checksums of a buffer object, see: \ref buffer_enable_crc
+typedef struct buffer_crc_s
+{
+    //! @brief Side ring with the values of the published frames
+    buffer_crc_entry_t entries[BUFFER_CRC_ENTRIES];
+
+    //! @brief CRC32C of the characters of the current frame, only used by the producer/set thread
+    uint32_t running;
+
+    //! @brief Number of published frames, written by the producer/set thread
+    volatile _Atomic(size_t) published;
+
+    //! @brief Number of frames without value, written by the producer/set thread
+    volatile _Atomic(size_t) dropped;
+
+    //! @brief To separate the counter of the consumer
+    char padding[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Number of consumed frames, written by the consumer/get thread
+    volatile _Atomic(size_t) consumed;
+}buffer_crc_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_crc can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_crc_sc
+{
+    bool     (* Attach ) (buffer_t * object, buffer_crc_t * crc); ///< @brief See ::buffer_crc_attach()
+    uint32_t (* Compute) (uint32_t crc, const void * src, size_t n); ///< @brief See ::buffer_crc32c()
+    bool     (* Frame  ) (const buffer_t * object, uint32_t * value); ///< @brief See ::buffer_crc_frame()
+    bool     (* Range  ) (const buffer_t * object, size_t offset, size_t n, uint32_t * value); ///< @brief See ::buffer_crc_range()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the checksums
+extern const struct buffer_crc_sc buffer_crc;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Continues a CRC32C (Castagnoli) with further bytes
+//!
+//! @details Uses SSE4.2 if available. Can be used in any thread.
+//!
+//! @param crc The value of the previous bytes, 0 for none
+//! @param[in] src The bytes
+//! @param n The number of bytes
+//! @return The CRC32C of the previous bytes and @p src
+uint32_t buffer_crc32c(uint32_t crc, const void * src, size_t n);
+
+//! @brief Attaches the checksums to the buffer
+//!
+//! @details Clears the side ring and the counters. `NULL` detaches the checksums.
+//!
+//! @attention Must not be used if one of the threads is used. Stop the buffer with
+//! ::buffer_stop_force() or ::buffer_stop_try() and check the return value.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in,out] crc The checksums, `NULL` is allowed
+//! @return Returns whether the checksums could be attached
+//! @retval true  Attached or detached
+//! @retval false @p object was `NULL` or ::BUFFER_ENABLE_CRC is not set
+bool buffer_crc_attach(buffer_t * object, buffer_crc_t * crc);
+
+//! @brief Returns the CRC32C of the next unread line or record
+//!
+//! @details The value belongs to the frame that ::buffer_read_line() or ::buffer_pop_record()
+//! returns next. It is only available once the frame is complete.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in] object The buffer object
+//! @param[out] value The CRC32C of the frame
+//! @return Returns whether the value is available
+//! @retval false No checksums attached, no complete frame or its value was dropped
+bool buffer_crc_frame(const buffer_t * object, uint32_t * value);
+
+//! @brief Computes the CRC32C of unread characters
+//!
+//! @details The characters are read in place, nothing is copied or removed.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in] object The buffer object
+//! @param offset Number of unread characters in front of the range
+//! @param n Number of characters of the range
+//! @param[out] value The CRC32C of the range
+//! @return Returns whether the range is unread
+bool buffer_crc_range(const buffer_t * object, size_t offset, size_t n, uint32_t * value);
+
+//! @brief Adds characters to the current frame
+//!
+//! @details Called by the buffer functions in the producer/set thread.
+//!
+//! @param[in,out] crc The checksums
+//! @param[in] src The characters
+//! @param n The number of characters
+void buffer_crc_update(buffer_crc_t * crc, const void * src, size_t n);
+
+//! @brief Stores the value of the current frame and starts the next one
+//!
+//! @details Called by the buffer functions in the producer/set thread before the
+//! frame is published.
+//!
+//! @param[in,out] crc The checksums
+void buffer_crc_publish(buffer_crc_t * crc);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_CRC_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_CRC_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_CRC_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
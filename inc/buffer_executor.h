@@ -0,0 +1,211 @@
+//! @file
+//! @brief The buffer executor header file.
+//!
+//! @details A small thread pool that runs the line handlers of buffer objects instead of the
+//! producer/set thread. For more information see: @ref buffer_executor
+
+
+#ifndef INC_BUFFER_EXECUTOR_H_
+#define INC_BUFFER_EXECUTOR_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdbool.h>
+#include <threads.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_EXECUTOR_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_executor Executor for line handlers
+//!
+//! @details buffer_s::on_new_line runs inside ::buffer_set() and stalls the producer/set
+//! thread as long as the handler runs. With ::buffer_executor_line_attach() the line events
+//! of a buffer object are passed to a ::buffer_executor_t instead and the handler runs in
+//! one of its worker threads.
+//!
+//! - The producer/set thread only pays for the enqueue of a task, a lock-free push. A mutex
+//!   is only taken if a worker thread sleeps.
+//! - The events are coalesced per buffer object, the task is queued at most once. The handler
+//!   should read all available lines, it is called again if lines remain.
+//! - The handler is the consumer/get thread of the buffer object.
+//! - Any ::buffer_task_t can be submitted with ::buffer_executor_submit().
+//!
+//! @{
+
+#ifndef BUFFER_EXECUTOR_THREADS
+
+  //! @brief Maximum number of worker threads of an executor
+  #define BUFFER_EXECUTOR_THREADS 8
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+typedef struct buffer_task_s buffer_task_t;
+
+//! @brief Function of a task
+//!
+//! @param[in,out] task The task
+typedef void (*buffer_task_handler_t)(buffer_task_t * task);
+
+//! @brief Task that is run by the executor, see: \ref buffer_executor
+struct buffer_task_s
+{
+    buffer_task_t * next;          ///< Next task in the queue
+    buffer_task_handler_t run;     ///< Function of the task
+    void * context;                ///< Freely usable
+    volatile _Atomic(bool) queued; ///< The task is in the queue and not yet started
+};
+
+//! @brief Thread pool, see: \ref buffer_executor
+typedef struct buffer_executor_s
+{
+    volatile _Atomic(buffer_task_t *) head; ///< Newly submitted tasks, newest first
+    buffer_task_t * ready;                  ///< Taken over tasks, oldest first, protected by the mutex
+    volatile _Atomic(size_t) sleeping;      ///< Number of worker threads waiting for a task
+    volatile _Atomic(bool) stop;            ///< The worker threads are ended
+    mtx_t mutex;                            ///< Protects the removal from the queue and the sleep
+    cnd_t condition;                        ///< Wakes a sleeping worker thread
+    thrd_t threads[BUFFER_EXECUTOR_THREADS]; ///< The worker threads
+    size_t count;                           ///< Number of worker threads
+}buffer_executor_t;
+
+//! @brief Handler of a line event, called in a worker thread
+//!
+//! @param[in,out] object The buffer object
+typedef void (*buffer_executor_handler_t)(buffer_t * object);
+
+//! @brief Connects the line events of a buffer object with an executor
+typedef struct buffer_executor_line_s
+{
+    buffer_waiter_t waiter;              ///< Armed for ::BUFFER_WAIT_LINE
+    buffer_task_t task;                  ///< Runs the handler
+    buffer_executor_t * executor;        ///< The executor
+    buffer_t * object;                   ///< The buffer object
+    buffer_executor_handler_t handler;   ///< The handler
+    volatile _Atomic(bool) attached;     ///< `false` after ::buffer_executor_line_detach()
+}buffer_executor_line_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_executor can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_executor_sc
+{
+    void (* Exit      ) (buffer_executor_t * executor); ///< @brief See ::buffer_executor_exit()
+    bool (* Init      ) (buffer_executor_t * executor, size_t threads); ///< @brief See ::buffer_executor_init()
+    bool (* LineAttach) (buffer_executor_t * executor, buffer_executor_line_t * line, buffer_t * object, buffer_executor_handler_t handler); ///< @brief See ::buffer_executor_line_attach()
+    bool (* LineDetach) (buffer_executor_line_t * line); ///< @brief See ::buffer_executor_line_detach()
+    bool (* Submit    ) (buffer_executor_t * executor, buffer_task_t * task); ///< @brief See ::buffer_executor_submit()
+    void (* Task      ) (buffer_task_t * task, buffer_task_handler_t run, void * context); ///< @brief See ::buffer_executor_task()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the executor
+extern const struct buffer_executor_sc buffer_executor;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Ends the worker threads
+//!
+//! @details Waits until the running tasks are finished, queued tasks are not run.
+//!
+//! @param[in,out] executor The executor
+void buffer_executor_exit(buffer_executor_t * executor);
+
+//! @brief Initializes the executor and starts the worker threads
+//!
+//! @param[out] executor The executor
+//! @param threads Number of worker threads, at most ::BUFFER_EXECUTOR_THREADS
+//! @return Returns whether all worker threads were started
+bool buffer_executor_init(buffer_executor_t * executor, size_t threads);
+
+//! @brief Runs the handler in the executor whenever a line is published
+//!
+//! @details Lines that are already in the buffer are passed to the handler immediately.
+//!
+//! @param[in,out] executor The executor
+//! @param[out] line Memory for the connection, must stay valid until the executor is ended
+//! @param[in,out] object The buffer object
+//! @param handler The handler, should read all available lines
+//! @return Returns whether the connection was established
+bool buffer_executor_line_attach(buffer_executor_t * executor, buffer_executor_line_t * line, buffer_t * object, buffer_executor_handler_t handler);
+
+//! @brief Ends the connection of ::buffer_executor_line_attach()
+//!
+//! @details A handler that is already queued or running is still finished.
+//!
+//! @param[in,out] line The connection
+//! @return Returns whether the connection was idle, i.e. no handler is queued or running
+bool buffer_executor_line_detach(buffer_executor_line_t * line);
+
+//! @brief Queues a task
+//!
+//! @details Can be used in any thread. A task that is already queued is not queued again,
+//! a task that is running is queued again.
+//!
+//! @param[in,out] executor The executor
+//! @param[in,out] task The task, see ::buffer_executor_task()
+//! @return Returns whether the task was queued
+//! @retval false Already queued, or the executor is stopped
+bool buffer_executor_submit(buffer_executor_t * executor, buffer_task_t * task);
+
+//! @brief Initializes a task
+//!
+//! @param[out] task The task
+//! @param run Function of the task
+//! @param context Freely usable
+void buffer_executor_task(buffer_task_t * task, buffer_task_handler_t run, void * context);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_EXECUTOR_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_EXECUTOR_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_EXECUTOR_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
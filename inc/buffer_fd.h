@@ -0,0 +1,102 @@
+//! @file
+//! @brief The buffer file descriptor header file.
+//!
+//! @details Transfers data between a buffer object and a POSIX file descriptor, e.g. a
+//! UART, a pipe or a socket, without an intermediate copy. The functions use
+//! ::buffer_write_reserve() and ::buffer_read_span(), `read()` and `write()` work
+//! directly on the free and readable space of the buffer.
+
+
+#ifndef INC_BUFFER_FD_H_
+#define INC_BUFFER_FD_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <sys/types.h> // ssize_t
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_fd can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_fd_sc
+{
+    ssize_t (* Drain) (buffer_t * object, int fd, size_t max); ///< @brief See ::buffer_drain_to_fd()
+    ssize_t (* Fill ) (buffer_t * object, int fd, size_t max); ///< @brief See ::buffer_fill_from_fd()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the file descriptor transfer
+extern const struct buffer_fd_sc buffer_fd;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Writes the readable characters of the buffer to a file descriptor
+//!
+//! @details Writes until @p max characters are written, the buffer is empty or the file
+//! descriptor does not accept more characters. Interrupted calls are repeated.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param fd The file descriptor, blocking or non-blocking
+//! @param max The maximum number of characters
+//! @return Returns the number of characters written, like `write()`
+//! @retval 0  The buffer is empty or @p max is 0
+//! @retval -1 Nothing was written, `errno` is set, `EAGAIN` or `EWOULDBLOCK` for
+//! a non-blocking file descriptor that is not ready
+ssize_t buffer_drain_to_fd(buffer_t * object, int fd, size_t max);
+
+//! @brief Reads characters from a file descriptor into the buffer
+//!
+//! @details Reads until @p max characters are read, the buffer is full or the file
+//! descriptor has no more characters. Interrupted calls are repeated.
+//! Lines are counted and the handlers are called, see ::buffer_write_commit().
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param fd The file descriptor, blocking or non-blocking
+//! @param max The maximum number of characters
+//! @return Returns the number of characters read, like `read()`
+//! @retval 0  End of file
+//! @retval -1 Nothing was read, `errno` is set, `EAGAIN` or `EWOULDBLOCK` for
+//! a non-blocking file descriptor that is not ready, `ENOBUFS` if the buffer is full
+//! or stopped
+ssize_t buffer_fill_from_fd(buffer_t * object, int fd, size_t max);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUFFER_FD_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,226 @@
+//! @file
+//! @brief The buffer group header file.
+//!
+//! @details One consumer/get thread waits for many buffer objects at once.
+//! For more information see: @ref buffer_group
+
+
+#ifndef INC_BUFFER_GROUP_H_
+#define INC_BUFFER_GROUP_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_GROUP_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_group Group of buffer objects with a readiness bitmap
+//!
+//! @details A consumer/get thread that serves many buffer objects, e.g. one per UART, would
+//! call ::buffer_lines() on every one of them in each cycle. A ::buffer_group_t instead
+//! arms a waiter per member, see \ref buffer_waiter, and the producer/set thread sets the
+//! bit of its member in a readiness bitmap on the transition.
+//!
+//! - The bitmap has two levels, a bit in ::buffer_group_s::summary marks a non-empty word of
+//!   ::buffer_group_s::ready. ::buffer_group_next() only touches the words with ready members.
+//! - The members are returned in turn, a member that is always ready does not hide the others.
+//! - A returned member is not marked again until ::buffer_group_rearm() is called, usually
+//!   after its characters or lines were read. Members that still have data are marked at once.
+//! - ::buffer_group_wait() sleeps until a member is ready or the deadline has passed, see
+//!   ::buffer_until_now(). On Linux a futex is used, on other systems the thread sleeps in
+//!   steps of ::BUFFER_UNTIL_SLEEP_NS.
+//! - The group uses the waiter of ::BUFFER_WAIT_DATA or ::BUFFER_WAIT_LINE of each member,
+//!   no other waiter may be armed for this transition.
+//! - Stopping a member also marks it.
+//!
+//! @{
+
+#ifndef BUFFER_GROUP_WORDS
+
+  //! @brief Number of 64-bit words of the bitmap, at most 64
+  #define BUFFER_GROUP_WORDS 8
+
+#endif
+
+//! @brief Maximum number of members of a group
+#define BUFFER_GROUP_MEMBERS (BUFFER_GROUP_WORDS * 64)
+
+//! @brief Index that is returned if no member is ready
+#define BUFFER_GROUP_NONE SIZE_MAX
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+typedef struct buffer_group_s buffer_group_t;
+
+//! @brief Member of a group, see: \ref buffer_group
+typedef struct buffer_group_member_s
+{
+    buffer_waiter_t waiter;    ///< Armed for ::buffer_group_member_s::event
+    buffer_group_t * group;    ///< The group
+    buffer_t * object;         ///< The buffer object
+    buffer_wait_event_t event; ///< ::BUFFER_WAIT_DATA or ::BUFFER_WAIT_LINE
+    size_t index;              ///< Position in ::buffer_group_s::members
+}buffer_group_member_t;
+
+//! @brief Group of buffer objects, see: \ref buffer_group
+struct buffer_group_s
+{
+    //! @brief Bit i is set if the word i of ::buffer_group_s::ready is not 0
+    volatile _Atomic(uint64_t) summary;
+
+    //! @brief Bit j of word i is set if the member i * 64 + j is ready
+    volatile _Atomic(uint64_t) ready[BUFFER_GROUP_WORDS];
+
+    //! @brief Changed by a producer/set thread if the consumer/get thread sleeps
+    volatile _Atomic(int) sequence;
+
+    //! @brief Number of sleeping consumer/get threads, 0 or 1
+    volatile _Atomic(size_t) sleeping;
+
+    //! @brief The members
+    buffer_group_member_t members[BUFFER_GROUP_MEMBERS];
+
+    //! @brief Number of members
+    size_t count;
+
+    //! @brief Word at which ::buffer_group_next() continues, only used by the consumer/get thread
+    size_t cursor;
+};
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_group can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_group_sc
+{
+    size_t (* Add  ) (buffer_group_t * group, buffer_t * object, buffer_wait_event_t event); ///< @brief See ::buffer_group_add()
+    void   (* Exit ) (buffer_group_t * group); ///< @brief See ::buffer_group_exit()
+    bool   (* Init ) (buffer_group_t * group); ///< @brief See ::buffer_group_init()
+    size_t (* Next ) (buffer_group_t * group); ///< @brief See ::buffer_group_next()
+    bool   (* Rearm) (buffer_group_t * group, size_t index); ///< @brief See ::buffer_group_rearm()
+    size_t (* Wait ) (buffer_group_t * group, uint64_t deadline); ///< @brief See ::buffer_group_wait()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the group
+extern const struct buffer_group_sc buffer_group;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Adds a buffer object to the group
+//!
+//! @details The waiter is armed, if the buffer object already has data, the member is
+//! marked at once.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] group The group
+//! @param[in,out] object The buffer object, must stay valid until ::buffer_group_exit()
+//! @param event ::BUFFER_WAIT_DATA or ::BUFFER_WAIT_LINE
+//! @return Returns the index of the member, ::BUFFER_GROUP_NONE if the group is full or a
+//! parameter is invalid
+size_t buffer_group_add(buffer_group_t * group, buffer_t * object, buffer_wait_event_t event);
+
+//! @brief Disarms the waiters of all members
+//!
+//! @details The waiter of a member may still be running, the buffer objects should be
+//! stopped before the group is released.
+//!
+//! @param[in,out] group The group
+void buffer_group_exit(buffer_group_t * group);
+
+//! @brief Initializes an empty group
+//!
+//! @param[out] group The group
+//! @return Returns whether the group was initialized
+bool buffer_group_init(buffer_group_t * group);
+
+//! @brief Returns a ready member and clears its bit
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] group The group
+//! @return Returns the index of the member, ::BUFFER_GROUP_NONE if no member is ready
+size_t buffer_group_next(buffer_group_t * group);
+
+//! @brief Arms the waiter of a member returned by ::buffer_group_next() again
+//!
+//! @details If the buffer object still has data, the member is marked at once.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] group The group
+//! @param index The index of the member
+//! @return Returns whether the waiter was armed or the member was marked
+//! @retval false The buffer object is stopped or a parameter is invalid
+bool buffer_group_rearm(buffer_group_t * group, size_t index);
+
+//! @brief Returns a ready member, waits until the deadline if no member is ready
+//!
+//! @details See ::buffer_group_next().
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] group The group
+//! @param deadline Deadline, see ::buffer_until_now()
+//! @return Returns the index of the member, ::BUFFER_GROUP_NONE if the deadline has passed
+size_t buffer_group_wait(buffer_group_t * group, uint64_t deadline);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_GROUP_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_GROUP_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_GROUP_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
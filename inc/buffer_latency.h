@@ -0,0 +1,259 @@
+//! @file
+//! @brief The buffer latency header file.
+//!
+//! @details Measures how long a line stays in a buffer object, from the moment the
+//! producer publishes the End-Of-Line character until the consumer reads it.
+//! The module is activated with the ::BUFFER_ENABLE_LATENCY define.
+//! For more information see: @ref buffer_enable_latency
+
+
+#ifndef INC_BUFFER_LATENCY_H_
+#define INC_BUFFER_LATENCY_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_LATENCY_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_enable_latency Optional producer-to-consumer latency
+//!
+//! @details The latency measurement is activated by setting the ::BUFFER_ENABLE_LATENCY
+//! define, a ::buffer_latency_t object is then attached with ::buffer_latency_attach().
+//!
+//! - The define must be set for all files, otherwise not enough space is reserved during
+//!   use and problems occur when calling.
+//! - The producer stores a time stamp for each End-Of-Line character it publishes,
+//!   in ::buffer_set(), ::buffer_set_possible_or_skip() and all functions based on them.
+//!   These are two stores in a lock-free side ring of ::BUFFER_LATENCY_STAMPS entries.
+//! - The consumer matches the stamp when it reads the End-Of-Line character and records
+//!   the difference in a log-bucketed histogram ::buffer_histogram_t.
+//! - If more lines are waiting than the side ring can hold, the stamps of the further
+//!   lines are not stored and counted in ::buffer_latency_s::dropped.
+//! - The time base is ::buffer_latency_now(), nanoseconds of a monotonic clock or,
+//!   with ::BUFFER_LATENCY_USE_TSC on x86, ticks of the time stamp counter.
+//!
+//! @{
+
+#ifndef BUFFER_LATENCY_STAMPS
+
+  //! @brief Number of entries in the side ring, must be a power of two
+  #define BUFFER_LATENCY_STAMPS 64
+
+#endif
+
+//! @brief Number of sub buckets per power of two, as bits
+#define BUFFER_HISTOGRAM_SUB_BITS 3
+
+//! @brief Number of sub buckets per power of two
+#define BUFFER_HISTOGRAM_SUB_BUCKETS (1u << BUFFER_HISTOGRAM_SUB_BITS)
+
+//! @brief Number of buckets, covers the whole range of `uint64_t`
+#define BUFFER_HISTOGRAM_BUCKETS ((64u - BUFFER_HISTOGRAM_SUB_BITS + 1u) * BUFFER_HISTOGRAM_SUB_BUCKETS)
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Log-bucketed histogram (HDR-style)
+//!
+//! @details Values below ::BUFFER_HISTOGRAM_SUB_BUCKETS have their own bucket, every
+//! further power of two is divided into ::BUFFER_HISTOGRAM_SUB_BUCKETS buckets.
+//! The relative error of a recorded value is therefore less than 12.5 %.
+//! - Only one thread records values, any thread can read or merge.
+typedef struct buffer_histogram_s
+{
+    volatile _Atomic(size_t) counts[BUFFER_HISTOGRAM_BUCKETS]; ///< Number of values per bucket
+    volatile _Atomic(size_t) total; ///< Number of recorded values
+    volatile _Atomic(size_t) max;   ///< Largest recorded value
+}buffer_histogram_t;
+
+//! @brief Entry of the side ring
+typedef struct buffer_latency_stamp_s
+{
+    volatile _Atomic(size_t) sequence; ///< Line number plus one, 0 if unused
+    volatile _Atomic(size_t) time;     ///< Time stamp, see ::buffer_latency_now()
+}buffer_latency_stamp_t;
+
+//! @brief Latency measurement of a buffer object, see: \ref buffer_enable_latency
+typedef struct buffer_latency_s
+{
+    //! @brief Side ring with the time stamps of the published lines
+    buffer_latency_stamp_t stamps[BUFFER_LATENCY_STAMPS];
+
+    //! @brief Number of published lines, only used by the producer/set thread
+    size_t published;
+
+    //! @brief Number of consumed lines, written by the consumer/get thread
+    volatile _Atomic(size_t) consumed;
+
+    //! @brief Number of lines without time stamp, written by the producer/set thread
+    volatile _Atomic(size_t) dropped;
+
+    //! @brief Histogram of the latencies, written by the consumer/get thread
+    buffer_histogram_t histogram;
+}buffer_latency_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_latency can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_latency_sc
+{
+    bool     (* Attach    ) (buffer_t * object, buffer_latency_t * latency); ///< @brief See ::buffer_latency_attach()
+    void     (* Clear     ) (buffer_histogram_t * histogram); ///< @brief See ::buffer_histogram_clear()
+    size_t   (* Count     ) (const buffer_histogram_t * histogram); ///< @brief See ::buffer_histogram_count()
+    void     (* Merge     ) (buffer_histogram_t * dest, const buffer_histogram_t * src); ///< @brief See ::buffer_histogram_merge()
+    uint64_t (* Now       ) (void); ///< @brief See ::buffer_latency_now()
+    uint64_t (* Percentile) (const buffer_histogram_t * histogram, double percentile); ///< @brief See ::buffer_histogram_percentile()
+    void     (* Record    ) (buffer_histogram_t * histogram, uint64_t value); ///< @brief See ::buffer_histogram_record()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the latency measurement
+extern const struct buffer_latency_sc buffer_latency;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Clears all values of the histogram
+//!
+//! @details Must not be used while values are recorded.
+//!
+//! @param[in,out] histogram The histogram
+void buffer_histogram_clear(buffer_histogram_t * histogram);
+
+//! @brief Returns the number of recorded values
+//!
+//! @details Can be used in any thread.
+//!
+//! @param[in] histogram The histogram
+//! @return Number of recorded values
+size_t buffer_histogram_count(const buffer_histogram_t * histogram);
+
+//! @brief Adds all values of a histogram to another histogram
+//!
+//! @details Can be used in any thread, @p src may be recorded at the same time.
+//! The values of @p dest are updated with atomic additions, several threads can
+//! therefore merge into the same @p dest. @p dest must not be used to record values.
+//!
+//! @param[in,out] dest The histogram that receives the values
+//! @param[in] src The histogram whose values are added
+void buffer_histogram_merge(buffer_histogram_t * dest, const buffer_histogram_t * src);
+
+//! @brief Returns the value below which the given percentage of values lies
+//!
+//! @details Returns the upper limit of the bucket that contains the percentile.
+//! Can be used in any thread.
+//!
+//! @param[in] histogram The histogram
+//! @param percentile The percentile from 0.0 to 100.0
+//! @return The value, 0 if the histogram is empty
+uint64_t buffer_histogram_percentile(const buffer_histogram_t * histogram, double percentile);
+
+//! @brief Records a value
+//!
+//! @details Only one thread may record values in the same histogram.
+//!
+//! @param[in,out] histogram The histogram
+//! @param value The value, e.g. a latency
+void buffer_histogram_record(buffer_histogram_t * histogram, uint64_t value);
+
+//! @brief Attaches the latency measurement to the buffer
+//!
+//! @details Clears the side ring and the counters, the histogram is kept.
+//! `NULL` detaches the latency measurement.
+//!
+//! @attention Must not be used if one of the threads is used. Stop the buffer with
+//! ::buffer_stop_force() or ::buffer_stop_try() and check the return value.
+//!
+//! @param[in,out] object The buffer object
+//! @param[in,out] latency The latency measurement, `NULL` is allowed
+//! @return Returns whether the latency measurement could be attached
+//! @retval true  Attached or detached
+//! @retval false @p object was `NULL`
+bool buffer_latency_attach(buffer_t * object, buffer_latency_t * latency);
+
+//! @brief Returns the current time stamp
+//!
+//! @details Nanoseconds of a monotonic clock. If ::BUFFER_LATENCY_USE_TSC is set
+//! on x86, the ticks of the time stamp counter are returned instead.
+//!
+//! @return The time stamp
+uint64_t buffer_latency_now(void);
+
+//! @brief Stores the time stamp of a published line
+//!
+//! @details Called by the buffer functions in the producer/set thread before the
+//! End-Of-Line character is published.
+//!
+//! @param[in,out] latency The latency measurement
+void buffer_latency_publish(buffer_latency_t * latency);
+
+//! @brief Records the latency of a consumed line
+//!
+//! @details Called by the buffer functions in the consumer/get thread after the
+//! End-Of-Line character was read.
+//!
+//! @param[in,out] latency The latency measurement
+void buffer_latency_consume(buffer_latency_t * latency);
+
+//! @brief Skips the time stamps of lines that were removed without being read
+//!
+//! @details Called by ::buffer_clear().
+//!
+//! @param[in,out] latency The latency measurement
+//! @param lines Number of removed lines
+void buffer_latency_discard(buffer_latency_t * latency, size_t lines);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_LATENCY_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_LATENCY_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_LATENCY_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
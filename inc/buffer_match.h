@@ -0,0 +1,160 @@
+//! @file
+//! @brief The buffer pattern matcher header file.
+//!
+//! @details Waits for the first of several patterns, e.g. the responses of a modem.
+//! For more information see: @ref buffer_match
+
+
+#ifndef INC_BUFFER_MATCH_H_
+#define INC_BUFFER_MATCH_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_match Multi-pattern read
+//!
+//! @details ::buffer_read_to() searches a single pattern and starts again at the first unread
+//! character with every call. ::buffer_match_init() compiles up to ::BUFFER_MATCH_PATTERNS
+//! patterns into an Aho-Corasick automaton and attaches it to a buffer, ::buffer_match_read_to()
+//! feeds only the characters that arrived since the last call into it.
+//!
+//! - Each character costs one table lookup, independent of the number of patterns.
+//! - The pattern that ends first is reported; if several end at the same character the longest.
+//! - The state is kept between the calls and is restarted if characters were removed by
+//!   another read function, see ::buffer_s::removed. After ::buffer_reset() the automaton
+//!   must be restarted with ::buffer_match_reset().
+//! - The automaton has at most ::BUFFER_MATCH_STATES states, the root and one state per
+//!   distinct prefix of the patterns.
+//!
+//! @{
+
+#ifndef BUFFER_MATCH_PATTERNS
+
+  //! @brief Maximum number of patterns
+  #define BUFFER_MATCH_PATTERNS 8
+
+#endif
+
+#ifndef BUFFER_MATCH_STATES
+
+  //! @brief Maximum number of states, at most 256
+  #define BUFFER_MATCH_STATES 64
+
+#endif
+
+//! @}
+
+#if (BUFFER_MATCH_STATES < 2) || (BUFFER_MATCH_STATES > 256)
+  #error "BUFFER_MATCH_STATES must be within 2 and 256"
+#endif
+
+#if (BUFFER_MATCH_PATTERNS < 1) || (BUFFER_MATCH_PATTERNS > 255)
+  #error "BUFFER_MATCH_PATTERNS must be within 1 and 255"
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Compiled patterns and the scan state, see: \ref buffer_match
+typedef struct buffer_match_s
+{
+    unsigned char next[BUFFER_MATCH_STATES][256]; ///< Next state of each state and character
+    unsigned char output[BUFFER_MATCH_STATES];    ///< Pattern + 1 that ends in the state, 0 for none
+    size_t lengths[BUFFER_MATCH_PATTERNS];        ///< Length of each pattern
+    size_t patterns;                              ///< Number of patterns
+    size_t states;                                ///< Number of states
+    buffer_t * object;                            ///< The attached buffer
+    uint64_t removed;                             ///< ::buffer_s::removed at the last scan
+    size_t scanned;                               ///< Characters after @ref consumer already fed to the automaton
+    unsigned char state;                          ///< Automaton state after @ref scanned characters
+}buffer_match_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_match can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_match_sc
+{
+    bool (* Init  ) (buffer_match_t * matcher, buffer_t * object, const char * const * patterns, size_t n); ///< @brief See ::buffer_match_init()
+    bool (* ReadTo) (buffer_match_t * matcher, char * dest, size_t n, size_t * pattern, size_t * length); ///< @brief See ::buffer_match_read_to()
+    bool (* Reset ) (buffer_match_t * matcher); ///< @brief See ::buffer_match_reset()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the pattern matcher
+extern const struct buffer_match_sc buffer_match;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Compiles the patterns and attaches the matcher to a buffer
+//!
+//! @details The patterns are '\\0' terminated and not empty, they are not referenced
+//! after the call. See: \ref buffer_match
+//!
+//! @param[out] matcher The matcher
+//! @param[in] object The buffer object
+//! @param[in] patterns The patterns
+//! @param n Number of patterns
+//! @return Returns whether the patterns fit into ::BUFFER_MATCH_PATTERNS and ::BUFFER_MATCH_STATES
+bool buffer_match_init(buffer_match_t * matcher, buffer_t * object, const char * const * patterns, size_t n);
+
+//! @brief Reads until the first of the patterns
+//!
+//! @details Feeds the characters that arrived since the last call into the automaton.
+//! If a pattern is found, the characters in front of it are copied into @p dest, like
+//! ::buffer_read_to() they are truncated to `n - 1` characters, and all characters up to
+//! and including the pattern are removed. Otherwise nothing is removed.
+//! See: \ref buffer_match
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] matcher The matcher
+//! @param[out] dest The characters in front of the pattern, terminated with '\\0', `NULL` is allowed
+//! @param n The length of @p dest
+//! @param[out] pattern Index of the pattern found, `NULL` is allowed
+//! @param[out] length Number of characters in front of the pattern, `NULL` is allowed
+//! @return Returns whether a pattern was found
+bool buffer_match_read_to(buffer_match_t * matcher, char * dest, size_t n, size_t * pattern, size_t * length);
+
+//! @brief Restarts the automaton at the first unread character
+//!
+//! @details Needed after ::buffer_reset() of the buffer, other read functions are detected
+//! with ::buffer_s::removed.
+//!
+//! @param[in,out] matcher The matcher
+//! @return Returns whether the matcher was restarted
+bool buffer_match_reset(buffer_match_t * matcher);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUFFER_MATCH_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,282 @@
+//! @file
+//! @brief The file-backed persistent buffer header file.
+//!
+//! @details A process-shared ring in a memory-mapped file whose unread data survives a
+//! restart. For more information see: @ref buffer_mmap
+
+
+#ifndef INC_BUFFER_MMAP_H_
+#define INC_BUFFER_MMAP_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_shm.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_MMAP_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_mmap File-backed persistent buffer
+//!
+//! @details A ::buffer_mmap_t spools data through a file that is mapped with `mmap()`.
+//! The first page of the file is a ::buffer_mmap_header_t with the durable cursors, the
+//! rest is a ::buffer_shm_t, see \ref buffer_shm.
+//!
+//! - The producer writes into the ring, ::buffer_mmap_commit() makes the data durable and
+//!   then stores the producer cursor in the header. The cursor is therefore never ahead of
+//!   the data on the disk.
+//! - The consumer reads behind the cursor of the ring, ::buffer_mmap_acknowledge() stores its
+//!   position in the header and only then returns the space to the producer. Data that
+//!   was read but not acknowledged is read again after a restart.
+//! - ::buffer_mmap_open() of an existing file restores the ring from the durable cursors.
+//!   Only the pages between the cursors are touched.
+//! - The durability is chosen with ::buffer_mmap_sync_t. With ::BUFFER_MMAP_SYNC_GROUP the
+//!   `msync()` calls are batched, a larger group trades latency of the durability for
+//!   fewer system calls.
+//! - Without `msync()` all data survives a crash of the process, because the pages belong
+//!   to the file. Only a crash of the system can lose it.
+//! - There is exactly one producer thread and one consumer thread.
+//!
+//! @{
+
+//! @brief Marks an initialized ::buffer_mmap_header_s
+#define BUFFER_MMAP_MAGIC UINT32_C(0x424d4d31)
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief When the cursors and the data are written to the disk, see: \ref buffer_mmap
+typedef enum buffer_mmap_sync_e
+{
+    BUFFER_MMAP_SYNC_NONE,   ///< Cursors on every call, no `msync()`, survives a crash of the process
+    BUFFER_MMAP_SYNC_ALWAYS, ///< `msync()` on every write and read, nothing is lost
+    BUFFER_MMAP_SYNC_GROUP,  ///< `msync()` after ::buffer_mmap_s::group_bytes or ::buffer_mmap_s::group_ns
+}buffer_mmap_sync_t;
+
+//! @brief First page of the file, see: \ref buffer_mmap
+typedef struct buffer_mmap_header_s
+{
+    //! @brief ::BUFFER_MMAP_MAGIC
+    uint32_t magic;
+
+    //! @brief Reserved, 0
+    uint32_t reserved;
+
+    //! @brief Offset of the ::buffer_shm_t from the start of the file, the size of a page
+    uint64_t shm_offset;
+
+    //! @brief Producer cursor whose data is durable, only written by the producer
+    volatile _Atomic(uint64_t) producer_offset;
+
+    //! @brief To separate the cursor of the producer
+    char padding[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Acknowledged consumer cursor, only written by the consumer
+    volatile _Atomic(uint64_t) consumer_offset;
+}buffer_mmap_header_t;
+
+//! @brief File-backed persistent buffer, see: \ref buffer_mmap
+typedef struct buffer_mmap_s
+{
+    //! @brief The header at the start of the mapping
+    buffer_mmap_header_t * header;
+
+    //! @brief The ring behind the header
+    buffer_shm_t * shm;
+
+    //! @brief The mapping
+    char * map;
+
+    //! @brief Number of bytes of the mapping and the file
+    size_t size;
+
+    //! @brief File descriptor of the file
+    int fd;
+
+    //! @brief Durability
+    buffer_mmap_sync_t sync;
+
+    //! @brief ::BUFFER_MMAP_SYNC_GROUP, number of bytes after which a side synchronizes
+    size_t group_bytes;
+
+    //! @brief ::BUFFER_MMAP_SYNC_GROUP, nanoseconds after which a side synchronizes, 0 for none
+    uint64_t group_ns;
+
+    //! @brief Number of unread bytes found by ::buffer_mmap_open()
+    size_t recovered;
+
+    //! @brief To separate the state of the producer
+    char padding_producer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Producer cursor of the last ::buffer_mmap_commit()
+    uint64_t producer_synced;
+
+    //! @brief Time of the last ::buffer_mmap_commit()
+    uint64_t producer_time;
+
+    //! @brief To separate the state of the consumer
+    char padding_consumer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Position of the next byte to read, ahead of the acknowledged cursor
+    uint64_t consumer_offset;
+
+    //! @brief Time of the last ::buffer_mmap_acknowledge()
+    uint64_t consumer_time;
+
+    //! @brief To separate the state of the consumer from the following data
+    char padding_back[BUFFER_CACHE_LINE_SIZE];
+}buffer_mmap_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_mmap can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_mmap_sc
+{
+    bool   (* Acknowledge) (buffer_mmap_t * object); ///< @brief See ::buffer_mmap_acknowledge()
+    bool   (* Close      ) (buffer_mmap_t * object); ///< @brief See ::buffer_mmap_close()
+    bool   (* Commit     ) (buffer_mmap_t * object); ///< @brief See ::buffer_mmap_commit()
+    size_t (* Length     ) (const buffer_mmap_t * object); ///< @brief See ::buffer_mmap_length()
+    bool   (* Open       ) (buffer_mmap_t * object, const char * path, size_t size, buffer_mmap_sync_t sync, size_t group_bytes, uint64_t group_ns); ///< @brief See ::buffer_mmap_open()
+    size_t (* Read       ) (buffer_mmap_t * object, char * dest, size_t n); ///< @brief See ::buffer_mmap_read()
+    size_t (* Write      ) (buffer_mmap_t * object, const char * src, size_t n); ///< @brief See ::buffer_mmap_write()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the file-backed buffer
+extern const struct buffer_mmap_sc buffer_mmap;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Stores the consumer cursor in the header and returns the read space to the producer
+//!
+//! @details Called by ::buffer_mmap_read() according to ::buffer_mmap_s::sync.
+//!
+//! Can be use in:
+//! - consumer thread.
+//!
+//! @param[in,out] object The buffer
+//! @return Returns whether the cursor is stored, `false` if `msync()` failed
+bool buffer_mmap_acknowledge(buffer_mmap_t * object);
+
+//! @brief Commits and acknowledges, unmaps and closes the file
+//!
+//! @attention Must not be used if one of the threads is used.
+//!
+//! @param[in,out] object The buffer
+//! @return Returns whether all data was stored
+bool buffer_mmap_close(buffer_mmap_t * object);
+
+//! @brief Makes the written data durable and stores the producer cursor in the header
+//!
+//! @details Called by ::buffer_mmap_write() according to ::buffer_mmap_s::sync.
+//!
+//! Can be use in:
+//! - producer thread.
+//!
+//! @param[in,out] object The buffer
+//! @return Returns whether the cursor is stored, `false` if `msync()` failed
+bool buffer_mmap_commit(buffer_mmap_t * object);
+
+//! @brief Returns the number of unread bytes
+//!
+//! @param[in] object The buffer
+//! @return Number of bytes
+size_t buffer_mmap_length(const buffer_mmap_t * object);
+
+//! @brief Opens or creates the file and maps it
+//!
+//! @details A new file is created with @p size bytes. An existing file keeps its size and
+//! its unread data, see ::buffer_mmap_s::recovered. A file with an invalid header or with
+//! invalid cursors is not changed, `errno` is set to `EBADMSG`; it has to be removed before
+//! a new buffer can be created in its place.
+//!
+//! @param[out] object The buffer
+//! @param path The file
+//! @param size Number of bytes of a new file, the header needs one page
+//! @param sync Durability
+//! @param group_bytes See ::buffer_mmap_s::group_bytes
+//! @param group_ns See ::buffer_mmap_s::group_ns
+//! @return Returns whether the file is mapped, `errno` is set otherwise
+bool buffer_mmap_open(buffer_mmap_t * object, const char * path, size_t size, buffer_mmap_sync_t sync, size_t group_bytes, uint64_t group_ns);
+
+//! @brief Reads up to @p n bytes
+//!
+//! @details Does not block, no string terminating character is written. The bytes are
+//! acknowledged according to ::buffer_mmap_s::sync, with ::BUFFER_MMAP_SYNC_GROUP also when
+//! the buffer was read empty, so that the producer gets the space back.
+//!
+//! Can be use in:
+//! - consumer thread.
+//!
+//! @param[in,out] object The buffer
+//! @param[out] dest The bytes are written in this buffer
+//! @param n The length of @p dest
+//! @return Returns the number of bytes read
+size_t buffer_mmap_read(buffer_mmap_t * object, char * dest, size_t n);
+
+//! @brief Writes up to @p n bytes
+//!
+//! @details Does not block, the bytes that do not fit are skipped. The bytes are committed
+//! according to ::buffer_mmap_s::sync.
+//!
+//! Can be use in:
+//! - producer thread.
+//!
+//! @param[in,out] object The buffer
+//! @param[in] src The bytes
+//! @param n The number of bytes
+//! @return Returns the number of bytes written
+size_t buffer_mmap_write(buffer_mmap_t * object, const char * src, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_MMAP_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_MMAP_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_MMAP_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
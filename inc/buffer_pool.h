@@ -0,0 +1,214 @@
+//! @file
+//! @brief The buffer consumer pool header file.
+//!
+//! @details Worker threads with work-stealing deques that drain many buffer objects.
+//! For more information see: @ref buffer_pool
+
+
+#ifndef INC_BUFFER_POOL_H_
+#define INC_BUFFER_POOL_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <threads.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_POOL_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_pool Work-stealing consumer pool
+//!
+//! @details A ::buffer_pool_t drains many buffer objects, called channels, with a few worker
+//! threads. Each worker thread owns a deque of ready channels. An idle worker thread steals
+//! channels from the other deques, so that all worker threads stay busy even if a few
+//! channels carry most of the load.
+//!
+//! - The producer/set thread wakes the channel with a waiter, see \ref buffer_waiter, and
+//!   puts it into a lock-free injection list. A worker thread moves the list into its deque.
+//! - The deques follow Chase and Lev, the owner takes from the bottom without a compare and
+//!   swap in the common case, the other worker threads steal from the top.
+//! - A channel is claimed with one atomic exchange before it is queued and released after
+//!   its handler has run. At most one worker thread is the consumer/get thread of a buffer
+//!   object at a time.
+//! - The handler should read all available characters, a channel with remaining characters
+//!   is queued behind the other channels again.
+//! - Worker threads without work sleep, a mutex is only taken to wake them.
+//!
+//! @{
+
+#ifndef BUFFER_POOL_THREADS
+
+  //! @brief Maximum number of worker threads of a pool
+  #define BUFFER_POOL_THREADS 8
+
+#endif
+
+#ifndef BUFFER_POOL_DEQUE
+
+  //! @brief Number of entries of the deque of a worker thread, must be a power of two
+  #define BUFFER_POOL_DEQUE 256
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+typedef struct buffer_pool_s buffer_pool_t;
+
+typedef struct buffer_pool_channel_s buffer_pool_channel_t;
+
+//! @brief Handler of a channel, called in a worker thread
+//!
+//! @param[in,out] channel The channel, see ::buffer_pool_channel_s::object
+typedef void (*buffer_pool_handler_t)(buffer_pool_channel_t * channel);
+
+//! @brief Buffer object that is drained by the pool, see: \ref buffer_pool
+struct buffer_pool_channel_s
+{
+    buffer_waiter_t waiter;          ///< Armed for ::buffer_pool_channel_s::event
+    buffer_pool_channel_t * next;    ///< Next channel in the injection list
+    buffer_pool_t * pool;            ///< The pool
+    buffer_t * object;               ///< The buffer object
+    buffer_pool_handler_t handler;   ///< The handler
+    void * context;                  ///< Freely usable by the handler
+    buffer_wait_event_t event;       ///< ::BUFFER_WAIT_DATA or ::BUFFER_WAIT_LINE
+    volatile _Atomic(bool) claimed;  ///< The channel is queued or its handler is running
+    volatile _Atomic(bool) attached; ///< `false` after ::buffer_pool_detach()
+};
+
+//! @brief Deque of ready channels, see: \ref buffer_pool
+typedef struct buffer_pool_deque_s
+{
+    volatile _Atomic(int64_t) top;    ///< Next entry to steal
+    volatile _Atomic(int64_t) bottom; ///< Next free entry, only written by the owner
+    volatile _Atomic(buffer_pool_channel_t *) entries[BUFFER_POOL_DEQUE]; ///< Ring of the entries
+}buffer_pool_deque_t;
+
+//! @brief Worker thread of the pool
+typedef struct buffer_pool_worker_s
+{
+    buffer_pool_deque_t deque;        ///< Ready channels of this worker thread
+    buffer_pool_t * pool;             ///< The pool
+    size_t index;                     ///< Position in ::buffer_pool_s::workers
+    volatile _Atomic(uint64_t) runs;   ///< Number of handler calls
+    volatile _Atomic(uint64_t) steals; ///< Number of channels taken from other worker threads
+}buffer_pool_worker_t;
+
+//! @brief Work-stealing consumer pool, see: \ref buffer_pool
+struct buffer_pool_s
+{
+    volatile _Atomic(buffer_pool_channel_t *) inject; ///< Channels woken by the producer/set threads
+    volatile _Atomic(size_t) sleeping;                ///< Number of worker threads waiting for a channel
+    volatile _Atomic(bool) stop;                      ///< The worker threads are ended
+    mtx_t mutex;                                      ///< Protects the sleep
+    cnd_t condition;                                  ///< Wakes a sleeping worker thread
+    buffer_pool_worker_t workers[BUFFER_POOL_THREADS]; ///< State of the worker threads
+    thrd_t threads[BUFFER_POOL_THREADS];              ///< The worker threads
+    size_t count;                                     ///< Number of worker threads
+};
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_pool can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_pool_sc
+{
+    bool (* Attach) (buffer_pool_t * pool, buffer_pool_channel_t * channel, buffer_t * object, buffer_wait_event_t event, buffer_pool_handler_t handler, void * context); ///< @brief See ::buffer_pool_attach()
+    bool (* Detach) (buffer_pool_channel_t * channel); ///< @brief See ::buffer_pool_detach()
+    void (* Exit  ) (buffer_pool_t * pool); ///< @brief See ::buffer_pool_exit()
+    bool (* Init  ) (buffer_pool_t * pool, size_t threads); ///< @brief See ::buffer_pool_init()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the consumer pool
+extern const struct buffer_pool_sc buffer_pool;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Drains the buffer object with the pool
+//!
+//! @details Characters that are already in the buffer are passed to the handler immediately.
+//!
+//! @param[in,out] pool The pool
+//! @param[out] channel Memory for the channel, must stay valid until the pool is ended
+//! @param[in,out] object The buffer object
+//! @param event ::BUFFER_WAIT_DATA or ::BUFFER_WAIT_LINE
+//! @param handler The handler, should read all available characters
+//! @param context Freely usable by the handler
+//! @return Returns whether the channel was attached
+bool buffer_pool_attach(buffer_pool_t * pool, buffer_pool_channel_t * channel, buffer_t * object, buffer_wait_event_t event, buffer_pool_handler_t handler, void * context);
+
+//! @brief Ends the connection of ::buffer_pool_attach()
+//!
+//! @details A handler that is already queued or running is still finished.
+//!
+//! @param[in,out] channel The channel
+//! @return Returns whether the channel was idle, i.e. no handler is queued or running
+bool buffer_pool_detach(buffer_pool_channel_t * channel);
+
+//! @brief Ends the worker threads
+//!
+//! @details Waits until the running handlers are finished, queued channels are not run.
+//!
+//! @param[in,out] pool The pool
+void buffer_pool_exit(buffer_pool_t * pool);
+
+//! @brief Initializes the pool and starts the worker threads
+//!
+//! @param[out] pool The pool
+//! @param threads Number of worker threads, at most ::BUFFER_POOL_THREADS
+//! @return Returns whether all worker threads were started
+bool buffer_pool_init(buffer_pool_t * pool, size_t threads);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_POOL_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_POOL_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_POOL_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,232 @@
+//! @file
+//! @brief The sharded buffer header file.
+//!
+//! @details One buffer per producer thread, drained by a single consumer in a merged order.
+//! For more information see: @ref buffer_shard
+
+
+#ifndef INC_BUFFER_SHARD_H_
+#define INC_BUFFER_SHARD_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_shard Sharded buffer
+//!
+//! @details A ::buffer_t has exactly one producer/set thread. A ::buffer_shard_t has one
+//! buffer per producer, called shard, e.g. one per core for logging. A single consumer/get
+//! thread drains all shards with ::buffer_shard_drain().
+//!
+//! - Each shard is a separate buffer on its own cache lines, the producers never share a
+//!   position or a counter. The producer of a shard must not change, e.g. a thread that is
+//!   pinned to a core writes to the shard of that core.
+//! - The entries are records, see \ref buffer_record, with a timestamp in front of the payload.
+//!   ::buffer_shard_push() takes the timestamp of ::buffer_until_now().
+//! - The records of a shard are read in place from ::buffer_read_span() and released together
+//!   with ::buffer_pop_records(), so that the consumer touches the counters of a shard once per
+//!   drain. Records published during ::buffer_shard_drain() are read by the next call.
+//! - ::BUFFER_SHARD_ROUND_ROBIN reads up to ::BUFFER_SHARD_BATCH records of one shard before
+//!   the next shard.
+//! - ::BUFFER_SHARD_TIMESTAMP merges the shards by timestamp. Each shard is in order, the
+//!   merge only compares the first record of each shard. A record that is published after
+//!   a later one of another shard was read is passed out of order.
+//! - The lifecycle is that of the shard buffers, ::buffer_shard_stop_force() stops all of them.
+//!
+//! @{
+
+#ifndef BUFFER_SHARD_COUNT
+
+  //! @brief Maximum number of shards
+  #define BUFFER_SHARD_COUNT 8
+
+#endif
+
+#ifndef BUFFER_SHARD_RECORD
+
+  //! @brief Maximum number of bytes of the payload of a record
+  #define BUFFER_SHARD_RECORD 256
+
+#endif
+
+#ifndef BUFFER_SHARD_BATCH
+
+  //! @brief Number of records read from one shard before the next, see ::BUFFER_SHARD_ROUND_ROBIN
+  #define BUFFER_SHARD_BATCH 64
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Order in which ::buffer_shard_drain() reads the shards
+typedef enum buffer_shard_order_e
+{
+    BUFFER_SHARD_ROUND_ROBIN, ///< Batches of ::BUFFER_SHARD_BATCH records per shard
+    BUFFER_SHARD_TIMESTAMP,   ///< The record with the oldest timestamp first
+}buffer_shard_order_t;
+
+//! @brief Handler of ::buffer_shard_drain(), called for each record
+//!
+//! @param context See ::buffer_shard_drain()
+//! @param index The shard of the record
+//! @param timestamp The timestamp of the record
+//! @param[in] record The payload, only valid during the call
+//! @param n The number of bytes of the payload
+typedef void (*buffer_shard_handler_t)(void * context, size_t index, uint64_t timestamp, const void * record, size_t n);
+
+//! @brief Buffer of one producer, see: \ref buffer_shard
+typedef struct buffer_shard_lane_s
+{
+    //! @brief The buffer of the shard
+    buffer_t buffer;
+
+    //! @brief To separate the buffer from the next shard
+    char padding[BUFFER_CACHE_LINE_SIZE];
+}buffer_shard_lane_t;
+
+//! @brief Sharded buffer, see: \ref buffer_shard
+typedef struct buffer_shard_s
+{
+    //! @brief The shards
+    buffer_shard_lane_t lanes[BUFFER_SHARD_COUNT];
+
+    //! @brief Number of shards
+    size_t count;
+
+    //! @brief Shard that is read next with ::BUFFER_SHARD_ROUND_ROBIN, only used by the consumer/get thread
+    size_t cursor;
+
+    //! @brief Order of ::buffer_shard_drain()
+    buffer_shard_order_t order;
+}buffer_shard_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_shard can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_shard_sc
+{
+    size_t (* Drain    ) (buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max); ///< @brief See ::buffer_shard_drain()
+    bool   (* Init     ) (buffer_shard_t * object, char * data, size_t sizeof_data, size_t count, buffer_shard_order_t order, bool start); ///< @brief See ::buffer_shard_init()
+    size_t (* Length   ) (const buffer_shard_t * object); ///< @brief See ::buffer_shard_length()
+    bool   (* Push     ) (buffer_shard_t * object, size_t index, const void * src, size_t n); ///< @brief See ::buffer_shard_push()
+    bool   (* PushAt   ) (buffer_shard_t * object, size_t index, uint64_t timestamp, const void * src, size_t n); ///< @brief See ::buffer_shard_push_at()
+    bool   (* StopForce) (buffer_shard_t * object); ///< @brief See ::buffer_shard_stop_force()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the sharded buffer
+extern const struct buffer_shard_sc buffer_shard;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Reads up to @p max records of all shards
+//!
+//! @details Does not block, the order is ::buffer_shard_s::order.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The sharded buffer
+//! @param handler Called for each record
+//! @param context Passed to @p handler
+//! @param max Maximum number of records
+//! @return Returns the number of records read
+size_t buffer_shard_drain(buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max);
+
+//! @brief Initializes the sharded buffer
+//!
+//! @details @p data is divided into @p count parts of the same size, one per shard.
+//!
+//! @attention Must not be used if one of the threads is used.
+//!
+//! @param[out] object The sharded buffer
+//! @param data The array in which the shards are stored
+//! @param sizeof_data Length of the array
+//! @param count Number of shards, at most ::BUFFER_SHARD_COUNT
+//! @param order Order of ::buffer_shard_drain()
+//! @param start Starting or stopping the shards
+//! @return Returns whether the sharded buffer was initialized
+//! @retval false A parameter is invalid or a shard has no space for a record header
+bool buffer_shard_init(buffer_shard_t * object, char * data, size_t sizeof_data, size_t count, buffer_shard_order_t order, bool start);
+
+//! @brief Returns the number of bytes in all shards, including the record headers
+//!
+//! @details The shards are read one by one.
+//!
+//! @param[in] object The sharded buffer
+//! @return Number of bytes
+size_t buffer_shard_length(const buffer_shard_t * object);
+
+//! @brief Writes a record with the timestamp of ::buffer_until_now()
+//!
+//! @details See ::buffer_shard_push_at().
+//!
+//! @param[in,out] object The sharded buffer
+//! @param index The shard of the producer
+//! @param[in] src The payload, `NULL` is allowed if @p n is 0
+//! @param n The number of bytes of the payload, at most ::BUFFER_SHARD_RECORD
+//! @return Returns whether the record was written
+bool buffer_shard_push(buffer_shard_t * object, size_t index, const void * src, size_t n);
+
+//! @brief Writes a record
+//!
+//! @details The record is written completely or not at all, see ::buffer_push_record().
+//! The timestamps of a shard must not decrease.
+//!
+//! Does not block, if there is not enough space the record is skipped.
+//!
+//! Can be use in:
+//! - producer/set thread of the shard @p index.
+//!
+//! @param[in,out] object The sharded buffer
+//! @param index The shard of the producer
+//! @param timestamp The timestamp, used by ::BUFFER_SHARD_TIMESTAMP
+//! @param[in] src The payload, `NULL` is allowed if @p n is 0
+//! @param n The number of bytes of the payload, at most ::BUFFER_SHARD_RECORD
+//! @return Returns whether the record was written
+bool buffer_shard_push_at(buffer_shard_t * object, size_t index, uint64_t timestamp, const void * src, size_t n);
+
+//! @brief Stops all shards, see ::buffer_stop_force()
+//!
+//! @param[in,out] object The sharded buffer
+//! @return Returns whether all shards were stopped
+bool buffer_shard_stop_force(buffer_shard_t * object);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUFFER_SHARD_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,319 @@
+//! @file
+//! @brief The process-shared buffer header file.
+//!
+//! @details A relocatable ring for shared memory that is mapped by two processes.
+//! For more information see: @ref buffer_shm
+
+
+#ifndef INC_BUFFER_SHM_H_
+#define INC_BUFFER_SHM_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+#include "buffer_until.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_SHM_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_shm Process-shared buffer
+//!
+//! @details The pointers of a ::buffer_t are only valid in the address space of one process.
+//! A ::buffer_shm_t is placed at the start of a shared memory segment, e.g. of `shm_open()`
+//! or `memfd_create()`, and contains no pointers. Each process may map the segment at a
+//! different address.
+//!
+//! - The ring follows the structure in the segment, its position is stored as
+//!   ::buffer_shm_s::data_offset from the start of the structure.
+//! - The producer and the consumer positions are offsets that only increase, the position
+//!   in the ring is the offset modulo ::buffer_shm_s::size. Each side writes only its own
+//!   position, on its own cache lines.
+//! - ::buffer_shm_write_reserve() and ::buffer_shm_read_span() return spans in the ring, so
+//!   that the processes exchange data without copies.
+//! - ::buffer_shm_wait_data() and ::buffer_shm_wait_space() sleep on a futex of the segment,
+//!   which is not private to the process, see ::buffer_shm_s::data_sequence. The other side
+//!   only makes a system call if a thread is sleeping. Without futex the thread sleeps in steps
+//!   of ::BUFFER_UNTIL_SLEEP_NS.
+//! - The deadlines use the monotonic clock of ::buffer_until_now(), which is the same in all processes.
+//! - There is exactly one producer process/thread and one consumer process/thread.
+//!
+//! @{
+
+//! @brief Marks an initialized ::buffer_shm_s, see ::buffer_shm_attach()
+#define BUFFER_SHM_MAGIC UINT32_C(0x42534d31)
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Process-shared buffer, see: \ref buffer_shm
+//!
+//! @details Only fixed-size types are used, the layout is the same in 32-bit and 64-bit processes.
+typedef struct buffer_shm_s
+{
+    //! @brief ::BUFFER_SHM_MAGIC, written last by ::buffer_shm_init()
+    volatile _Atomic(uint32_t) magic;
+
+    //! @brief 1 if the buffer is started, 0 if it is stopped
+    volatile _Atomic(uint32_t) running;
+
+    //! @brief Number of bytes of the ring
+    uint64_t size;
+
+    //! @brief Offset of the ring from the start of the structure
+    uint64_t data_offset;
+
+    //! @brief To separate the position of the producer
+    char padding_producer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Offset of the next byte to write, only written by the producer
+    volatile _Atomic(uint64_t) producer_offset;
+
+    //! @brief Futex of the consumer, increased when data is published to a sleeping consumer
+    volatile _Atomic(uint32_t) data_sequence;
+
+    //! @brief Number of sleeping consumer threads
+    volatile _Atomic(uint32_t) data_sleeping;
+
+    //! @brief To separate the position of the consumer
+    char padding_consumer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Offset of the next byte to read, only written by the consumer
+    volatile _Atomic(uint64_t) consumer_offset;
+
+    //! @brief Futex of the producer, increased when space is returned to a sleeping producer
+    volatile _Atomic(uint32_t) space_sequence;
+
+    //! @brief Number of sleeping producer threads
+    volatile _Atomic(uint32_t) space_sleeping;
+
+    //! @brief To separate the position of the consumer from the ring
+    char padding_back[BUFFER_CACHE_LINE_SIZE];
+}buffer_shm_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_shm can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_shm_sc
+{
+    buffer_shm_t *        (* Attach      ) (void * memory, size_t sizeof_memory); ///< @brief See ::buffer_shm_attach()
+    bool                  (* Init        ) (void * memory, size_t sizeof_memory, bool start); ///< @brief See ::buffer_shm_init()
+    size_t                (* Length      ) (const buffer_shm_t * object); ///< @brief See ::buffer_shm_length()
+    size_t                (* Read        ) (buffer_shm_t * object, char * dest, size_t n); ///< @brief See ::buffer_shm_read()
+    size_t                (* ReadConsume ) (buffer_shm_t * object, size_t n); ///< @brief See ::buffer_shm_read_consume()
+    size_t                (* ReadSpan    ) (buffer_shm_t * object, const char ** span); ///< @brief See ::buffer_shm_read_span()
+    size_t                (* Space       ) (const buffer_shm_t * object); ///< @brief See ::buffer_shm_space()
+    bool                  (* Start       ) (buffer_shm_t * object); ///< @brief See ::buffer_shm_start()
+    bool                  (* Stop        ) (buffer_shm_t * object); ///< @brief See ::buffer_shm_stop()
+    buffer_until_status_t (* WaitData    ) (buffer_shm_t * object, uint64_t deadline); ///< @brief See ::buffer_shm_wait_data()
+    buffer_until_status_t (* WaitSpace   ) (buffer_shm_t * object, size_t n, uint64_t deadline); ///< @brief See ::buffer_shm_wait_space()
+    size_t                (* Write       ) (buffer_shm_t * object, const char * src, size_t n); ///< @brief See ::buffer_shm_write()
+    size_t                (* WriteCommit ) (buffer_shm_t * object, size_t n); ///< @brief See ::buffer_shm_write_commit()
+    size_t                (* WriteReserve) (buffer_shm_t * object, char ** span); ///< @brief See ::buffer_shm_write_reserve()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the process-shared buffer
+extern const struct buffer_shm_sc buffer_shm;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Returns the buffer of a segment that was initialized by another process
+//!
+//! @param memory Start of the mapped segment
+//! @param sizeof_memory Number of bytes of the mapping
+//! @return Returns the buffer, `NULL` if the segment does not contain an initialized buffer
+buffer_shm_t * buffer_shm_attach(void * memory, size_t sizeof_memory);
+
+//! @brief Places a buffer at the start of a segment
+//!
+//! @details The rest of the segment behind the structure is the ring.
+//!
+//! @attention Must not be used while another process uses the segment.
+//!
+//! @param memory Start of the mapped segment, aligned to ::BUFFER_CACHE_LINE_SIZE
+//! @param sizeof_memory Number of bytes of the segment
+//! @param start Starting or stopping the buffer
+//! @return Returns whether the buffer was initialized
+//! @retval false @p memory was `NULL` or the segment has no space behind the structure
+bool buffer_shm_init(void * memory, size_t sizeof_memory, bool start);
+
+//! @brief Returns the number of readable bytes
+//!
+//! @param[in] object The buffer
+//! @return Number of bytes
+size_t buffer_shm_length(const buffer_shm_t * object);
+
+//! @brief Reads up to @p n bytes
+//!
+//! @details Does not block, no string terminating character is written. Both parts of a
+//! wrapped ring are copied.
+//!
+//! Can be use in:
+//! - consumer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param[out] dest The bytes are written in this buffer
+//! @param n The length of @p dest
+//! @return Returns the number of bytes read
+size_t buffer_shm_read(buffer_shm_t * object, char * dest, size_t n);
+
+//! @brief Removes @p n bytes after ::buffer_shm_read_span()
+//!
+//! Can be use in:
+//! - consumer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param n The number of bytes, at most the length of the span
+//! @return Returns the number of bytes removed
+size_t buffer_shm_read_consume(buffer_shm_t * object, size_t n);
+
+//! @brief Returns the contiguous readable bytes without copying
+//!
+//! @details At the end of the ring the span is shorter than ::buffer_shm_length(), the rest
+//! follows at the start of the ring with the next call. The bytes stay in the ring until
+//! ::buffer_shm_read_consume().
+//!
+//! Can be use in:
+//! - consumer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param[out] span Start of the readable bytes in the ring, `NULL` if nothing is readable
+//! @return Returns the number of bytes of the span
+size_t buffer_shm_read_span(buffer_shm_t * object, const char ** span);
+
+//! @brief Returns the number of free bytes
+//!
+//! @param[in] object The buffer
+//! @return Number of bytes
+size_t buffer_shm_space(const buffer_shm_t * object);
+
+//! @brief Starts the buffer
+//!
+//! @param[in,out] object The buffer
+//! @return Returns whether the buffer was started
+bool buffer_shm_start(buffer_shm_t * object);
+
+//! @brief Stops the buffer and wakes all sleeping threads of both processes
+//!
+//! @details Functions that are already running are still finished.
+//!
+//! @param[in,out] object The buffer
+//! @return Returns whether the buffer was running
+bool buffer_shm_stop(buffer_shm_t * object);
+
+//! @brief Waits until bytes are readable
+//!
+//! @details See: \ref buffer_shm
+//!
+//! Can be use in:
+//! - consumer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param deadline Deadline, see ::buffer_until_now()
+//! @return Returns whether bytes are readable, the deadline has passed or the buffer is stopped
+buffer_until_status_t buffer_shm_wait_data(buffer_shm_t * object, uint64_t deadline);
+
+//! @brief Waits until at least @p n bytes are free
+//!
+//! @details See: \ref buffer_shm
+//!
+//! Can be use in:
+//! - producer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param n The number of bytes, at most ::buffer_shm_s::size
+//! @param deadline Deadline, see ::buffer_until_now()
+//! @return Returns whether the bytes are free, the deadline has passed or the buffer is stopped
+buffer_until_status_t buffer_shm_wait_space(buffer_shm_t * object, size_t n, uint64_t deadline);
+
+//! @brief Writes up to @p n bytes
+//!
+//! @details Does not block, the bytes that do not fit are skipped. Both parts of a wrapped
+//! ring are written and published together.
+//!
+//! Can be use in:
+//! - producer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param[in] src The bytes
+//! @param n The number of bytes
+//! @return Returns the number of bytes written
+size_t buffer_shm_write(buffer_shm_t * object, const char * src, size_t n);
+
+//! @brief Publishes @p n bytes after ::buffer_shm_write_reserve()
+//!
+//! Can be use in:
+//! - producer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param n The number of bytes written to the span, at most the length of the span
+//! @return Returns the number of bytes published
+size_t buffer_shm_write_commit(buffer_shm_t * object, size_t n);
+
+//! @brief Returns the contiguous free bytes for writing without copying
+//!
+//! @details At the end of the ring the span is shorter than ::buffer_shm_space(), the rest
+//! follows at the start of the ring with the next call. The bytes are published with
+//! ::buffer_shm_write_commit().
+//!
+//! Can be use in:
+//! - producer process/thread.
+//!
+//! @param[in,out] object The buffer
+//! @param[out] span Start of the free bytes in the ring, `NULL` if nothing is free
+//! @return Returns the number of bytes of the span
+size_t buffer_shm_write_reserve(buffer_shm_t * object, char ** span);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_SHM_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_SHM_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_SHM_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,228 @@
+//! @file
+//! @brief The buffer slot queue header file.
+//!
+//! @details A queue of fixed-size messages, an alternative to the character buffer for
+//! small structs. For more information see: @ref buffer_slot
+
+
+#ifndef INC_BUFFER_SLOT_H_
+#define INC_BUFFER_SLOT_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_SLOT_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_slot Fixed-size slot queue
+//!
+//! @details The slot queue ::buffer_slot_t divides the data array into slots of the same size.
+//! Each slot carries a sequence number and an aligned payload, e.g. a 16 to 64 byte message.
+//!
+//! - The producer and the consumer only exchange the sequence number of the slot they use,
+//!   there are no shared counters. ::buffer_s::length and ::buffer_s::lines stay 0.
+//! - The lifecycle is that of the embedded ::buffer_slot_s::buffer, use ::buffer_start(),
+//!   ::buffer_stop_force() and ::buffer_stop_try() with it.
+//! - The handlers of the embedded buffer are called, a message counts as a line:
+//!   buffer_s::on_new_line, buffer_s::on_full and buffer_s::on_empty.
+//! - The character functions, e.g. ::buffer_set(), must not be used with the embedded buffer.
+//!
+//! @{
+
+#ifndef BUFFER_SLOT_ALIGNMENT
+
+  //! @brief Alignment of the slots, must be a power of two
+  #define BUFFER_SLOT_ALIGNMENT 16
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Header in front of the payload of each slot
+typedef struct buffer_slot_header_s
+{
+    //! @brief Position of the slot, the slot is free if it matches the position of the
+    //! producer and filled if it matches the position of the consumer plus one
+    volatile _Atomic(size_t) sequence;
+}buffer_slot_header_t;
+
+//! @brief Slot queue, see: \ref buffer_slot
+typedef struct buffer_slot_s
+{
+    //! @brief Buffer for the lifecycle, the handlers and the user data
+    buffer_t buffer;
+
+    //! @brief Start of the first slot, aligned to ::BUFFER_SLOT_ALIGNMENT
+    char * slots;
+
+    //! @brief Distance between two slots
+    size_t stride;
+
+    //! @brief Number of bytes of the payload
+    size_t payload_size;
+
+    //! @brief Number of slots minus one, the number of slots is a power of two
+    size_t mask;
+
+    //! @brief To separate the position of the producer
+    char padding_producer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Position of the next slot to fill, only used by the producer/set thread
+    size_t head;
+
+    //! @brief To separate the position of the consumer
+    char padding_consumer[BUFFER_CACHE_LINE_SIZE];
+
+    //! @brief Position of the next slot to read, only used by the consumer/get thread
+    size_t tail;
+
+    //! @brief To separate the position of the consumer from the following data
+    char padding_back[BUFFER_CACHE_LINE_SIZE];
+}buffer_slot_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_slot can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_slot_sc
+{
+    size_t (* Count    ) (const buffer_slot_t * object); ///< @brief See ::buffer_slot_count()
+    bool   (* Init     ) (buffer_slot_t * object, char * data, size_t sizeof_data, size_t payload_size, bool start); ///< @brief See ::buffer_slot_init()
+    bool   (* Pop      ) (buffer_slot_t * object, void * dest); ///< @brief See ::buffer_slot_pop()
+    size_t (* PopBatch ) (buffer_slot_t * object, void * dest, size_t n); ///< @brief See ::buffer_slot_pop_batch()
+    bool   (* Push     ) (buffer_slot_t * object, const void * src); ///< @brief See ::buffer_slot_push()
+    size_t (* PushBatch) (buffer_slot_t * object, const void * src, size_t n); ///< @brief See ::buffer_slot_push_batch()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the slot queue
+extern const struct buffer_slot_sc buffer_slot;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Returns the number of slots
+//!
+//! @param[in] object The slot queue
+//! @return Number of slots, 0 if the queue could not be initialized
+size_t buffer_slot_count(const buffer_slot_t * object);
+
+//! @brief Initializes the slot queue
+//!
+//! @details Initializes the embedded buffer with ::buffer_init() and divides @p data into
+//! the largest power of two number of slots that fits.
+//!
+//! @attention Must not be used if one of the threads is used.
+//!
+//! @param[out] object The slot queue
+//! @param data The array in which the slots are stored
+//! @param sizeof_data Length of the array
+//! @param payload_size Number of bytes of each message
+//! @param start Starting or stopping the embedded buffer
+//! @return Returns whether at least one slot fits into @p data
+//! @retval true  Initialized
+//! @retval false @p object or @p data was `NULL`, or no slot fits
+bool buffer_slot_init(buffer_slot_t * object, char * data, size_t sizeof_data, size_t payload_size, bool start);
+
+//! @brief Reads and removes the next message
+//!
+//! @details Does not block and does not guarantee a read.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The slot queue
+//! @param[out] dest The message is written in this buffer, ::buffer_slot_s::payload_size bytes
+//! @return Returns whether a message was read
+bool buffer_slot_pop(buffer_slot_t * object, void * dest);
+
+//! @brief Reads and removes up to @p n messages
+//!
+//! @details Does not block and does not guarantee a read.
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The slot queue
+//! @param[out] dest Array of @p n messages
+//! @param n The number of messages of the array
+//! @return Returns the number of messages read
+size_t buffer_slot_pop_batch(buffer_slot_t * object, void * dest, size_t n);
+
+//! @brief Writes a message
+//!
+//! @details Does not block, if all slots are used the message is skipped.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The slot queue
+//! @param[in] src The message, ::buffer_slot_s::payload_size bytes
+//! @return Returns whether the message was written
+bool buffer_slot_push(buffer_slot_t * object, const void * src);
+
+//! @brief Writes up to @p n messages
+//!
+//! @details Does not block, the messages that do not fit are skipped.
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The slot queue
+//! @param[in] src Array of @p n messages
+//! @param n The number of messages of the array
+//! @return Returns the number of messages written
+size_t buffer_slot_push_batch(buffer_slot_t * object, const void * src, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_SLOT_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_SLOT_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_SLOT_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
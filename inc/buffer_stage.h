@@ -0,0 +1,211 @@
+//! @file
+//! @brief The buffer pipeline stage header file.
+//!
+//! @details Connects buffer objects with transform functions that run in an executor.
+//! For more information see: @ref buffer_stage
+
+
+#ifndef INC_BUFFER_STAGE_H_
+#define INC_BUFFER_STAGE_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+#include "buffer_executor.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+
+  // buffer.h removes its definition at the end, see: @ref buffer_c_and_cpp_atomic_header
+  #ifndef _Atomic
+    #define _Atomic(X) std::atomic<X>
+    #define BUFFER_STAGE_UNDEFINE_ATOMIC
+  #endif
+
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_stage Pipeline stages
+//!
+//! @details A pipeline, e.g. raw UART, line splitter, parser and logger, is built from
+//! ::buffer_stage_t objects. Each stage reads its input buffer, passes the characters to a
+//! transform function and writes the result to its output buffer, which is the input of the
+//! next stage. The stages run as tasks in a ::buffer_executor_t, see \ref buffer_executor.
+//!
+//! - The transform gets the readable span of the input and the free span of the output,
+//!   see ::buffer_read_span() and ::buffer_write_reserve(). Nothing is copied by the stage.
+//! - A stage is only queued when characters are published in its input, see ::BUFFER_WAIT_DATA.
+//!   The worker threads sleep if no stage is queued.
+//! - Per run at most ::BUFFER_STAGE_BATCH characters are processed, then the stage is queued
+//!   behind the other stages again.
+//! - If the output is full, or its free space is too small for the next result, the stage
+//!   waits until the next stage has read it empty. The input is not read in the meantime,
+//!   so that the backpressure reaches the first stage.
+//! - The throughput and the run time of each stage are counted, see ::buffer_stage_stats().
+//! - The buffer is linear, its space is only returned when it was read empty. The transform
+//!   therefore reads all characters that it can process and keeps incomplete units, e.g. the
+//!   beginning of a line, in its context. A stage never waits for more input.
+//! - The stage is the consumer/get thread of its input and the producer/set thread of its
+//!   output, the waiters of ::BUFFER_WAIT_DATA on the input and of ::BUFFER_WAIT_SPACE on the
+//!   output are used.
+//!
+//! @{
+
+#ifndef BUFFER_STAGE_BATCH
+
+  //! @brief Maximum number of characters read by a stage per run
+  #define BUFFER_STAGE_BATCH 4096
+
+#endif
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+typedef struct buffer_stage_s buffer_stage_t;
+
+//! @brief Transform function of a stage
+//!
+//! @details Called with all readable characters of the input and all free space of the
+//! output. The function reads as many characters as their results fit into the output,
+//! all of them if the stage has no output. If nothing was read and written while the output
+//! is not empty, the function is called again when the output has more free space.
+//! Otherwise, e.g. because a record is incomplete, it is called again when further
+//! characters are published to the input, see ::buffer_stage_stats_s::stalls.
+//!
+//! @param[in,out] stage The stage
+//! @param[in] src The readable characters of the input
+//! @param n The number of readable characters
+//! @param[out] dest The free space of the output, `NULL` if the stage has no output
+//! @param space The number of free characters of the output
+//! @param[out] consumed The number of characters read from @p src, 0 by default
+//! @return Returns the number of characters written to @p dest
+typedef size_t (*buffer_stage_handler_t)(buffer_stage_t * stage, const char * src, size_t n, char * dest, size_t space, size_t * consumed);
+
+//! @brief Counters of a stage, see ::buffer_stage_stats()
+typedef struct buffer_stage_stats_s
+{
+    uint64_t runs;      ///< Number of runs
+    uint64_t bytes_in;  ///< Number of characters read from the input
+    uint64_t bytes_out; ///< Number of characters written to the output
+    uint64_t stalls;    ///< Number of runs that ended with a full output or with incomplete input
+    uint64_t busy_ns;   ///< Sum of the run times in nanoseconds
+    uint64_t max_ns;    ///< Longest run time in nanoseconds
+}buffer_stage_stats_t;
+
+//! @brief Stage of a pipeline, see: \ref buffer_stage
+struct buffer_stage_s
+{
+    buffer_waiter_t waiter_input;       ///< Armed for ::BUFFER_WAIT_DATA on the input
+    buffer_waiter_t waiter_output;      ///< Armed for ::BUFFER_WAIT_SPACE on the output
+    buffer_task_t task;                 ///< Runs the stage
+    buffer_executor_t * executor;       ///< The executor
+    buffer_t * input;                   ///< The input
+    buffer_t * output;                  ///< The output, `NULL` for the last stage
+    buffer_stage_handler_t transform;   ///< The transform function
+    void * context;                     ///< Freely usable by the transform function
+    volatile _Atomic(bool) attached;    ///< `false` after ::buffer_stage_detach()
+
+    volatile _Atomic(uint64_t) runs;      ///< See ::buffer_stage_stats_s::runs
+    volatile _Atomic(uint64_t) bytes_in;  ///< See ::buffer_stage_stats_s::bytes_in
+    volatile _Atomic(uint64_t) bytes_out; ///< See ::buffer_stage_stats_s::bytes_out
+    volatile _Atomic(uint64_t) stalls;    ///< See ::buffer_stage_stats_s::stalls
+    volatile _Atomic(uint64_t) busy_ns;   ///< See ::buffer_stage_stats_s::busy_ns
+    volatile _Atomic(uint64_t) max_ns;    ///< See ::buffer_stage_stats_s::max_ns
+};
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_stage can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_stage_sc
+{
+    bool (* Attach) (buffer_stage_t * stage, buffer_executor_t * executor); ///< @brief See ::buffer_stage_attach()
+    bool (* Detach) (buffer_stage_t * stage); ///< @brief See ::buffer_stage_detach()
+    bool (* Init  ) (buffer_stage_t * stage, buffer_t * input, buffer_stage_handler_t transform, buffer_t * output, void * context); ///< @brief See ::buffer_stage_init()
+    void (* Stats ) (const buffer_stage_t * stage, buffer_stage_stats_t * dest); ///< @brief See ::buffer_stage_stats()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the pipeline stages
+extern const struct buffer_stage_sc buffer_stage;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Runs the stage in the executor
+//!
+//! @details Characters that are already in the input are processed immediately.
+//!
+//! @param[in,out] stage The stage, see ::buffer_stage_init()
+//! @param[in,out] executor The executor
+//! @return Returns whether the stage was attached
+bool buffer_stage_attach(buffer_stage_t * stage, buffer_executor_t * executor);
+
+//! @brief Ends the connection of ::buffer_stage_attach()
+//!
+//! @details A run that is already queued or running is still finished.
+//!
+//! @param[in,out] stage The stage
+//! @return Returns whether the stage was idle, i.e. no run is queued or running
+bool buffer_stage_detach(buffer_stage_t * stage);
+
+//! @brief Initializes a stage
+//!
+//! @param[out] stage The stage, must stay valid until the executor is ended
+//! @param[in,out] input The input
+//! @param transform The transform function
+//! @param[in,out] output The output, `NULL` is allowed
+//! @param context Freely usable by the transform function
+//! @return Returns whether the stage was initialized
+bool buffer_stage_init(buffer_stage_t * stage, buffer_t * input, buffer_stage_handler_t transform, buffer_t * output, void * context);
+
+//! @brief Copies the counters of a stage
+//!
+//! @details Can be used in any thread, the counters are read one by one.
+//!
+//! @param[in] stage The stage
+//! @param[out] dest The counters
+void buffer_stage_stats(const buffer_stage_t * stage, buffer_stage_stats_t * dest);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#ifdef __cplusplus
+#ifdef BUFFER_STAGE_UNDEFINE_ATOMIC
+#undef _Atomic
+#undef BUFFER_STAGE_UNDEFINE_ATOMIC
+#endif
+#endif
+
+#endif /* INC_BUFFER_STAGE_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
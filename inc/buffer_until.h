@@ -0,0 +1,167 @@
+//! @file
+//! @brief The buffer deadline header file.
+//!
+//! @details Blocking get, set and read line functions with a monotonic deadline.
+//! For more information see: @ref buffer_until
+
+
+#ifndef INC_BUFFER_UNTIL_H_
+#define INC_BUFFER_UNTIL_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdint.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_until Deadline variants of the blocking functions
+//!
+//! @details ::buffer_get() and ::buffer_set() can only be bounded with the handlers
+//! ::buffer_s::on_wait_get and ::buffer_s::on_wait_set, which are called in every cycle of
+//! the wait loop and have to read a clock each time. ::buffer_get_until(), ::buffer_set_until()
+//! and ::buffer_read_line_until() take a deadline instead, see ::buffer_until_now().
+//!
+//! - First the condition is checked ::BUFFER_UNTIL_SPIN times without reading the clock.
+//! - Then a waiter is armed for the transition, see \ref buffer_waiter, and the thread
+//!   sleeps until it is woken or the deadline has passed. On Linux a futex is used, on
+//!   other systems the thread sleeps in steps of ::BUFFER_UNTIL_SLEEP_NS.
+//! - The result distinguishes a timeout from a stopped buffer, see ::buffer_until_status_t.
+//! - No other waiter may be armed for the same transition at the same time.
+//!
+//! @{
+
+#ifndef BUFFER_UNTIL_SPIN
+
+  //! @brief Number of checks before the thread sleeps
+  #define BUFFER_UNTIL_SPIN 64
+
+#endif
+
+#ifndef BUFFER_UNTIL_SLEEP_NS
+
+  //! @brief Longest sleep in nanoseconds without futex
+  #define BUFFER_UNTIL_SLEEP_NS 100000
+
+#endif
+
+//! @brief Deadline that never passes
+#define BUFFER_UNTIL_FOREVER UINT64_MAX
+
+//! @}
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Result of the deadline functions, see: \ref buffer_until
+typedef enum buffer_until_status_e
+{
+    BUFFER_UNTIL_OK = 0,      ///< The operation was performed
+    BUFFER_UNTIL_TIMEOUT = 1, ///< The deadline has passed
+    BUFFER_UNTIL_STOPPED = 2, ///< The buffer is stopped or a parameter is invalid
+}buffer_until_status_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_until can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_until_sc
+{
+    uint64_t             (* After   ) (uint64_t timeout); ///< @brief See ::buffer_until_after()
+    buffer_until_status_t (* Get     ) (buffer_t * object, char * c, uint64_t deadline); ///< @brief See ::buffer_get_until()
+    uint64_t             (* Now     ) (void); ///< @brief See ::buffer_until_now()
+    buffer_until_status_t (* ReadLine) (buffer_t * object, char * dest, size_t n, size_t * length, uint64_t deadline); ///< @brief See ::buffer_read_line_until()
+    buffer_until_status_t (* Set     ) (buffer_t * object, char c, uint64_t deadline); ///< @brief See ::buffer_set_until()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the deadline variants
+extern const struct buffer_until_sc buffer_until;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Reads a character, waits until the deadline if the buffer is empty
+//!
+//! @details As ::buffer_get(), the character '\0' is read like every other character.
+//! See: \ref buffer_until
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] c The character, only written with ::BUFFER_UNTIL_OK
+//! @param deadline Deadline, see ::buffer_until_now()
+//! @return Returns whether the character was read, the deadline has passed or the buffer is stopped
+buffer_until_status_t buffer_get_until(buffer_t * object, char * c, uint64_t deadline);
+
+//! @brief Reads a line, waits until the deadline if there is no complete line
+//!
+//! @details See: \ref buffer_until and ::buffer_read_line()
+//!
+//! Can be use in:
+//! - consumer/get thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param[out] dest The line, terminated with '\\0'
+//! @param n The length of @p dest
+//! @param[out] length Number of characters read, `NULL` is allowed
+//! @param deadline Deadline, see ::buffer_until_now()
+//! @return Returns whether the line was read, the deadline has passed or the buffer is stopped
+buffer_until_status_t buffer_read_line_until(buffer_t * object, char * dest, size_t n, size_t * length, uint64_t deadline);
+
+//! @brief Writes a character, waits until the deadline if the buffer is full
+//!
+//! @details See: \ref buffer_until
+//!
+//! Can be use in:
+//! - producer/set thread.
+//!
+//! @param[in,out] object The buffer object
+//! @param c The character
+//! @param deadline Deadline, see ::buffer_until_now()
+//! @return Returns whether the character was written, the deadline has passed or the buffer is stopped
+buffer_until_status_t buffer_set_until(buffer_t * object, char c, uint64_t deadline);
+
+//! @brief Returns the deadline @p timeout nanoseconds from now
+//!
+//! @param timeout Timeout in nanoseconds
+//! @return The deadline, ::BUFFER_UNTIL_FOREVER if it cannot be represented
+uint64_t buffer_until_after(uint64_t timeout);
+
+//! @brief Returns the current time of the deadlines
+//!
+//! @details Nanoseconds of a monotonic clock.
+//!
+//! @return The current time
+uint64_t buffer_until_now(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUFFER_UNTIL_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,157 @@
+//! @file
+//! @brief The buffer io_uring header file.
+//!
+//! @details Services the file descriptors of many buffer objects from one thread with
+//! batched asynchronous requests. For more information see: @ref buffer_enable_io_uring
+
+
+#ifndef INC_BUFFER_URING_H_
+#define INC_BUFFER_URING_H_
+
+
+/*---------------------------------------------------------------------*
+ *  public: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer.h"
+
+#include <stdbool.h>
+
+#ifdef BUFFER_ENABLE_IO_URING
+  #include <liburing.h>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------*
+ *  public: define
+ *---------------------------------------------------------------------*/
+
+//! @defgroup buffer_enable_io_uring Optional io_uring backend
+//!
+//! @details A ::buffer_uring_t services a set of channels ::buffer_uring_channel_t,
+//! each connects a buffer object with a file descriptor, see ::buffer_uring_poll().
+//!
+//! - An ingress channel keeps a read request posted directly into the free space of the
+//!   buffer, see ::buffer_write_reserve(). The completion publishes the characters with
+//!   ::buffer_write_commit().
+//! - An egress channel keeps a write request posted from the readable characters of the
+//!   buffer, see ::buffer_read_span(). The completion removes them with ::buffer_read_consume().
+//! - All requests of a call are submitted together with one system call.
+//! - The thread that calls ::buffer_uring_poll() is the producer/set thread of the ingress
+//!   buffers and the consumer/get thread of the egress buffers.
+//! - The io_uring backend is activated by setting the ::BUFFER_ENABLE_IO_URING define and
+//!   linking liburing. Without the define, or if the kernel does not support io_uring,
+//!   the channels are serviced with ::buffer_fill_from_fd() and ::buffer_drain_to_fd().
+//!   The file descriptors should then be non-blocking.
+//! - The io_uring path is not covered by the testbench, it has only been compiled against
+//!   the liburing declarations. The fallback is tested.
+
+
+/*---------------------------------------------------------------------*
+ *  public: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Connects a buffer object with a file descriptor, see: \ref buffer_enable_io_uring
+typedef struct buffer_uring_channel_s
+{
+    buffer_t * object; ///< The buffer object
+    int fd;            ///< The file descriptor
+    bool egress;       ///< `true` writes the buffer to @p fd, `false` reads @p fd into the buffer
+    bool closed;       ///< End of file or an error occurred, the channel is no longer serviced
+    int error;         ///< `errno` value of the error, 0 at end of file
+    char * span;       ///< Span of the posted request
+    size_t pending;    ///< Length of the posted request, 0 if no request is posted
+}buffer_uring_channel_t;
+
+//! @brief Services a set of channels, see: \ref buffer_enable_io_uring
+typedef struct buffer_uring_s
+{
+#ifdef BUFFER_ENABLE_IO_URING
+    struct io_uring ring; ///< The io_uring instance
+#endif
+    buffer_uring_channel_t * channels; ///< Array of the channels
+    size_t count;  ///< Number of channels
+    bool active;   ///< `true` if io_uring is used, `false` for the fallback
+}buffer_uring_t;
+
+//! @brief Represents a simplified form of a class
+//!
+//! @details The global variable ::buffer_uring can be used to easily access all matching
+//! functions with auto-completion.
+struct buffer_uring_sc
+{
+    bool   (* Channel) (buffer_uring_channel_t * channel, buffer_t * object, int fd, bool egress); ///< @brief See ::buffer_uring_channel()
+    void   (* Exit   ) (buffer_uring_t * uring); ///< @brief See ::buffer_uring_exit()
+    bool   (* Init   ) (buffer_uring_t * uring, buffer_uring_channel_t * channels, size_t count); ///< @brief See ::buffer_uring_init()
+    size_t (* Poll   ) (buffer_uring_t * uring, bool wait); ///< @brief See ::buffer_uring_poll()
+};
+
+
+/*---------------------------------------------------------------------*
+ *  public: extern variables
+ *---------------------------------------------------------------------*/
+
+//! @brief To access all member functions of the io_uring backend
+extern const struct buffer_uring_sc buffer_uring;
+
+
+/*---------------------------------------------------------------------*
+ *  public: function prototypes
+ *---------------------------------------------------------------------*/
+
+//! @brief Initializes a channel
+//!
+//! @param[out] channel The channel
+//! @param[in,out] object The buffer object
+//! @param fd The file descriptor
+//! @param egress `true` writes the buffer to @p fd, `false` reads @p fd into the buffer
+//! @return Returns whether the channel was initialized
+//! @retval false @p channel or @p object was `NULL`
+bool buffer_uring_channel(buffer_uring_channel_t * channel, buffer_t * object, int fd, bool egress);
+
+//! @brief Releases the io_uring instance
+//!
+//! @details Requests that are still posted are canceled and their completions are waited for,
+//! characters that were already transferred are published or removed, reserved space is released.
+//!
+//! @param[in,out] uring The instance
+void buffer_uring_exit(buffer_uring_t * uring);
+
+//! @brief Initializes the instance for the given channels
+//!
+//! @details Falls back to ::buffer_fill_from_fd() and ::buffer_drain_to_fd() if io_uring
+//! is not available, see ::buffer_uring_s::active.
+//!
+//! @param[out] uring The instance
+//! @param[in,out] channels Array of initialized channels, see ::buffer_uring_channel()
+//! @param count Number of channels
+//! @return Returns whether the instance was initialized
+//! @retval false @p uring or @p channels was `NULL`
+bool buffer_uring_init(buffer_uring_t * uring, buffer_uring_channel_t * channels, size_t count);
+
+//! @brief Posts the requests of all channels and processes the completions
+//!
+//! @details A request is posted for every channel without request that has free space or
+//! readable characters. All requests are submitted with one system call.
+//!
+//! @param[in,out] uring The instance
+//! @param wait `true` waits for at least one completion. If no request can be posted, the
+//! buffers are checked again in steps of ::BUFFER_UNTIL_SLEEP_NS until a request is posted or
+//! all channels are closed or stopped. Without io_uring the function does not wait.
+//! @return Returns the number of characters transferred
+size_t buffer_uring_poll(buffer_uring_t * uring, bool wait);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUFFER_URING_H_ */
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -8,13 +8,202 @@
 
 #include "buffer.h"
 
-#include <string.h> // memcmp
+#include <string.h> // memcmp, memcpy, memchr, memset, strlen
 #include <stdlib.h> // malloc, free
 
+#ifdef BUFFER_ENABLE_LATENCY
+  #include "buffer_latency.h"
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+  #include "buffer_crc.h"
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  #include <tmmintrin.h> // _mm_shuffle_epi8
+  #define BUFFER_DELIMITERS_USE_SSSE3
+#endif
+
+#ifdef BUFFER_ENABLE_USDT
+  #if defined(__has_include)
+    #if __has_include(<sys/sdt.h>)
+      #include <sys/sdt.h> // DTRACE_PROBE3
+    #endif
+  #endif
+#endif
+
 
 /*---------------------------------------------------------------------*
  *  private: definitions
  *---------------------------------------------------------------------*/
+
+#ifdef BUFFER_ENABLE_STATS
+
+//! @brief Adds @p N to a counter, the counter is only written by one side
+#define BUFFER_STATS_ADD(OBJ, SIDE, FIELD, N) \
+    atomic_store_explicit(&((OBJ)->stats.SIDE.FIELD), \
+        atomic_load_explicit(&((OBJ)->stats.SIDE.FIELD), memory_order_relaxed) + (N), memory_order_relaxed)
+
+//! @brief Updates the peak occupancy, only used in the producer/set thread
+#define BUFFER_STATS_PEAK(OBJ, LENGTH) do { \
+    if((LENGTH) > atomic_load_explicit(&((OBJ)->stats.producer.peak), memory_order_relaxed)) \
+    { atomic_store_explicit(&((OBJ)->stats.producer.peak), (LENGTH), memory_order_relaxed); } \
+    } while(0)
+
+//! @brief Counts a reset, ::buffer_clear() can also be called from the producer/set thread
+#define BUFFER_STATS_RESET(OBJ) \
+    atomic_fetch_add_explicit(&((OBJ)->stats.consumer.resets), 1, memory_order_relaxed)
+
+#else
+
+#define BUFFER_STATS_ADD(OBJ, SIDE, FIELD, N)
+#define BUFFER_STATS_PEAK(OBJ, LENGTH) ((void)(LENGTH))
+#define BUFFER_STATS_RESET(OBJ)
+
+#endif
+
+#ifdef DTRACE_PROBE3
+
+//! @brief Static tracepoint, see: \ref buffer_enable_usdt
+#define BUFFER_PROBE(NAME, OBJ, LENGTH, EVENT) \
+    DTRACE_PROBE3(buffer, NAME, (OBJ), (size_t)(LENGTH), (int)(EVENT))
+
+#else
+
+#define BUFFER_PROBE(NAME, OBJ, LENGTH, EVENT)
+
+#endif
+
+#ifdef BUFFER_ENABLE_LATENCY
+
+//! @brief Stores the time stamp of a line, see: \ref buffer_enable_latency
+#define BUFFER_LATENCY_PUBLISH(OBJ) do { \
+    if(NULL != (OBJ)->latency) { buffer_latency_publish((OBJ)->latency); } \
+    } while(0)
+
+//! @brief Records the latency of a line, see: \ref buffer_enable_latency
+#define BUFFER_LATENCY_CONSUME(OBJ) do { \
+    if(NULL != (OBJ)->latency) { buffer_latency_consume((OBJ)->latency); } \
+    } while(0)
+
+//! @brief Skips the time stamps of removed lines, see: \ref buffer_enable_latency
+#define BUFFER_LATENCY_DISCARD(OBJ, LINES) do { \
+    if(NULL != (OBJ)->latency) { buffer_latency_discard((OBJ)->latency, (LINES)); } \
+    } while(0)
+
+#else
+
+#define BUFFER_LATENCY_PUBLISH(OBJ) do { } while(0)
+#define BUFFER_LATENCY_CONSUME(OBJ) do { } while(0)
+#define BUFFER_LATENCY_DISCARD(OBJ, LINES) do { } while(0)
+
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+
+//! @brief Adds characters to the checksum of the current frame, see: \ref buffer_enable_crc
+#define BUFFER_CRC_UPDATE(OBJ, SRC, N) do { \
+    if(NULL != (OBJ)->crc) { buffer_crc_update((OBJ)->crc, (SRC), (N)); } \
+    } while(0)
+
+//! @brief Stores the checksum of a finished frame, see: \ref buffer_enable_crc
+#define BUFFER_CRC_PUBLISH(OBJ) do { \
+    if(NULL != (OBJ)->crc) { buffer_crc_publish((OBJ)->crc); } \
+    } while(0)
+
+//! @brief Releases the checksums of read frames, see: \ref buffer_enable_crc
+#define BUFFER_CRC_CONSUME(OBJ, FRAMES) do { \
+    if(NULL != (OBJ)->crc) { atomic_fetch_add_explicit(&((OBJ)->crc->consumed), (FRAMES), memory_order_release); } \
+    } while(0)
+
+//! @brief Releases the checksums of all frames published until @p PUBLISHED, see: \ref buffer_enable_crc
+#define BUFFER_CRC_DISCARD(OBJ, PUBLISHED) do { \
+    if(NULL != (OBJ)->crc) { atomic_store_explicit(&((OBJ)->crc->consumed), (PUBLISHED), memory_order_release); } \
+    } while(0)
+
+//! @brief Returns the number of published frames, see: \ref buffer_enable_crc
+#define BUFFER_CRC_PUBLISHED(OBJ) \
+    ((NULL != (OBJ)->crc) ? atomic_load_explicit(&((OBJ)->crc->published), memory_order_relaxed) : 0)
+
+#else
+
+#define BUFFER_CRC_UPDATE(OBJ, SRC, N) do { (void)(SRC); } while(0)
+#define BUFFER_CRC_PUBLISH(OBJ) do { } while(0)
+#define BUFFER_CRC_CONSUME(OBJ, FRAMES) do { (void)(FRAMES); } while(0)
+#define BUFFER_CRC_DISCARD(OBJ, PUBLISHED) do { (void)(PUBLISHED); } while(0)
+#define BUFFER_CRC_PUBLISHED(OBJ) ((size_t)0)
+
+#endif
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+//! @brief Makes the version of a side odd before it changes the metadata, see: \ref buffer_enable_snapshot
+#define BUFFER_VERSION_BEGIN(OBJ, SIDE) do { \
+    atomic_store_explicit(&((OBJ)->versions.SIDE), atomic_load_explicit(&((OBJ)->versions.SIDE), memory_order_relaxed) + 1, memory_order_relaxed); \
+    atomic_thread_fence(memory_order_release); \
+    } while(0)
+
+//! @brief Makes the version of a side even after it changed the metadata, see: \ref buffer_enable_snapshot
+#define BUFFER_VERSION_END(OBJ, SIDE) do { \
+    atomic_store_explicit(&((OBJ)->versions.SIDE), atomic_load_explicit(&((OBJ)->versions.SIDE), memory_order_relaxed) + 1, memory_order_release); \
+    } while(0)
+
+#else
+
+#define BUFFER_VERSION_BEGIN(OBJ, SIDE) do { } while(0)
+#define BUFFER_VERSION_END(OBJ, SIDE) do { } while(0)
+
+#endif
+
+#if (0 != (BUFFER_LINE_INDEX_ENTRIES & (BUFFER_LINE_INDEX_ENTRIES - 1)))
+#error BUFFER_LINE_INDEX_ENTRIES must be a power of two
+#endif
+
+#if (BUFFER_TERMINATOR_SIZE < 1) || (8 < BUFFER_TERMINATOR_SIZE)
+#error BUFFER_TERMINATOR_SIZE must be between 1 and 8, the characters in front of the last one are kept in a uint64_t
+#endif
+
+//! @brief Returns whether the End-Of-Line characters depend on the characters in front of them, see: \ref buffer_delimiters
+#define BUFFER_TERMINATOR_USED(OBJ) \
+    ((NULL != (OBJ)->delimiters) && (OBJ)->delimiters->terminator_required)
+
+//! @brief Stores the position of an End-Of-Line character, see: \ref buffer_line_index
+#define BUFFER_LINE_INDEX_PUBLISH(OBJ, PTR) do { \
+    if(NULL != (OBJ)->line_index) { buffer_line_index_publish((OBJ), (PTR)); } \
+    } while(0)
+
+//! @brief Skips the positions of consumed or removed lines, see: \ref buffer_line_index
+#define BUFFER_LINE_INDEX_CONSUME(OBJ, LINES) do { \
+    if(NULL != (OBJ)->line_index) { atomic_fetch_add_explicit(&((OBJ)->line_index->consumed), (LINES), memory_order_release); } \
+    } while(0)
+
+//! @brief Returns whether the character @p C is in the set @p SET, see: \ref buffer_delimiters
+#define BUFFER_DELIMITERS_CONTAINS(SET, C) \
+    (0 != ((SET)->set[(unsigned char)(C) >> 3] & (1u << ((unsigned char)(C) & 7u))))
+
+//! @brief Returns whether the character @p C ends a line, see: \ref buffer_delimiters
+#define BUFFER_IS_END_OF_LINE(OBJ, C) \
+    ((NULL == (OBJ)->delimiters) ? ((OBJ)->end_of_line_character == (C)) : BUFFER_DELIMITERS_CONTAINS((OBJ)->delimiters, (C)))
+
+//! @brief Wakes the waiter of a transition, see: \ref buffer_waiter
+#define BUFFER_WAITER_NOTIFY(OBJ, EVENT) do { \
+    if(NULL != atomic_load(&((OBJ)->waiters[(EVENT)]))) { buffer_waiter_notify((OBJ), (EVENT)); } \
+    } while(0)
+
+//! @brief Signals the rising edge of the high watermark, @p LENGTH was increased by @p N
+//!
+//! @details See: \ref buffer_watermark, the edge is not detected with a high watermark of 0
+#define BUFFER_WATERMARK_RISE(OBJ, LENGTH, N) do { \
+    if(((OBJ)->watermark_high <= (LENGTH)) && (((LENGTH) - (N)) < (OBJ)->watermark_high)) { buffer_watermark_rise((OBJ)); } \
+    } while(0)
+
+//! @brief Signals the falling edge of the low watermark, @p LENGTH was decreased by @p N
+//!
+//! @details See: \ref buffer_watermark, the edge is not detected with a high watermark of 0
+#define BUFFER_WATERMARK_FALL(OBJ, LENGTH, N) do { \
+    if((0 != (OBJ)->watermark_high) && ((LENGTH) <= (OBJ)->watermark_low) && ((OBJ)->watermark_low < ((LENGTH) + (N)))) { buffer_watermark_fall((OBJ)); } \
+    } while(0)
+
 /*---------------------------------------------------------------------*
  *  private: typedefs
  *---------------------------------------------------------------------*/
@@ -29,38 +218,677 @@ const struct buffer_sc buffer =
 {
     buffer_clear,
     buffer_copy,
+    buffer_delimiters_attach,
+    buffer_delimiters_init,
     buffer_equal,
+    buffer_find_end_of_line,
+    buffer_find_line_end,
     buffer_get,
     buffer_get_available_or_null,
+    buffer_grow,
+    buffer_grow_free,
     buffer_init,
     buffer_is_empty,
     buffer_is_full,
     buffer_is_stopped,
     buffer_length,
+    buffer_line_index_attach,
+    buffer_line_tail,
     buffer_lines,
     buffer_look_available_or_null,
+    buffer_look_line,
+    buffer_notify_consumed,
+    buffer_notify_published,
     buffer_object_allocate,
     buffer_object_free,
+    buffer_peek_record,
+    buffer_pop_record,
+    buffer_pop_records,
+    buffer_push_record,
+    buffer_push_record_commit,
+    buffer_push_record_reserve,
     buffer_read,
+    buffer_read_consume,
     buffer_read_line,
+    buffer_read_span,
     buffer_read_to,
     buffer_reset,
     buffer_set,
     buffer_set_possible_or_skip,
+    buffer_skip_line,
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    buffer_snapshot,
+#endif
     buffer_space,
     buffer_start,
+#ifdef BUFFER_ENABLE_STATS
+    buffer_stats_snapshot,
+#endif
     buffer_stop_force,
     buffer_stop_try,
+    buffer_waiter_arm,
+    buffer_waiter_cancel,
+    buffer_watermark,
+    buffer_watermark_is_high,
     buffer_write,
+    buffer_write_commit,
+    buffer_write_reserve,
 };
 
 
 /*---------------------------------------------------------------------*
  *  private: function prototypes
  *---------------------------------------------------------------------*/
+
+static void buffer_consume_span(buffer_t * object, char * ptr, size_t n, size_t lines);
+static void buffer_delimiters_add(buffer_delimiters_t * delimiters, char c, size_t * buckets);
+#ifdef BUFFER_DELIMITERS_USE_SSSE3
+static const char * buffer_delimiters_scan(const buffer_delimiters_t * delimiters, const char * ptr, size_t n);
+#endif
+static bool buffer_find_line(buffer_t * object, char ** line, size_t * length);
+static bool buffer_find_record(buffer_t * object, char ** record, size_t * length);
+static size_t buffer_count_lines(const buffer_t * object, uint64_t tail, const char * ptr, size_t n);
+static bool buffer_end_of_line_step(const buffer_t * object, uint64_t * tail, char c);
+static char * buffer_last(const buffer_t * object);
+static void buffer_line_index_publish(buffer_t * object, const char * ptr);
+static char * buffer_producer(const buffer_t * object, char ** last);
+static void buffer_record_publish(buffer_t * object, char * record);
+static char * buffer_record_reserve(buffer_t * object, size_t n, bool skip);
+static void buffer_region_free(buffer_region_t * region);
+static bool buffer_region_move(buffer_t * object, char * ptr, buffer_region_t * region);
+static void buffer_region_reclaim(buffer_t * object);
+static void buffer_region_retire(buffer_t * object, buffer_region_t * region);
+static bool buffer_rewind(buffer_t * object, char * ptr);
+static void buffer_stats_init(buffer_t * object);
+static bool buffer_waiter_ready(const buffer_t * object, buffer_wait_event_t event, const buffer_waiter_t * waiter);
+static void buffer_waiter_notify(buffer_t * object, buffer_wait_event_t event);
+static void buffer_watermark_fall(buffer_t * object);
+static void buffer_watermark_rise(buffer_t * object);
+
+
 /*---------------------------------------------------------------------*
  *  private: functions
  *---------------------------------------------------------------------*/
+
+//! @brief Removes @p n characters at once, @p ptr is the current ::buffer_s::consumer_ptr
+//!
+//! @details Must be called with the flag ::BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL.
+//! @p lines is the number of End-Of-Line characters within the characters.
+static void buffer_consume_span(buffer_t * object, char * ptr, size_t n, size_t lines)
+{
+    if(BUFFER_TERMINATOR_USED(object))
+    {
+        object->tail_consumed = buffer_line_tail(object->tail_consumed, ptr, n);
+    }
+
+    ptr += n;
+
+    BUFFER_VERSION_BEGIN(object, consumer);
+
+    object->consumer_ptr = ptr;
+    object->removed += n;
+
+    size_t length = atomic_fetch_sub(&object->length, n) - n;
+
+    if(0 < lines)
+    {
+        atomic_fetch_sub(&object->lines, lines);
+
+        for(size_t i = 0; i < lines; i++)
+        {
+            BUFFER_LATENCY_CONSUME(object);
+        }
+
+        BUFFER_LINE_INDEX_CONSUME(object, lines);
+
+        BUFFER_CRC_CONSUME(object, lines);
+    }
+
+    BUFFER_VERSION_END(object, consumer);
+
+    BUFFER_WATERMARK_FALL(object, length, n);
+
+    BUFFER_STATS_ADD(object, consumer, ops, 1);
+    BUFFER_STATS_ADD(object, consumer, bytes_out, n);
+    BUFFER_PROBE(get, object, length, BUFFER_PROBE_GET);
+
+    if(0 == length)
+    {
+        BUFFER_PROBE(empty, object, length, BUFFER_PROBE_EMPTY);
+    }
+
+    // An attempt is made to reset the buffer
+    if (buffer_rewind(object, ptr))
+    {
+        BUFFER_STATS_RESET(object);
+        BUFFER_PROBE(reset, object, 0, BUFFER_PROBE_RESET);
+
+        BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_SPACE);
+
+#ifdef BUFFER_ENABLE_HANDLER
+        if(object->on_empty) { object->on_empty(object); }
+#endif
+    }
+}
+
+//! @brief Adds a character to the set, @p buckets is the number of used buckets
+static void buffer_delimiters_add(buffer_delimiters_t * delimiters, char c, size_t * buckets)
+{
+    if(BUFFER_DELIMITERS_CONTAINS(delimiters, c)) { return; }
+
+    unsigned char u = (unsigned char)c;
+
+    delimiters->set[u >> 3] |= (unsigned char)(1u << (u & 7u));
+    delimiters->single = c;
+    delimiters->count++;
+
+    // Each high nibble gets its own bucket, further ones share the last bucket
+    if(0 == delimiters->high[u >> 4])
+    {
+        delimiters->high[u >> 4] = (unsigned char)(1u << ((*buckets < 8) ? *buckets : 7));
+        *buckets += 1;
+    }
+
+    delimiters->low[u & 15u] |= delimiters->high[u >> 4];
+}
+
+#ifdef BUFFER_DELIMITERS_USE_SSSE3
+
+//! @brief Searches 16 characters at a time, see: \ref buffer_delimiters
+//!
+//! @details The low nibble selects the buckets of the characters with this low nibble, the
+//! high nibble the bucket of its characters. A common bit is a candidate, the set decides.
+__attribute__((target("ssse3")))
+static const char * buffer_delimiters_scan(const buffer_delimiters_t * delimiters, const char * ptr, size_t n)
+{
+    const __m128i low = _mm_loadu_si128((const __m128i *)delimiters->low);
+    const __m128i high = _mm_loadu_si128((const __m128i *)delimiters->high);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+
+    for(; 16 <= n; ptr += 16, n -= 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)ptr);
+
+        __m128i buckets = _mm_and_si128(
+            _mm_shuffle_epi8(low, _mm_and_si128(v, nibble)),
+            _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, zero)) & 0xffffu;
+
+        for(; 0 != mask; mask &= mask - 1)
+        {
+            const char * found = ptr + __builtin_ctz(mask);
+
+            if(BUFFER_DELIMITERS_CONTAINS(delimiters, *found)) { return found; }
+        }
+    }
+
+    for(; 0 < n; ptr++, n--)
+    {
+        if(BUFFER_DELIMITERS_CONTAINS(delimiters, *ptr)) { return ptr; }
+    }
+
+    return NULL;
+}
+
+#endif
+
+//! @brief Finds the next complete line, first in the line offset index, then by searching
+//!
+//! @details Must be called with the flag ::BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL.
+//! @p length is the number of characters without End-Of-Line character.
+static bool buffer_find_line(buffer_t * object, char ** line, size_t * length)
+{
+    if(0 == atomic_load(&object->lines)){ return false; }
+
+    char * ptr = object->consumer_ptr;
+
+    size_t available = atomic_load(&object->length);
+
+    buffer_line_index_t * index = object->line_index;
+
+    if(NULL != index)
+    {
+        size_t consumed = atomic_load_explicit(&index->consumed, memory_order_relaxed);
+
+        buffer_line_index_entry_t * entry = &index->entries[consumed & (BUFFER_LINE_INDEX_ENTRIES - 1)];
+
+        if((consumed + 1) == atomic_load_explicit(&entry->sequence, memory_order_acquire))
+        {
+            char * eol = object->data + atomic_load_explicit(&entry->offset, memory_order_relaxed);
+
+            // The End-Of-Line character must already be counted in the length
+            if((ptr <= eol) && ((size_t)(eol - ptr) < available))
+            {
+                *line = ptr;
+                *length = (size_t)(eol - ptr);
+                return true;
+            }
+        }
+    }
+
+    // The position was not stored, the line is searched
+    char * eol = (char *)buffer_find_line_end(object, object->tail_consumed, ptr, available);
+
+    if(NULL == eol){ return false; }
+
+    *line = ptr;
+    *length = (size_t)(eol - ptr);
+    return true;
+}
+
+//! @brief Finds the next complete record
+//!
+//! @details Must be called with the flag ::BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL.
+//! @p record is the start of the payload, @p length the number of bytes of the payload.
+static bool buffer_find_record(buffer_t * object, char ** record, size_t * length)
+{
+    size_t available = atomic_load(&object->length);
+
+    if(available < BUFFER_RECORD_HEADER_SIZE){ return false; }
+
+    char * ptr = object->consumer_ptr;
+
+    size_t n;
+    memcpy(&n, ptr, BUFFER_RECORD_HEADER_SIZE);
+
+    // The record is published as a whole, this only fails if characters were mixed in
+    if((available - BUFFER_RECORD_HEADER_SIZE) < n){ return false; }
+
+    *record = ptr + BUFFER_RECORD_HEADER_SIZE;
+    *length = n;
+    return true;
+}
+
+//! @brief Returns the number of End-Of-Line characters within @p n characters
+//!
+//! @details @p tail are the last characters in front of @p ptr, see ::buffer_line_tail()
+static size_t buffer_count_lines(const buffer_t * object, uint64_t tail, const char * ptr, size_t n)
+{
+    size_t lines = 0;
+    const char * start = ptr;
+    const char * end = ptr + n;
+
+    if(!BUFFER_TERMINATOR_USED(object))
+    {
+        while(NULL != (ptr = buffer_find_end_of_line(object, ptr, (size_t)(end - ptr))))
+        {
+            ptr++;
+            lines++;
+        }
+
+        return lines;
+    }
+
+    while(NULL != (ptr = buffer_find_line_end(object, buffer_line_tail(tail, start, (size_t)(ptr - start)), ptr, (size_t)(end - ptr))))
+    {
+        ptr++;
+        lines++;
+    }
+
+    return lines;
+}
+
+//! @brief Returns whether the character @p c ends a line and appends it to @p tail
+//!
+//! @details @p tail is the ::buffer_s::tail_produced or ::buffer_s::tail_consumed of the
+//! side, it is only changed with a terminator of several characters.
+static bool buffer_end_of_line_step(const buffer_t * object, uint64_t * tail, char c)
+{
+    bool end_of_line = BUFFER_IS_END_OF_LINE(object, c);
+
+    if(BUFFER_TERMINATOR_USED(object))
+    {
+        const buffer_delimiters_t * delimiters = object->delimiters;
+
+        if(end_of_line && (delimiters->terminator[delimiters->terminator_length - 1] == c))
+        {
+            end_of_line = ((*tail & delimiters->terminator_mask) == delimiters->terminator_prefix);
+        }
+
+        *tail = (*tail << 8) | (unsigned char)c;
+    }
+
+    return end_of_line;
+}
+
+//! @brief Returns ::buffer_s::last, waits while ::buffer_region_move() replaces it
+//!
+//! @details The producer may compare a position of the previous region with the new end,
+//! ::buffer_s::producer_ptr then already points to the new region. See ::buffer_producer()
+//! for a pair of both.
+static char * buffer_last(const buffer_t * object)
+{
+    char * last = object->last;
+
+    // Only an initialized buffer is moved, the move takes a few instructions
+    while((NULL == last) && (NULL != object->data))
+    {
+        last = object->last;
+    }
+
+    return last;
+}
+
+//! @brief Stores the position of an End-Of-Line character in the side ring
+static void buffer_line_index_publish(buffer_t * object, const char * ptr)
+{
+    buffer_line_index_t * index = object->line_index;
+
+    size_t line = index->published;
+
+    index->published = line + 1;
+
+    // The entry may only be used if the consumer has passed the previous line of this entry
+    if((line - atomic_load_explicit(&index->consumed, memory_order_acquire)) < BUFFER_LINE_INDEX_ENTRIES)
+    {
+        buffer_line_index_entry_t * entry = &index->entries[line & (BUFFER_LINE_INDEX_ENTRIES - 1)];
+
+        // The character is not yet counted in the length, the buffer cannot be moved and ::buffer_s::data belongs to @p ptr
+        atomic_store_explicit(&entry->offset, (size_t)(ptr - object->data), memory_order_relaxed);
+        atomic_store_explicit(&entry->sequence, line + 1, memory_order_release);
+    }
+}
+
+//! @brief Returns ::buffer_s::producer_ptr and in @p last the ::buffer_s::last of the same region
+//!
+//! @details ::buffer_region_move() replaces both while the buffer is full. The pair is only
+//! used if the position has not changed after the end was read.
+static char * buffer_producer(const buffer_t * object, char ** last)
+{
+    char * ptr = (char *)atomic_load(&object->producer_ptr);
+
+    while(true)
+    {
+        *last = buffer_last(object);
+
+        char * check = (char *)atomic_load(&object->producer_ptr);
+
+        if(check == ptr) { return ptr; }
+
+        ptr = check;
+    }
+}
+
+//! @brief Publishes a record reserved with ::buffer_record_reserve()
+//!
+//! @details Must be called with the flag ::BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP.
+//! @p record is the start of the payload.
+static void buffer_record_publish(buffer_t * object, char * record)
+{
+    size_t n;
+    memcpy(&n, record - BUFFER_RECORD_HEADER_SIZE, BUFFER_RECORD_HEADER_SIZE);
+
+    size_t total = BUFFER_RECORD_HEADER_SIZE + n;
+
+    // The consumer removes the record with its characters as well
+    if(BUFFER_TERMINATOR_USED(object))
+    {
+        object->tail_produced = buffer_line_tail(object->tail_produced, record - BUFFER_RECORD_HEADER_SIZE, total);
+    }
+
+    BUFFER_CRC_UPDATE(object, record, n);
+    BUFFER_CRC_PUBLISH(object);
+
+    BUFFER_VERSION_BEGIN(object, producer);
+
+    // The record is published as a whole
+    size_t length = atomic_fetch_add(&object->length, total) + total;
+
+    BUFFER_VERSION_END(object, producer);
+
+    BUFFER_WATERMARK_RISE(object, length, total);
+
+    BUFFER_STATS_ADD(object, producer, ops, 1);
+    BUFFER_STATS_ADD(object, producer, bytes_in, total);
+    BUFFER_STATS_PEAK(object, length);
+    BUFFER_PROBE(set, object, length, BUFFER_PROBE_SET);
+
+    BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_DATA);
+}
+
+//! @brief Reserves a record of @p n bytes and writes its header, `NULL` if it does not fit
+//!
+//! @details Must be called with the flag ::BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP.
+//! Returns the start of the payload. The consumer cannot reset the buffer during the reservation.
+static char * buffer_record_reserve(buffer_t * object, size_t n, bool skip)
+{
+    size_t space = buffer_space(object);
+
+    // the get function can change the position but only to a smaller position the start position
+    if((BUFFER_RECORD_HEADER_SIZE <= space) && (n <= (space - BUFFER_RECORD_HEADER_SIZE)))
+    {
+        BUFFER_VERSION_BEGIN(object, producer);
+
+        char * ptr = (char *)atomic_fetch_add(&object->producer_ptr, BUFFER_RECORD_HEADER_SIZE + n);
+
+        BUFFER_VERSION_END(object, producer);
+
+        memcpy(ptr, &n, BUFFER_RECORD_HEADER_SIZE);
+
+        return ptr + BUFFER_RECORD_HEADER_SIZE;
+    }
+
+    BUFFER_STATS_ADD(object, producer, full, 1);
+
+    if(skip)
+    {
+        BUFFER_STATS_ADD(object, producer, skip, 1);
+        BUFFER_PROBE(full, object, atomic_load(&object->length), BUFFER_PROBE_SKIP);
+    }
+    else
+    {
+        BUFFER_PROBE(full, object, atomic_load(&object->length), BUFFER_PROBE_FULL);
+    }
+
+#ifdef BUFFER_ENABLE_HANDLER
+    if(object->on_full) { object->on_full(object, '\0'); }
+#endif
+
+    return NULL;
+}
+
+//! @brief Frees a list of retired regions
+static void buffer_region_free(buffer_region_t * region)
+{
+    while(NULL != region)
+    {
+        buffer_region_t * next = region->next;
+
+        free(region);
+
+        region = next;
+    }
+}
+
+//! @brief Moves the full and read empty buffer to the pending region
+//!
+//! @details Must be called by the consumer/get thread, the producer cannot write meanwhile.
+//! ::buffer_s::last is `NULL` until ::buffer_s::producer_ptr points to the new region, so
+//! that the producer does not combine the old position with the new end or vice versa.
+static bool buffer_region_move(buffer_t * object, char * ptr, buffer_region_t * region)
+{
+    char * data = (char *)(region + 1);
+    char * old_data = object->data;
+    char * old_last = object->last;
+
+    object->last = NULL;
+    object->data = data;
+
+    if(!atomic_compare_exchange_strong(&(object->producer_ptr), &ptr, data))
+    {
+        object->data = old_data;
+        object->last = old_last;
+        return false;
+    }
+
+    object->consumer_ptr = data;
+    object->last = data + region->size - 1;
+
+    buffer_region_t * retired = object->region;
+    object->region = region;
+
+    atomic_store(&object->region_pending, NULL);
+
+    buffer_region_retire(object, retired);
+
+    return true;
+}
+
+//! @brief Frees the retired regions unless a snapshot copies unread characters meanwhile
+//!
+//! @details Must be called by the producer/set thread, see: \ref buffer_grow
+static void buffer_region_reclaim(buffer_t * object)
+{
+    buffer_region_t * retired = atomic_exchange(&object->region_retired, NULL);
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    // Pairs with the fence of buffer_snapshot(), either the reader is counted here or it
+    // reads the positions of the new region
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if(0 != atomic_load(&object->versions.readers))
+    {
+        buffer_region_retire(object, retired);
+        return;
+    }
+#endif
+
+    buffer_region_free(retired);
+}
+
+//! @brief Puts a list of regions in front of ::buffer_s::region_retired
+static void buffer_region_retire(buffer_t * object, buffer_region_t * region)
+{
+    if(NULL == region) { return; }
+
+    buffer_region_t * tail = region;
+
+    while(NULL != tail->next) { tail = tail->next; }
+
+    buffer_region_t * head = atomic_load(&object->region_retired);
+    do
+    {
+        tail->next = head;
+    }
+    while(!atomic_compare_exchange_weak(&object->region_retired, &head, region));
+}
+
+//! @brief Resets the buffer to ::buffer_s::data, @p ptr is the current ::buffer_s::consumer_ptr
+//!
+//! @details Must be called by the consumer/get thread. Moves the buffer to the pending
+//! region, see: \ref buffer_grow
+//! @return Returns whether the buffer was empty and could be reset
+static bool buffer_rewind(buffer_t * object, char * ptr)
+{
+    bool rewound = false;
+    char * position = ptr;
+
+    // A missed reset of an earlier call is outdated now
+    if(NULL != atomic_load_explicit(&object->rewind_ptr, memory_order_relaxed))
+    {
+        atomic_store(&object->rewind_ptr, NULL);
+    }
+
+    BUFFER_VERSION_BEGIN(object, consumer);
+
+    // Only a full buffer is moved, the producer cannot change its position then
+    if((object->last < ptr) && (NULL != atomic_load(&object->region_pending)))
+    {
+        rewound = buffer_region_move(object, ptr, atomic_load(&object->region_pending));
+    }
+    else if(atomic_compare_exchange_strong(&(object->producer_ptr), &ptr, object->data))
+    {
+        object->consumer_ptr = object->data;
+        rewound = true;
+    }
+    else if(0 == atomic_load(&object->length))
+    {
+        // A reservation blocks the reset, the producer does it if the reservation stays unused
+        atomic_store(&object->rewind_ptr, position);
+    }
+
+    BUFFER_VERSION_END(object, consumer);
+
+    return rewound;
+}
+
+static void buffer_stats_init(buffer_t * object)
+{
+#ifdef BUFFER_ENABLE_STATS
+    atomic_init(&object->stats.producer.ops, 0);
+    atomic_init(&object->stats.producer.bytes_in, 0);
+    atomic_init(&object->stats.producer.full, 0);
+    atomic_init(&object->stats.producer.skip, 0);
+    atomic_init(&object->stats.producer.wait, 0);
+    atomic_init(&object->stats.producer.peak, 0);
+    atomic_init(&object->stats.consumer.ops, 0);
+    atomic_init(&object->stats.consumer.bytes_out, 0);
+    atomic_init(&object->stats.consumer.wait, 0);
+    atomic_init(&object->stats.consumer.resets, 0);
+#else
+    (void)object;
+#endif
+}
+
+//! @brief Returns whether the condition of a transition is fulfilled or the buffer is stopped
+static bool buffer_waiter_ready(const buffer_t * object, buffer_wait_event_t event, const buffer_waiter_t * waiter)
+{
+    if(BUFFER_FLAGS_IDLE > atomic_load(&object->state)){ return true; }
+
+    switch(event)
+    {
+        case BUFFER_WAIT_DATA:  return waiter->seen < atomic_load(&object->length);
+        case BUFFER_WAIT_LINE:  return 0 < atomic_load(&object->lines);
+        case BUFFER_WAIT_SPACE: return waiter->seen < buffer_space(object);
+        default:                return true;
+    }
+}
+
+//! @brief Disarms the waiter of a transition and calls its wake handler
+static void buffer_waiter_notify(buffer_t * object, buffer_wait_event_t event)
+{
+    buffer_waiter_t * waiter = atomic_exchange(&object->waiters[event], NULL);
+
+    if(NULL != waiter)
+    {
+        waiter->wake(waiter);
+    }
+}
+
+//! @brief Clears ::buffer_s::watermark_reached and calls the low watermark handler
+static void buffer_watermark_fall(buffer_t * object)
+{
+    if(!atomic_exchange(&object->watermark_reached, false)) { return; }
+
+#ifdef BUFFER_ENABLE_HANDLER
+    if(object->on_watermark_low) { object->on_watermark_low(object); }
+#endif
+
+    // A rising edge in the meantime has seen the flag still set
+    if((0 < object->watermark_high) && (object->watermark_high <= atomic_load(&object->length)))
+    {
+        buffer_watermark_rise(object);
+    }
+}
+
+//! @brief Sets ::buffer_s::watermark_reached and calls the high watermark handler
+static void buffer_watermark_rise(buffer_t * object)
+{
+    if(atomic_exchange(&object->watermark_reached, true)) { return; }
+
+#ifdef BUFFER_ENABLE_HANDLER
+    if(object->on_watermark_high) { object->on_watermark_high(object); }
+#endif
+
+    // A falling edge in the meantime has seen the flag still cleared
+    if(atomic_load(&object->length) <= object->watermark_low)
+    {
+        buffer_watermark_fall(object);
+    }
+}
+
 /*---------------------------------------------------------------------*
  *  public:  functions
  *---------------------------------------------------------------------*/
@@ -83,20 +911,45 @@ bool buffer_clear(buffer_t * object)
 
         size_t lines = atomic_load(&object->lines);
 
+        size_t frames = BUFFER_CRC_PUBLISHED(object);
+
+        BUFFER_VERSION_BEGIN(object, consumer);
+
         if (atomic_compare_exchange_strong(&(object->producer_ptr), &producer_ptr, object->data))
         {
             object->consumer_ptr = object->data;
+            object->tail_consumed = object->tail_produced;
+            object->removed += length;
 
-            atomic_fetch_sub(&object->length, length);
+            size_t remaining = atomic_fetch_sub(&object->length, length) - length;
 
             atomic_fetch_sub(&object->lines, lines);
 
+            BUFFER_VERSION_END(object, consumer);
+
+            BUFFER_WATERMARK_FALL(object, remaining, length);
+
+            BUFFER_LATENCY_DISCARD(object, lines);
+
+            BUFFER_LINE_INDEX_CONSUME(object, lines);
+
+            BUFFER_CRC_DISCARD(object, frames);
+
+            BUFFER_STATS_RESET(object);
+            BUFFER_PROBE(reset, object, 0, BUFFER_PROBE_RESET);
+
+            BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_SPACE);
+
 #ifdef BUFFER_ENABLE_HANDLER
             if(object->on_empty) { object->on_empty(object); }
 #endif
 
             cleared = true;
         }
+        else
+        {
+            BUFFER_VERSION_END(object, consumer);
+        }
     }
 
     atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
@@ -122,8 +975,8 @@ void buffer_copy(const buffer_t * object, buffer_t * dest)
 {
     if((NULL == object) || (NULL == dest)){ return; }
 
-    BUFFER_COPY_FIELD(object, dest, data);
-    BUFFER_COPY_FIELD(object, dest, last);
+    BUFFER_COPY_ATOMIC(object, dest, data);
+    BUFFER_COPY_ATOMIC(object, dest, last);
     BUFFER_COPY_FIELD(object, dest, end_of_line_character);
 #ifdef BUFFER_ENABLE_HANDLER
     BUFFER_COPY_FIELD(object, dest, on_start);
@@ -135,19 +988,103 @@ void buffer_copy(const buffer_t * object, buffer_t * dest)
     BUFFER_COPY_FIELD(object, dest, on_error);
     BUFFER_COPY_FIELD(object, dest, on_wait_set);
     BUFFER_COPY_FIELD(object, dest, on_wait_get);
+    BUFFER_COPY_FIELD(object, dest, on_watermark_high);
+    BUFFER_COPY_FIELD(object, dest, on_watermark_low);
 #endif
     BUFFER_COPY_FIELD(object, dest, consumer_ptr);
     BUFFER_COPY_ATOMIC(object, dest, producer_ptr);
+    BUFFER_COPY_ATOMIC(object, dest, rewind_ptr);
     BUFFER_COPY_ATOMIC(object, dest, length);
     BUFFER_COPY_ATOMIC(object, dest, lines);
     BUFFER_COPY_ATOMIC(object, dest, state);
     BUFFER_COPY_FIELD(object, dest, user_data);
+    BUFFER_COPY_FIELD(object, dest, line_index);
+    BUFFER_COPY_FIELD(object, dest, delimiters);
+    BUFFER_COPY_FIELD(object, dest, tail_produced);
+    BUFFER_COPY_FIELD(object, dest, tail_consumed);
+    BUFFER_COPY_FIELD(object, dest, removed);
+    BUFFER_COPY_ATOMIC(object, dest, waiters[BUFFER_WAIT_DATA]);
+    BUFFER_COPY_ATOMIC(object, dest, waiters[BUFFER_WAIT_LINE]);
+    BUFFER_COPY_ATOMIC(object, dest, waiters[BUFFER_WAIT_SPACE]);
+    BUFFER_COPY_FIELD(object, dest, watermark_high);
+    BUFFER_COPY_FIELD(object, dest, watermark_low);
+    BUFFER_COPY_ATOMIC(object, dest, watermark_reached);
+
+    // The regions stay owned by the original, otherwise both would free them
+    dest->region = NULL;
+    atomic_store(&dest->region_pending, NULL);
+    atomic_store(&dest->region_retired, NULL);
+
+#ifdef BUFFER_ENABLE_LATENCY
+    BUFFER_COPY_FIELD(object, dest, latency);
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+    BUFFER_COPY_FIELD(object, dest, crc);
+#endif
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    BUFFER_COPY_ATOMIC(object, dest, versions.producer);
+    BUFFER_COPY_ATOMIC(object, dest, versions.consumer);
+    atomic_store(&dest->versions.readers, 0);
+#endif
 
 }
 
 #undef BUFFER_COPY_FIELD
 #undef BUFFER_COPY_ATOMIC
 
+bool buffer_delimiters_attach(buffer_t * object, const buffer_delimiters_t * delimiters)
+{
+    if(NULL == object){ return false; }
+
+    // The counted lines belong to the previous characters
+    if(0 != atomic_load(&object->length)){ return false; }
+
+    object->delimiters = delimiters;
+
+    // A terminator does not continue over the change
+    object->tail_produced = 0;
+    object->tail_consumed = 0;
+
+    return true;
+}
+
+bool buffer_delimiters_init(buffer_delimiters_t * delimiters, const char * ends, const char * terminator)
+{
+    if(NULL == delimiters){ return false; }
+
+    size_t terminator_length = (NULL == terminator) ? 0 : strlen(terminator);
+
+    if(BUFFER_TERMINATOR_SIZE < terminator_length){ return false; }
+
+    memset(delimiters, 0, sizeof(buffer_delimiters_t));
+
+    if(0 != terminator_length) { memcpy(delimiters->terminator, terminator, terminator_length); }
+    delimiters->terminator_length = terminator_length;
+
+    size_t buckets = 0;
+
+    for(; (NULL != ends) && ('\0' != *ends); ends++)
+    {
+        buffer_delimiters_add(delimiters, *ends, &buckets);
+    }
+
+    if(0 != terminator_length)
+    {
+        char last = terminator[terminator_length - 1];
+
+        // The last character is searched, the characters in front of it are compared with the tail of the side
+        delimiters->terminator_required = (1 < terminator_length) && !BUFFER_DELIMITERS_CONTAINS(delimiters, last);
+        delimiters->terminator_prefix = buffer_line_tail(0, terminator, terminator_length - 1);
+        delimiters->terminator_mask = (1 < terminator_length) ? (UINT64_MAX >> (8 * (9 - terminator_length))) : 0;
+
+        buffer_delimiters_add(delimiters, last, &buckets);
+    }
+
+    return 0 != delimiters->count;
+}
+
 
 #ifdef BUFFER_COMPARE_FIELD
 #error BUFFER_COMPARE_FIELD must not be redefined
@@ -168,8 +1105,8 @@ bool buffer_equal(const buffer_t * object, const buffer_t * object2)
     if((NULL == object) || (NULL == object2)){ return false; }
 
     return
-        BUFFER_COMPARE_FIELD(object, object2, data) &&
-        BUFFER_COMPARE_FIELD(object, object2, last) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, data) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, last) &&
         BUFFER_COMPARE_FIELD(object, object2, end_of_line_character) &&
 #ifdef BUFFER_ENABLE_HANDLER
         BUFFER_COMPARE_FIELD(object, object2, on_start) &&
@@ -181,18 +1118,83 @@ bool buffer_equal(const buffer_t * object, const buffer_t * object2)
         BUFFER_COMPARE_FIELD(object, object2, on_error) &&
         BUFFER_COMPARE_FIELD(object, object2, on_wait_set) &&
         BUFFER_COMPARE_FIELD(object, object2, on_wait_get) &&
+        BUFFER_COMPARE_FIELD(object, object2, on_watermark_high) &&
+        BUFFER_COMPARE_FIELD(object, object2, on_watermark_low) &&
 #endif
         BUFFER_COMPARE_FIELD(object, object2, consumer_ptr) &&
         BUFFER_COMPARE_ATOMIC(object, object2, producer_ptr) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, rewind_ptr) &&
         BUFFER_COMPARE_ATOMIC(object, object2, length) &&
         BUFFER_COMPARE_ATOMIC(object, object2, lines) &&
         BUFFER_COMPARE_ATOMIC(object, object2, state) &&
+#ifdef BUFFER_ENABLE_LATENCY
+        BUFFER_COMPARE_FIELD(object, object2, latency) &&
+#endif
+#ifdef BUFFER_ENABLE_CRC
+        BUFFER_COMPARE_FIELD(object, object2, crc) &&
+#endif
+#ifdef BUFFER_ENABLE_SNAPSHOT
+        BUFFER_COMPARE_ATOMIC(object, object2, versions.producer) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, versions.consumer) &&
+#endif
+        BUFFER_COMPARE_FIELD(object, object2, line_index) &&
+        BUFFER_COMPARE_FIELD(object, object2, delimiters) &&
+        BUFFER_COMPARE_FIELD(object, object2, tail_produced) &&
+        BUFFER_COMPARE_FIELD(object, object2, tail_consumed) &&
+        BUFFER_COMPARE_FIELD(object, object2, removed) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, waiters[BUFFER_WAIT_DATA]) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, waiters[BUFFER_WAIT_LINE]) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, waiters[BUFFER_WAIT_SPACE]) &&
+        BUFFER_COMPARE_FIELD(object, object2, watermark_high) &&
+        BUFFER_COMPARE_FIELD(object, object2, watermark_low) &&
+        BUFFER_COMPARE_ATOMIC(object, object2, watermark_reached) &&
         BUFFER_COMPARE_FIELD(object, object2, user_data);
 }
 
 #undef BUFFER_COMPARE_FIELD
 #undef BUFFER_COMPARE_ATOMIC
 
+const char * buffer_find_end_of_line(const buffer_t * object, const char * ptr, size_t n)
+{
+    if((NULL == object) || (NULL == ptr) || (0 == n)){ return NULL; }
+
+    const buffer_delimiters_t * delimiters = object->delimiters;
+
+    if(NULL == delimiters){ return (const char *)memchr(ptr, object->end_of_line_character, n); }
+
+    if(1 == delimiters->count){ return (const char *)memchr(ptr, delimiters->single, n); }
+
+#ifdef BUFFER_DELIMITERS_USE_SSSE3
+    if(__builtin_cpu_supports("ssse3")){ return buffer_delimiters_scan(delimiters, ptr, n); }
+#endif
+
+    for(const char * end = ptr + n; ptr < end; ptr++)
+    {
+        if(BUFFER_DELIMITERS_CONTAINS(delimiters, *ptr)) { return ptr; }
+    }
+
+    return NULL;
+}
+
+const char * buffer_find_line_end(const buffer_t * object, uint64_t tail, const char * ptr, size_t n)
+{
+    if((NULL == object) || !BUFFER_TERMINATOR_USED(object)){ return buffer_find_end_of_line(object, ptr, n); }
+
+    const buffer_delimiters_t * delimiters = object->delimiters;
+    char last = delimiters->terminator[delimiters->terminator_length - 1];
+
+    for(const char * start = ptr, * end = ptr + n, * found; (ptr < end) && (NULL != (found = buffer_find_end_of_line(object, ptr, (size_t)(end - ptr)))); ptr = found + 1)
+    {
+        // The characters in front of the last character of the terminator can be in front of the span
+        if((last != *found) || ((buffer_line_tail(tail, start, (size_t)(found - start)) & delimiters->terminator_mask) == delimiters->terminator_prefix))
+        {
+            return found;
+        }
+    }
+
+    return NULL;
+}
+
 char buffer_get(buffer_t * object)
 {
     if(NULL == object) { return 0; }
@@ -214,6 +1216,9 @@ char buffer_get(buffer_t * object)
                     break;
                 }
 
+                BUFFER_STATS_ADD(object, consumer, wait, 1);
+                BUFFER_PROBE(wait_get, object, atomic_load(&object->length), BUFFER_PROBE_WAIT_GET);
+
 #ifdef BUFFER_ENABLE_HANDLER
                 if(object->on_wait_get)
                 {
@@ -242,13 +1247,35 @@ char buffer_get(buffer_t * object)
 
                 ptr += 1;
 
+                BUFFER_VERSION_BEGIN(object, consumer);
+
                 object->consumer_ptr = ptr;
+                object->removed += 1;
 
-                atomic_fetch_sub(&object->length, 1);
+                size_t length = atomic_fetch_sub(&object->length, 1) - 1;
 
-                if (object->end_of_line_character == c)
+                if (buffer_end_of_line_step(object, &object->tail_consumed, c))
                 {
                     atomic_fetch_sub(&object->lines, 1);
+
+                    BUFFER_LATENCY_CONSUME(object);
+
+                    BUFFER_LINE_INDEX_CONSUME(object, 1);
+
+                    BUFFER_CRC_CONSUME(object, 1);
+                }
+
+                BUFFER_VERSION_END(object, consumer);
+
+                BUFFER_WATERMARK_FALL(object, length, 1);
+
+                BUFFER_STATS_ADD(object, consumer, ops, 1);
+                BUFFER_STATS_ADD(object, consumer, bytes_out, 1);
+                BUFFER_PROBE(get, object, length, BUFFER_PROBE_GET);
+
+                if(0 == length)
+                {
+                    BUFFER_PROBE(empty, object, length, BUFFER_PROBE_EMPTY);
                 }
             }
             else
@@ -267,9 +1294,12 @@ char buffer_get(buffer_t * object)
         }
 
         // An attempt is made to reset the buffer
-        if (atomic_compare_exchange_strong(&(object->producer_ptr), &ptr, object->data))
+        if (buffer_rewind(object, ptr))
         {
-            object->consumer_ptr = object->data;
+            BUFFER_STATS_RESET(object);
+            BUFFER_PROBE(reset, object, 0, BUFFER_PROBE_RESET);
+
+            BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_SPACE);
 
 #ifdef BUFFER_ENABLE_HANDLER
             if(object->on_empty) { object->on_empty(object); }
@@ -299,19 +1329,44 @@ char buffer_get_available_or_null(buffer_t * object)
 
                 ptr += 1;
 
+                BUFFER_VERSION_BEGIN(object, consumer);
+
                 object->consumer_ptr = ptr;
+                object->removed += 1;
 
-                atomic_fetch_sub(&object->length, 1);
+                size_t length = atomic_fetch_sub(&object->length, 1) - 1;
 
-                if (object->end_of_line_character == c)
+                if (buffer_end_of_line_step(object, &object->tail_consumed, c))
                 {
                    atomic_fetch_sub(&object->lines, 1);
+
+                   BUFFER_LATENCY_CONSUME(object);
+
+                   BUFFER_LINE_INDEX_CONSUME(object, 1);
+
+                   BUFFER_CRC_CONSUME(object, 1);
+                }
+
+                BUFFER_VERSION_END(object, consumer);
+
+                BUFFER_WATERMARK_FALL(object, length, 1);
+
+                BUFFER_STATS_ADD(object, consumer, ops, 1);
+                BUFFER_STATS_ADD(object, consumer, bytes_out, 1);
+                BUFFER_PROBE(get, object, length, BUFFER_PROBE_GET);
+
+                if(0 == length)
+                {
+                    BUFFER_PROBE(empty, object, length, BUFFER_PROBE_EMPTY);
                 }
 
                 // An attempt is made to reset the buffer
-                if (atomic_compare_exchange_strong(&(object->producer_ptr), &ptr, object->data))
+                if (buffer_rewind(object, ptr))
                 {
-                    object->consumer_ptr = object->data;
+                    BUFFER_STATS_RESET(object);
+                    BUFFER_PROBE(reset, object, 0, BUFFER_PROBE_RESET);
+
+                    BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_SPACE);
 
 #ifdef BUFFER_ENABLE_HANDLER
                     if(object->on_empty) { object->on_empty(object); }
@@ -327,8 +1382,53 @@ char buffer_get_available_or_null(buffer_t * object)
         }
     }
 
-    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
-    return c;
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return c;
+}
+
+bool buffer_grow(buffer_t * object, size_t sizeof_data)
+{
+    if(NULL == object) { return false; }
+
+    buffer_region_reclaim(object);
+
+    if(NULL != atomic_load(&object->region_pending)) { return true; }
+
+    // Without a pending region the consumer does not change the data
+    if((NULL == object->data) || (sizeof_data <= (size_t)(object->last - object->data) + 1)) { return false; }
+
+    buffer_region_t * region = (buffer_region_t *)malloc(sizeof(buffer_region_t) + sizeof_data);
+
+    if(NULL == region) { return false; }
+
+    region->next = NULL;
+    region->size = sizeof_data;
+
+    atomic_store(&object->region_pending, region);
+
+    return true;
+}
+
+void buffer_grow_free(buffer_t * object)
+{
+    if(NULL == object) { return; }
+
+    buffer_stop_force(object);
+
+    buffer_region_free(atomic_exchange(&object->region_retired, NULL));
+
+    free(atomic_exchange(&object->region_pending, NULL));
+
+    if(NULL != object->region)
+    {
+        free(object->region);
+
+        object->region = NULL;
+        object->data = NULL;
+        object->last = NULL;
+        object->consumer_ptr = NULL;
+        atomic_store(&object->producer_ptr, NULL);
+    }
 }
 
 bool buffer_init(buffer_t * object, char * data, size_t sizeof_data, bool start)
@@ -361,17 +1461,56 @@ bool buffer_init(buffer_t * object, char * data, size_t sizeof_data, bool start)
     object->on_error = NULL;
     object->on_wait_set = NULL;
     object->on_wait_get = NULL;
+    object->on_watermark_high = NULL;
+    object->on_watermark_low = NULL;
 #endif
 
     object->consumer_ptr = data;
 
     atomic_init(&object->producer_ptr, data);
+    atomic_init(&object->rewind_ptr, NULL);
     atomic_init(&object->length, 0);
     atomic_init(&object->lines, 0);
     atomic_init(&object->state, 0);
 
     object->user_data = NULL;
 
+    object->line_index = NULL;
+
+    object->delimiters = NULL;
+    object->tail_produced = 0;
+    object->tail_consumed = 0;
+    object->removed = 0;
+
+    for(size_t i = 0; i < BUFFER_WAIT_EVENTS; i++)
+    {
+        atomic_init(&object->waiters[i], NULL);
+    }
+
+    object->watermark_high = 0;
+    object->watermark_low = 0;
+    atomic_init(&object->watermark_reached, false);
+
+    object->region = NULL;
+    atomic_init(&object->region_pending, NULL);
+    atomic_init(&object->region_retired, NULL);
+
+#ifdef BUFFER_ENABLE_LATENCY
+    object->latency = NULL;
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+    object->crc = NULL;
+#endif
+
+    buffer_stats_init(object);
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    atomic_init(&object->versions.producer, 0);
+    atomic_init(&object->versions.consumer, 0);
+    atomic_init(&object->versions.readers, 0);
+#endif
+
     if((NULL != data) && start)
     {
         buffer_start(object);
@@ -391,7 +1530,10 @@ bool buffer_is_full(const buffer_t * object)
 {
     if(NULL == object){ return false; }
 
-    return (char *)(atomic_load(&object->producer_ptr)) > object->last;
+    char * last;
+    char * ptr = buffer_producer(object, &last);
+
+    return ptr > last;
 }
 
 bool buffer_is_stopped(const buffer_t * object)
@@ -408,6 +1550,47 @@ size_t buffer_length(const buffer_t * object)
     return (size_t)atomic_load(&object->length);
 }
 
+bool buffer_line_index_attach(buffer_t * object, buffer_line_index_t * line_index)
+{
+    if(NULL == object){ return false; }
+
+    if(NULL != line_index)
+    {
+        for(size_t i = 0; i < BUFFER_LINE_INDEX_ENTRIES; i++)
+        {
+            atomic_init(&line_index->entries[i].sequence, 0);
+            atomic_init(&line_index->entries[i].offset, 0);
+        }
+
+        // Lines that are already in the buffer have no entry
+        line_index->published = (size_t)atomic_load(&object->lines);
+        atomic_init(&line_index->consumed, 0);
+    }
+
+    object->line_index = line_index;
+
+    return true;
+}
+
+uint64_t buffer_line_tail(uint64_t tail, const char * ptr, size_t n)
+{
+    if(NULL == ptr){ return tail; }
+
+    // Only the last characters stay in the tail
+    if(sizeof(tail) < n)
+    {
+        ptr += n - sizeof(tail);
+        n = sizeof(tail);
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        tail = (tail << 8) | (unsigned char)ptr[i];
+    }
+
+    return tail;
+}
+
 size_t buffer_lines(const buffer_t * object)
 {
     if(NULL == object){ return 0; }
@@ -438,6 +1621,56 @@ char buffer_look_available_or_null(buffer_t * object)
     return c;
 }
 
+size_t buffer_look_line(buffer_t * object, const char ** line)
+{
+    if(NULL == line) { return 0; }
+
+    *line = NULL;
+
+    if(NULL == object) { return 0; }
+
+    size_t length = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        char * ptr;
+
+        if(buffer_find_line(object, &ptr, &length))
+        {
+            *line = ptr;
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return length;
+}
+
+void buffer_notify_consumed(buffer_t * object, size_t length, size_t n, bool space)
+{
+    if((NULL == object) || (0 == n)) { return; }
+
+    BUFFER_WATERMARK_FALL(object, length, n);
+
+    if(space)
+    {
+        BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_SPACE);
+    }
+}
+
+void buffer_notify_published(buffer_t * object, size_t length, size_t n, size_t lines)
+{
+    if((NULL == object) || (0 == n)) { return; }
+
+    BUFFER_WATERMARK_RISE(object, length, n);
+
+    BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_DATA);
+
+    if(0 < lines)
+    {
+        BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_LINE);
+    }
+}
+
 buffer_t * buffer_object_allocate(char * data, size_t sizeof_data, bool start)
 {
     buffer_t * object;
@@ -463,14 +1696,268 @@ bool buffer_object_free(buffer_t * object)
 
     bool stopped = buffer_stop_force(object);
 
+    buffer_grow_free(object);
+
     free(object);
 
     return stopped;
 }
 
-size_t buffer_read(buffer_t * object, char * dest, size_t n)
-{
-    if((NULL == object) || (NULL == dest)) { return 0; }
+size_t buffer_peek_record(buffer_t * object, const void ** record)
+{
+    if(NULL == record) { return 0; }
+
+    *record = NULL;
+
+    if(NULL == object) { return 0; }
+
+    size_t length = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        char * ptr;
+
+        if(buffer_find_record(object, &ptr, &length))
+        {
+            *record = ptr;
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return length;
+}
+
+size_t buffer_pop_record(buffer_t * object, void * dest, size_t n)
+{
+    if(NULL == object) { return 0; }
+
+    size_t length = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        char * ptr;
+
+        if(buffer_find_record(object, &ptr, &length))
+        {
+            if(NULL == dest)
+            {
+                BUFFER_CRC_CONSUME(object, 1);
+                buffer_consume_span(object, object->consumer_ptr, BUFFER_RECORD_HEADER_SIZE + length, 0);
+            }
+            else if(length <= n)
+            {
+                memcpy(dest, ptr, length);
+                BUFFER_CRC_CONSUME(object, 1);
+                buffer_consume_span(object, object->consumer_ptr, BUFFER_RECORD_HEADER_SIZE + length, 0);
+            }
+            else
+            {
+                length = 0; // Does not fit, the record remains
+            }
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return length;
+}
+
+size_t buffer_pop_records(buffer_t * object, size_t n, size_t records)
+{
+    if(NULL == object) { return 0; }
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        // The records are published as a whole, more bytes can only be passed by mistake
+        if(atomic_load(&object->length) < n) { n = 0; }
+
+        if(0 < n)
+        {
+            BUFFER_CRC_CONSUME(object, records);
+            buffer_consume_span(object, object->consumer_ptr, n, 0);
+        }
+    }
+    else
+    {
+        n = 0;
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return n;
+}
+
+bool buffer_push_record(buffer_t * object, const void * src, size_t n)
+{
+    // A record of 0 bytes could not be told apart from no record by the consumer
+    if((NULL == object) || (NULL == src) || (0 == n)) { return false; }
+
+    bool saved = false;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
+    {
+        char * ptr = buffer_record_reserve(object, n, true);
+
+        if(NULL != ptr)
+        {
+            memcpy(ptr, src, n);
+
+            buffer_record_publish(object, ptr);
+
+            saved = true;
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return saved;
+}
+
+bool buffer_push_record_commit(buffer_t * object, void * record)
+{
+    if((NULL == object) || (NULL == record)) { return false; }
+
+    bool saved = false;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
+    {
+        buffer_record_publish(object, (char *)record);
+
+        saved = true;
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return saved;
+}
+
+void * buffer_push_record_reserve(buffer_t * object, size_t n)
+{
+    if((NULL == object) || (0 == n)) { return NULL; }
+
+    char * ptr = NULL;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
+    {
+        ptr = buffer_record_reserve(object, n, false);
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return ptr;
+}
+
+size_t buffer_read(buffer_t * object, char * dest, size_t n)
+{
+    if((NULL == object) || (NULL == dest)) { return 0; }
+
+    --n;
+    char c;
+    size_t i;
+    for(i = 0; i < n; dest++, i++)
+    {
+        c = buffer_get_available_or_null(object);
+
+        if('\0' == c)
+        {
+            break;
+        }
+
+        *dest = c;
+    }
+    *dest = '\0';
+
+    return i;
+}
+
+size_t buffer_read_consume(buffer_t * object, size_t n)
+{
+    if(NULL == object) { return 0; }
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        size_t length = atomic_load(&object->length);
+
+        if(length < n) { n = length; }
+
+        if(0 < n)
+        {
+            char * ptr = object->consumer_ptr;
+
+            buffer_consume_span(object, ptr, n, buffer_count_lines(object, object->tail_consumed, ptr, n));
+        }
+    }
+    else
+    {
+        n = 0;
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return n;
+}
+
+size_t buffer_read_line(buffer_t * object, char * dest, size_t n)
+{
+    if((NULL == object) ||
+       (0 == atomic_load(&object->lines)) ||
+       (NULL == dest))
+    {
+        return 0;
+    }
+
+    if((0 < n) && ((NULL != object->line_index) || (NULL != object->delimiters)))
+    {
+        bool found = false;
+
+        size_t length = 0;
+
+        if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+        {
+            char * ptr;
+
+            found = buffer_find_line(object, &ptr, &length);
+
+            if(found)
+            {
+                --n;
+
+                size_t copy = length;
+                const buffer_delimiters_t * delimiters = object->delimiters;
+
+                // The characters in front of the last character of the terminator are removed with
+                // it, those of them that were already removed are not part of the line
+                if((NULL != delimiters) && (1 < delimiters->terminator_length) &&
+                   (delimiters->terminator[delimiters->terminator_length - 1] == ptr[length]))
+                {
+                    size_t prefix = delimiters->terminator_length - 1;
+
+                    if(delimiters->terminator_required)
+                    {
+                        copy = (prefix < length) ? (length - prefix) : 0;
+                    }
+                    else if((prefix <= length) && (0 == memcmp(ptr + length - prefix, delimiters->terminator, prefix)))
+                    {
+                        copy = length - prefix;
+                    }
+                }
+
+                // The End-Of-Line character is only removed if the whole line fits
+                if(copy < n)
+                {
+                    memcpy(dest, ptr, copy);
+                    buffer_consume_span(object, ptr, length + 1, 1);
+                    length = copy;
+                }
+                else
+                {
+                    length = n;
+                    memcpy(dest, ptr, length);
+                    buffer_consume_span(object, ptr, length, 0);
+                }
+
+                dest[length] = '\0';
+            }
+        }
+
+        atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+
+        if(found) { return length; }
+    }
 
     --n;
     char c;
@@ -479,7 +1966,7 @@ size_t buffer_read(buffer_t * object, char * dest, size_t n)
     {
         c = buffer_get_available_or_null(object);
 
-        if('\0' == c)
+        if(('\0' == c) || BUFFER_IS_END_OF_LINE(object, c))
         {
             break;
         }
@@ -491,33 +1978,28 @@ size_t buffer_read(buffer_t * object, char * dest, size_t n)
     return i;
 }
 
-size_t buffer_read_line(buffer_t * object, char * dest, size_t n)
+size_t buffer_read_span(buffer_t * object, const char ** span)
 {
-    if((NULL == object) ||
-       (0 == atomic_load(&object->lines)) ||
-       (NULL == dest))
-    {
-        return 0;
-    }
+    if(NULL == span) { return 0; }
 
-    --n;
-    char c;
-    char eol = object->end_of_line_character;
-    size_t i;
-    for(i = 0; i < n; dest++, i++)
+    *span = NULL;
+
+    if(NULL == object) { return 0; }
+
+    size_t length = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
     {
-        c = buffer_get_available_or_null(object);
+        length = atomic_load(&object->length);
 
-        if(('\0' == c) || (eol == c))
+        if(0 < length)
         {
-            break;
+            *span = object->consumer_ptr;
         }
-
-        *dest = c;
     }
-    *dest = '\0';
 
-    return i;
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return length;
 }
 
 size_t buffer_read_to(buffer_t * object, char * dest, size_t n, const char * to, size_t to_length)
@@ -585,15 +2067,46 @@ bool buffer_reset(buffer_t * object, bool start)
     object->on_error = NULL;
     object->on_wait_set = NULL;
     object->on_wait_get = NULL;
+    object->on_watermark_high = NULL;
+    object->on_watermark_low = NULL;
 #endif
 
     object->consumer_ptr = object->data;
+    object->tail_produced = 0;
+    object->tail_consumed = 0;
+    object->removed = 0;
 
     atomic_init(&object->producer_ptr, object->data);
+    atomic_init(&object->rewind_ptr, NULL);
     atomic_init(&object->length, 0);
     atomic_init(&object->lines, 0);
     atomic_init(&object->state, 0);
 
+    for(size_t i = 0; i < BUFFER_WAIT_EVENTS; i++)
+    {
+        atomic_init(&object->waiters[i], NULL);
+    }
+
+    atomic_init(&object->watermark_reached, false);
+
+    buffer_stats_init(object);
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    atomic_init(&object->versions.producer, 0);
+    atomic_init(&object->versions.consumer, 0);
+    atomic_init(&object->versions.readers, 0);
+#endif
+
+    buffer_line_index_attach(object, object->line_index);
+
+#ifdef BUFFER_ENABLE_LATENCY
+    buffer_latency_attach(object, object->latency);
+#endif
+
+#ifdef BUFFER_ENABLE_CRC
+    buffer_crc_attach(object, object->crc);
+#endif
+
     if((NULL != object->data) && start)
     {
         buffer_start(object);
@@ -607,27 +2120,60 @@ bool buffer_set(buffer_t * object, char c)
     if(NULL == object) { return false; }
 
     bool saved = false;
+    bool full = false;
 
     if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET))
     {
         while(true)
         {
             // the get function can change the position but only to a smaller position the start position
-            if((char *)atomic_load(&object->producer_ptr) <= object->last)
+            if((char *)atomic_load(&object->producer_ptr) <= buffer_last(object))
             {
-                *(char *)atomic_fetch_add(&object->producer_ptr, 1) = c;
+                BUFFER_VERSION_BEGIN(object, producer);
 
-                if (object->end_of_line_character == c)
+                char * ptr = (char *)atomic_fetch_add(&object->producer_ptr, 1);
+
+                *ptr = c;
+
+                bool end_of_line = buffer_end_of_line_step(object, &object->tail_produced, c);
+
+                if (end_of_line)
                 {
+                    BUFFER_LINE_INDEX_PUBLISH(object, ptr);
+
+                    BUFFER_LATENCY_PUBLISH(object);
+
+                    BUFFER_CRC_PUBLISH(object);
+
                     atomic_fetch_add(&object->lines, 1);
                 }
+                else
+                {
+                    BUFFER_CRC_UPDATE(object, &c, 1);
+                }
 
-                atomic_fetch_add(&object->length, 1);
+                size_t length = atomic_fetch_add(&object->length, 1) + 1;
+
+                BUFFER_VERSION_END(object, producer);
+
+                BUFFER_WATERMARK_RISE(object, length, 1);
+
+                BUFFER_STATS_ADD(object, producer, ops, 1);
+                BUFFER_STATS_ADD(object, producer, bytes_in, 1);
+                BUFFER_STATS_PEAK(object, length);
+                BUFFER_PROBE(set, object, length, BUFFER_PROBE_SET);
+
+                BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_DATA);
+
+                if (end_of_line)
+                {
+                    BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_LINE);
+                }
 
 #ifdef BUFFER_ENABLE_HANDLER
                 if(object->on_new_character) { object->on_new_character(object, c); }
 
-                if(object->end_of_line_character == c)
+                if(end_of_line)
                 {
                     if(object->on_new_line) { object->on_new_line(object); }
                 }
@@ -637,6 +2183,16 @@ bool buffer_set(buffer_t * object, char c)
             }
             else
             {
+                if(!full)
+                {
+                    full = true;
+                    BUFFER_STATS_ADD(object, producer, full, 1);
+                    BUFFER_PROBE(full, object, atomic_load(&object->length), BUFFER_PROBE_FULL);
+                }
+
+                BUFFER_STATS_ADD(object, producer, wait, 1);
+                BUFFER_PROBE(wait_set, object, atomic_load(&object->length), BUFFER_PROBE_WAIT_SET);
+
 #ifdef BUFFER_ENABLE_HANDLER
                 if(object->on_full) { object->on_full(object, c); }
 
@@ -674,22 +2230,54 @@ bool buffer_set_possible_or_skip(buffer_t * object, char c)
     if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
     {
         // the get function can change the position but only to a smaller position the start position
-        if((char *)atomic_load(&object->producer_ptr) <= object->last)
+        if((char *)atomic_load(&object->producer_ptr) <= buffer_last(object))
         {
-            *(char *)atomic_fetch_add(&object->producer_ptr, 1) = c;
+            BUFFER_VERSION_BEGIN(object, producer);
+
+            char * ptr = (char *)atomic_fetch_add(&object->producer_ptr, 1);
 
-            if (object->end_of_line_character == c)
+            *ptr = c;
+
+            bool end_of_line = buffer_end_of_line_step(object, &object->tail_produced, c);
+
+            if (end_of_line)
             {
+                BUFFER_LINE_INDEX_PUBLISH(object, ptr);
+
+                BUFFER_LATENCY_PUBLISH(object);
+
+                BUFFER_CRC_PUBLISH(object);
+
                 atomic_fetch_add(&object->lines, 1);
             }
+            else
+            {
+                BUFFER_CRC_UPDATE(object, &c, 1);
+            }
+
+            size_t length = atomic_fetch_add(&object->length, 1) + 1;
+
+            BUFFER_VERSION_END(object, producer);
+
+            BUFFER_WATERMARK_RISE(object, length, 1);
+
+            BUFFER_STATS_ADD(object, producer, ops, 1);
+            BUFFER_STATS_ADD(object, producer, bytes_in, 1);
+            BUFFER_STATS_PEAK(object, length);
+            BUFFER_PROBE(set, object, length, BUFFER_PROBE_SET);
 
-            atomic_fetch_add(&object->length, 1);
+            BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_DATA);
+
+            if (end_of_line)
+            {
+                BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_LINE);
+            }
 
 #ifdef BUFFER_ENABLE_HANDLER
 
             if(object->on_new_character) { object->on_new_character(object, c); }
 
-            if(object->end_of_line_character == c)
+            if(end_of_line)
             {
                 if(object->on_new_line) { object->on_new_line(object); }
             }
@@ -699,6 +2287,10 @@ bool buffer_set_possible_or_skip(buffer_t * object, char c)
         }
         else
         {
+            BUFFER_STATS_ADD(object, producer, full, 1);
+            BUFFER_STATS_ADD(object, producer, skip, 1);
+            BUFFER_PROBE(full, object, atomic_load(&object->length), BUFFER_PROBE_SKIP);
+
 #ifdef BUFFER_ENABLE_HANDLER
             if(object->on_full) { object->on_full(object, c); }
 #endif
@@ -709,18 +2301,119 @@ bool buffer_set_possible_or_skip(buffer_t * object, char c)
     return saved;
 }
 
+bool buffer_skip_line(buffer_t * object)
+{
+    if(NULL == object) { return false; }
+
+    bool skipped = false;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        char * ptr;
+        size_t length;
+
+        if(buffer_find_line(object, &ptr, &length))
+        {
+            buffer_consume_span(object, ptr, length + 1, 1);
+
+            skipped = true;
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return skipped;
+}
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+bool buffer_snapshot(const buffer_t * object, buffer_snapshot_t * dest, char * unread, size_t n)
+{
+    if((NULL == object) || (NULL == dest) || ((NULL == unread) && (0 != n))) { return false; }
+
+    // The readers are the only element a snapshot writes, ::buffer_grow() keeps the regions meanwhile
+    volatile _Atomic(size_t) * readers = (volatile _Atomic(size_t) *)&object->versions.readers;
+
+    if(0 != n)
+    {
+        atomic_fetch_add(readers, 1);
+
+        // Pairs with the fence of buffer_region_reclaim()
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+
+    bool consistent = false;
+
+    for(size_t attempt = 0; !consistent && (attempt < BUFFER_SNAPSHOT_RETRIES); attempt++)
+    {
+        size_t producer = atomic_load_explicit(&object->versions.producer, memory_order_acquire);
+        size_t consumer = atomic_load_explicit(&object->versions.consumer, memory_order_acquire);
+
+        // A side is changing the metadata
+        if(0 != ((producer | consumer) & 1)) { continue; }
+
+        char * data = (char *)atomic_load_explicit(&object->data, memory_order_relaxed);
+        char * last = (char *)atomic_load_explicit(&object->last, memory_order_relaxed);
+        char * producer_ptr = (char *)atomic_load_explicit(&object->producer_ptr, memory_order_relaxed);
+        char * consumer_ptr = object->consumer_ptr;
+        size_t length = atomic_load_explicit(&object->length, memory_order_relaxed);
+        size_t lines = atomic_load_explicit(&object->lines, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+
+        if((producer != atomic_load_explicit(&object->versions.producer, memory_order_relaxed)) ||
+           (consumer != atomic_load_explicit(&object->versions.consumer, memory_order_relaxed)))
+        {
+            continue;
+        }
+
+        size_t copied = 0;
+
+        if((NULL != data) && (0 != n))
+        {
+            copied = (length < n) ? length : n;
+
+            // The unread characters are not changed by the producer until the consumer resets the
+            // buffer, a replaced region is not freed until the readers are zero
+            memcpy(unread, consumer_ptr, copied);
+
+            atomic_thread_fence(memory_order_acquire);
+
+            if(consumer != atomic_load_explicit(&object->versions.consumer, memory_order_relaxed)) { continue; }
+        }
+
+        dest->capacity = (NULL == data) ? 0 : (size_t)(last - data + 1);
+        dest->consumer_offset = (NULL == data) ? 0 : (size_t)(consumer_ptr - data);
+        dest->producer_offset = (NULL == data) ? 0 : (size_t)(producer_ptr - data);
+        dest->length = length;
+        dest->lines = lines;
+        dest->copied = copied;
+        dest->producer_version = producer;
+        dest->consumer_version = consumer;
+        dest->state = atomic_load(&object->state);
+
+        consistent = true;
+    }
+
+    if(0 != n) { atomic_fetch_sub_explicit(readers, 1, memory_order_release); }
+
+    return consistent;
+}
+
+#endif
+
 size_t buffer_space(const buffer_t * object)
 {
     if(NULL == object){ return 0; }
 
-	char * producer_ptr = (char *)atomic_load(&object->producer_ptr);
-	if(object->last < producer_ptr)
+	char * last;
+	char * producer_ptr = buffer_producer(object, &last);
+	if(last < producer_ptr)
 	{
 		return 0;
 	}
 	else
 	{
-		return (size_t)(object->last + 1 - producer_ptr);
+		return (size_t)(last + 1 - producer_ptr);
 	}
 }
 
@@ -741,12 +2434,38 @@ bool buffer_start(buffer_t * object)
     return false;
 }
 
+#ifdef BUFFER_ENABLE_STATS
+
+void buffer_stats_snapshot(const buffer_t * object, buffer_stats_snapshot_t * dest)
+{
+    if((NULL == object) || (NULL == dest)){ return; }
+
+    dest->set_ops   = atomic_load_explicit(&object->stats.producer.ops,       memory_order_relaxed);
+    dest->bytes_in  = atomic_load_explicit(&object->stats.producer.bytes_in,  memory_order_relaxed);
+    dest->full      = atomic_load_explicit(&object->stats.producer.full,      memory_order_relaxed);
+    dest->skip      = atomic_load_explicit(&object->stats.producer.skip,      memory_order_relaxed);
+    dest->wait_set  = atomic_load_explicit(&object->stats.producer.wait,      memory_order_relaxed);
+    dest->peak      = atomic_load_explicit(&object->stats.producer.peak,      memory_order_relaxed);
+    dest->get_ops   = atomic_load_explicit(&object->stats.consumer.ops,       memory_order_relaxed);
+    dest->bytes_out = atomic_load_explicit(&object->stats.consumer.bytes_out, memory_order_relaxed);
+    dest->wait_get  = atomic_load_explicit(&object->stats.consumer.wait,      memory_order_relaxed);
+    dest->resets    = atomic_load_explicit(&object->stats.consumer.resets,    memory_order_relaxed);
+}
+
+#endif
+
 bool buffer_stop_force(buffer_t * object)
 {
     if(NULL == object){ return false; }
 
     buffer_falgs_t state = (buffer_falgs_t)atomic_fetch_and(&object->state, ~BUFFER_FLAGS_IDLE);
 
+    // All waiters see the stopped buffer
+    for(size_t i = 0; i < BUFFER_WAIT_EVENTS; i++)
+    {
+        BUFFER_WAITER_NOTIFY(object, (buffer_wait_event_t)i);
+    }
+
     if(BUFFER_FLAGS_STOP == state)
     {
 #ifdef BUFFER_ENABLE_HANDLER
@@ -776,6 +2495,11 @@ bool buffer_stop_try(buffer_t * object)
     {
         if (atomic_compare_exchange_strong(&(object->state), (_Atomic(unsigned char) *)&state, BUFFER_FLAGS_STOP))
         {
+            for(size_t i = 0; i < BUFFER_WAIT_EVENTS; i++)
+            {
+                BUFFER_WAITER_NOTIFY(object, (buffer_wait_event_t)i);
+            }
+
 #ifdef BUFFER_ENABLE_HANDLER
             if(object->on_stop) { object->on_stop(object); }
 #endif
@@ -786,6 +2510,74 @@ bool buffer_stop_try(buffer_t * object)
     return false;
 }
 
+bool buffer_waiter_arm(buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter)
+{
+    if((NULL == object) || (NULL == waiter) || (NULL == waiter->wake) || (BUFFER_WAIT_EVENTS <= event)) { return false; }
+
+    if(buffer_waiter_ready(object, event, waiter)) { return false; }
+
+    atomic_store(&object->waiters[event], waiter);
+
+    // A transition in the meantime has either seen the waiter or is seen here
+    if(buffer_waiter_ready(object, event, waiter))
+    {
+        return !buffer_waiter_cancel(object, event, waiter);
+    }
+
+    return true;
+}
+
+bool buffer_waiter_cancel(buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter)
+{
+    if((NULL == object) || (NULL == waiter) || (BUFFER_WAIT_EVENTS <= event)) { return false; }
+
+    buffer_waiter_t * expected = waiter;
+
+    return atomic_compare_exchange_strong(&object->waiters[event], &expected, NULL);
+}
+
+bool buffer_watermark(buffer_t * object, size_t low, size_t high)
+{
+    if(NULL == object) { return false; }
+
+    char * data;
+    char * last;
+
+    // The start and the end of the same region, see ::buffer_region_move()
+    do
+    {
+        data = object->data;
+        last = buffer_last(object);
+    }
+    while(data != object->data);
+
+    if((0 != high) && ((high <= low) || (NULL == data) || (((size_t)(last - data) + 1) < high)))
+    {
+        return false;
+    }
+
+    object->watermark_low = low;
+    object->watermark_high = high;
+
+    if(0 == high)
+    {
+        atomic_store(&object->watermark_reached, false);
+    }
+    else if(high <= atomic_load(&object->length))
+    {
+        buffer_watermark_rise(object);
+    }
+
+    return true;
+}
+
+bool buffer_watermark_is_high(const buffer_t * object)
+{
+    if(NULL == object) { return false; }
+
+    return atomic_load(&object->watermark_reached);
+}
+
 size_t buffer_write(buffer_t * object, const char *src, size_t n)
 {
     if((NULL == object) || (NULL == src)) { return 0; }
@@ -803,6 +2595,158 @@ size_t buffer_write(buffer_t * object, const char *src, size_t n)
     return i;
 }
 
+size_t buffer_write_commit(buffer_t * object, char * span, size_t n)
+{
+    if((NULL == object) || (NULL == span)) { return 0; }
+
+    bool running = (BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP));
+
+    if(!running) { n = 0; }
+
+    size_t lines = 0;
+    char * end = span + n;
+    char * frame = span;
+    uint64_t tail = object->tail_produced;
+
+    // The consumer cannot reset the buffer during the reservation, the lines are counted before it is released
+    for(char * ptr = span; (ptr < end) && (NULL != (ptr = (char *)buffer_find_line_end(object, buffer_line_tail(tail, span, (size_t)(ptr - span)), ptr, (size_t)(end - ptr)))); ptr++)
+    {
+        BUFFER_LINE_INDEX_PUBLISH(object, ptr);
+
+        BUFFER_LATENCY_PUBLISH(object);
+
+        BUFFER_CRC_UPDATE(object, frame, (size_t)(ptr - frame));
+        BUFFER_CRC_PUBLISH(object);
+        frame = ptr + 1;
+
+        lines++;
+    }
+
+    BUFFER_CRC_UPDATE(object, frame, (size_t)(end - frame));
+
+    if(BUFFER_TERMINATOR_USED(object))
+    {
+        object->tail_produced = buffer_line_tail(tail, span, n);
+    }
+
+    BUFFER_VERSION_BEGIN(object, producer);
+
+    // The unused part of the reservation is released
+    atomic_store(&object->producer_ptr, end);
+
+    if(0 < n)
+    {
+        if(0 < lines)
+        {
+            atomic_fetch_add(&object->lines, lines);
+        }
+
+        size_t length = atomic_fetch_add(&object->length, n) + n;
+
+        BUFFER_VERSION_END(object, producer);
+
+        BUFFER_WATERMARK_RISE(object, length, n);
+
+        BUFFER_STATS_ADD(object, producer, ops, 1);
+        BUFFER_STATS_ADD(object, producer, bytes_in, n);
+        BUFFER_STATS_PEAK(object, length);
+        BUFFER_PROBE(set, object, length, BUFFER_PROBE_SET);
+
+        BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_DATA);
+
+        if(0 < lines)
+        {
+            BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_LINE);
+        }
+
+#ifdef BUFFER_ENABLE_HANDLER
+        if(object->on_new_character)
+        {
+            for(size_t i = 0; i < n; i++)
+            {
+                object->on_new_character(object, span[i]);
+            }
+        }
+
+        if(object->on_new_line)
+        {
+            for(size_t i = 0; i < lines; i++)
+            {
+                object->on_new_line(object);
+            }
+        }
+#endif
+    }
+    else
+    {
+        // The consumer has read the buffer empty during the reservation and left the reset to
+        // the producer, it does not use its position until new characters are published
+        char * position = span;
+        bool rewound = running && (span == atomic_exchange(&object->rewind_ptr, NULL)) &&
+                       (0 == atomic_load(&object->length)) &&
+                       atomic_compare_exchange_strong(&(object->producer_ptr), &position, object->data);
+
+        if(rewound)
+        {
+            object->consumer_ptr = object->data;
+        }
+
+        BUFFER_VERSION_END(object, producer);
+
+        if(rewound)
+        {
+            BUFFER_STATS_RESET(object);
+            BUFFER_PROBE(reset, object, 0, BUFFER_PROBE_RESET);
+
+            BUFFER_WAITER_NOTIFY(object, BUFFER_WAIT_SPACE);
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return n;
+}
+
+size_t buffer_write_reserve(buffer_t * object, char ** span)
+{
+    if(NULL == span) { return 0; }
+
+    *span = NULL;
+
+    if(NULL == object) { return 0; }
+
+    size_t space = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
+    {
+        space = buffer_space(object);
+
+        if(0 < space)
+        {
+            BUFFER_VERSION_BEGIN(object, producer);
+
+            // the get function can change the position but only to a smaller position the start position
+            char * ptr = (char *)atomic_fetch_add(&object->producer_ptr, space);
+
+            BUFFER_VERSION_END(object, producer);
+
+            // A reset in the meantime gives more space, only the known part is used
+            *span = ptr;
+        }
+        else
+        {
+            BUFFER_STATS_ADD(object, producer, full, 1);
+            BUFFER_PROBE(full, object, atomic_load(&object->length), BUFFER_PROBE_FULL);
+
+#ifdef BUFFER_ENABLE_HANDLER
+            if(object->on_full) { object->on_full(object, '\0'); }
+#endif
+        }
+    }
+
+    atomic_fetch_sub(&object->state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return space;
+}
+
 /*---------------------------------------------------------------------*
  *  eof
  *---------------------------------------------------------------------*/
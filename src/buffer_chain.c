@@ -0,0 +1,493 @@
+//! @file
+//! @brief The buffer chunk chain source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_chain.h"
+
+#include <string.h> // memchr, memcpy
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+#if (0 != (BUFFER_CHUNK_ALIGNMENT & (BUFFER_CHUNK_ALIGNMENT - 1)))
+#error BUFFER_CHUNK_ALIGNMENT must be a power of two
+#endif
+
+//! @brief Rounds @p N up to a multiple of ::BUFFER_CHUNK_ALIGNMENT
+#define BUFFER_CHUNK_ALIGN(N) (((N) + (BUFFER_CHUNK_ALIGNMENT - 1)) & ~((size_t)BUFFER_CHUNK_ALIGNMENT - 1))
+
+//! @brief Offset of the characters within a chunk
+#define BUFFER_CHUNK_DATA_OFFSET BUFFER_CHUNK_ALIGN(sizeof(buffer_chunk_t))
+
+//! @brief Returns the characters of a chunk
+#define BUFFER_CHUNK_DATA(CHUNK) ((char *)(CHUNK) + BUFFER_CHUNK_DATA_OFFSET)
+
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_chain_sc buffer_chain =
+{
+    buffer_chain_chunks,
+    buffer_chain_exit,
+    buffer_chain_get,
+    buffer_chain_init,
+    buffer_chunk_pool_available,
+    buffer_chunk_pool_init,
+    buffer_chain_read,
+    buffer_chain_read_line,
+    buffer_chain_set,
+    buffer_chain_write,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static bool buffer_chain_grow(buffer_chain_t * object);
+static size_t buffer_chain_take(buffer_chain_t * object, char * dest, size_t n, bool line);
+static buffer_chunk_t * buffer_chunk_at(const buffer_chunk_pool_t * pool, uint32_t position);
+static buffer_chunk_t * buffer_chunk_pool_pop(buffer_chunk_pool_t * pool);
+static void buffer_chunk_pool_push(buffer_chunk_pool_t * pool, buffer_chunk_t * chunk);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Appends a chunk of the pool, only used by the producer/set thread
+static bool buffer_chain_grow(buffer_chain_t * object)
+{
+    if(object->max_chunks <= atomic_load(&object->chunks)) { return false; }
+
+    buffer_chunk_t * chunk = buffer_chunk_pool_pop(object->pool);
+
+    if(NULL == chunk) { return false; }
+
+    atomic_store_explicit(&chunk->next, NULL, memory_order_relaxed);
+
+    atomic_fetch_add(&object->chunks, 1);
+
+    // The consumer only follows the link after the characters behind it were published
+    atomic_store_explicit(&object->tail->next, chunk, memory_order_release);
+
+    object->tail = chunk;
+    object->tail_offset = 0;
+
+    return true;
+}
+
+//! @brief Copies and removes up to @p n characters, only used by the consumer/get thread
+//!
+//! @details Must be called with the flag ::BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL.
+//! With @p line it stops behind the first End-Of-Line character, which is removed but not copied.
+//! @return Returns the number of copied characters
+static size_t buffer_chain_take(buffer_chain_t * object, char * dest, size_t n, bool line)
+{
+    size_t available = atomic_load(&object->buffer.length);
+
+    if(available < n) { n = available; }
+
+    size_t chunk_size = object->pool->chunk_size;
+    size_t copied = 0;
+    size_t removed = 0;
+    size_t lines = 0;
+
+    while(removed < n)
+    {
+        // The next chunk is linked, it holds the characters that are still available
+        if(chunk_size == object->head_offset)
+        {
+            buffer_chunk_t * chunk = object->head;
+
+            object->head = atomic_load_explicit(&chunk->next, memory_order_acquire);
+            object->head_offset = 0;
+
+            atomic_fetch_sub(&object->chunks, 1);
+
+            buffer_chunk_pool_push(object->pool, chunk);
+        }
+
+        char * ptr = BUFFER_CHUNK_DATA(object->head) + object->head_offset;
+
+        size_t length = chunk_size - object->head_offset;
+
+        if((n - removed) < length) { length = n - removed; }
+
+        uint64_t tail = object->buffer.tail_consumed;
+        char * found = (char *)buffer_find_line_end(&object->buffer, tail, ptr, length);
+
+        if(line && (NULL != found))
+        {
+            length = (size_t)(found - ptr);
+
+            memcpy(dest + copied, ptr, length);
+
+            object->buffer.tail_consumed = buffer_line_tail(tail, ptr, length + 1);
+
+            copied += length;
+            removed += length + 1;
+            object->head_offset += length + 1;
+            lines++;
+            break;
+        }
+
+        memcpy(dest + copied, ptr, length);
+
+        while(NULL != found)
+        {
+            lines++;
+            found = (char *)buffer_find_line_end(&object->buffer, buffer_line_tail(tail, ptr, (size_t)(found + 1 - ptr)), found + 1, length - (size_t)(found + 1 - ptr));
+        }
+
+        object->buffer.tail_consumed = buffer_line_tail(tail, ptr, length);
+
+        copied += length;
+        removed += length;
+        object->head_offset += length;
+    }
+
+    if(0 == removed) { return 0; }
+
+    if(0 < lines)
+    {
+        atomic_fetch_sub(&object->buffer.lines, lines);
+    }
+
+    object->buffer.removed += removed;
+
+    size_t length = atomic_fetch_sub(&object->buffer.length, removed) - removed;
+
+    buffer_notify_consumed(&object->buffer, length, removed, false);
+
+#ifdef BUFFER_ENABLE_HANDLER
+    if((0 == length) && object->buffer.on_empty) { object->buffer.on_empty(&object->buffer); }
+#endif
+
+    return copied;
+}
+
+static buffer_chunk_t * buffer_chunk_at(const buffer_chunk_pool_t * pool, uint32_t position)
+{
+    return (buffer_chunk_t *)(pool->chunks + ((size_t)position * pool->stride));
+}
+
+//! @brief Takes a chunk from the pool, `NULL` if the pool is empty
+static buffer_chunk_t * buffer_chunk_pool_pop(buffer_chunk_pool_t * pool)
+{
+    uint64_t top = atomic_load(&pool->free);
+    buffer_chunk_t * chunk;
+
+    do
+    {
+        uint32_t position = (uint32_t)top;
+
+        if(0 == position) { return NULL; }
+
+        chunk = buffer_chunk_at(pool, position - 1);
+
+        // The value may be outdated if the chunk was taken in the meantime, the tag then differs
+        uint64_t next = atomic_load_explicit(&chunk->free_next, memory_order_relaxed);
+
+        if(atomic_compare_exchange_weak(&pool->free, &top, (((top >> 32) + 1) << 32) | next))
+        {
+            break;
+        }
+    }
+    while(true);
+
+    atomic_fetch_sub(&pool->available, 1);
+
+    return chunk;
+}
+
+//! @brief Returns a chunk to the pool
+static void buffer_chunk_pool_push(buffer_chunk_pool_t * pool, buffer_chunk_t * chunk)
+{
+    uint64_t position = (uint64_t)(((char *)chunk - pool->chunks) / pool->stride) + 1;
+
+    uint64_t top = atomic_load(&pool->free);
+
+    do
+    {
+        atomic_store_explicit(&chunk->free_next, (uint32_t)top, memory_order_relaxed);
+    }
+    while(!atomic_compare_exchange_weak(&pool->free, &top, (((top >> 32) + 1) << 32) | position));
+
+    atomic_fetch_add(&pool->available, 1);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+size_t buffer_chain_chunks(const buffer_chain_t * object)
+{
+    if(NULL == object) { return 0; }
+
+    return atomic_load(&object->chunks);
+}
+
+void buffer_chain_exit(buffer_chain_t * object)
+{
+    if((NULL == object) || (NULL == object->head)) { return; }
+
+    buffer_stop_force(&object->buffer);
+
+    buffer_chunk_t * chunk = object->head;
+
+    while(NULL != chunk)
+    {
+        buffer_chunk_t * next = atomic_load(&chunk->next);
+
+        buffer_chunk_pool_push(object->pool, chunk);
+
+        chunk = next;
+    }
+
+    object->head = NULL;
+    object->tail = NULL;
+    atomic_store(&object->chunks, 0);
+    atomic_store(&object->buffer.length, 0);
+    atomic_store(&object->buffer.lines, 0);
+
+    // The characters in front of a terminator were removed
+    object->buffer.tail_produced = 0;
+    object->buffer.tail_consumed = 0;
+}
+
+char buffer_chain_get(buffer_chain_t * object)
+{
+    if(NULL == object) { return 0; }
+
+    char c = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        buffer_chain_take(object, &c, 1, false);
+    }
+
+    atomic_fetch_sub(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return c;
+}
+
+bool buffer_chain_init(buffer_chain_t * object, buffer_chunk_pool_t * pool, size_t max_chunks, bool start)
+{
+    if(NULL == object){ return false; }
+
+    object->pool = pool;
+    object->max_chunks = max_chunks;
+    object->tail = NULL;
+    object->tail_offset = 0;
+    object->head = NULL;
+    object->head_offset = 0;
+    atomic_init(&object->chunks, 0);
+
+    buffer_init(&object->buffer, NULL, 0, false);
+
+    if((NULL == pool) || (0 == max_chunks)){ return false; }
+
+    buffer_chunk_t * chunk = buffer_chunk_pool_pop(pool);
+
+    if(NULL == chunk){ return false; }
+
+    atomic_init(&chunk->next, NULL);
+    atomic_init(&object->chunks, 1);
+
+    object->tail = chunk;
+    object->head = chunk;
+
+    // The data of the embedded buffer is only set so that it can be started
+    buffer_init(&object->buffer, BUFFER_CHUNK_DATA(chunk), pool->chunk_size, start);
+
+    return true;
+}
+
+size_t buffer_chain_read(buffer_chain_t * object, char * dest, size_t n)
+{
+    if((NULL == object) || (NULL == dest) || (0 == n)) { return 0; }
+
+    size_t i = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        i = buffer_chain_take(object, dest, n - 1, false);
+    }
+
+    atomic_fetch_sub(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+
+    dest[i] = '\0';
+    return i;
+}
+
+size_t buffer_chain_read_line(buffer_chain_t * object, char * dest, size_t n)
+{
+    if((NULL == object) || (NULL == dest) || (0 == n) || (0 == atomic_load(&object->buffer.lines))) { return 0; }
+
+    size_t i = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        i = buffer_chain_take(object, dest, n - 1, true);
+    }
+
+    atomic_fetch_sub(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+
+    dest[i] = '\0';
+    return i;
+}
+
+bool buffer_chain_set(buffer_chain_t * object, char c)
+{
+    return 1 == buffer_chain_write(object, &c, 1);
+}
+
+size_t buffer_chain_write(buffer_chain_t * object, const char * src, size_t n)
+{
+    if((NULL == object) || (NULL == src)) { return 0; }
+
+    size_t i = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->buffer.state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
+    {
+        // As buffer_write(), the string terminator ends the characters
+        const char * end = (const char *)memchr(src, '\0', n);
+
+        if(NULL != end) { n = (size_t)(end - src); }
+
+        size_t chunk_size = object->pool->chunk_size;
+        size_t lines = 0;
+
+        while(i < n)
+        {
+            if((chunk_size == object->tail_offset) && !buffer_chain_grow(object))
+            {
+#ifdef BUFFER_ENABLE_HANDLER
+                if(object->buffer.on_full) { object->buffer.on_full(&object->buffer, src[i]); }
+#endif
+                break; // Full
+            }
+
+            char * ptr = BUFFER_CHUNK_DATA(object->tail) + object->tail_offset;
+
+            size_t length = chunk_size - object->tail_offset;
+
+            if((n - i) < length) { length = n - i; }
+
+            memcpy(ptr, src + i, length);
+
+            uint64_t tail = object->buffer.tail_produced;
+
+            for(const char * found = buffer_find_line_end(&object->buffer, tail, ptr, length);
+                NULL != found;
+                found = buffer_find_line_end(&object->buffer, buffer_line_tail(tail, ptr, (size_t)(found + 1 - ptr)), found + 1, length - (size_t)(found + 1 - ptr)))
+            {
+                lines++;
+            }
+
+            object->buffer.tail_produced = buffer_line_tail(tail, ptr, length);
+
+            object->tail_offset += length;
+            i += length;
+        }
+
+        if(0 < lines)
+        {
+            atomic_fetch_add(&object->buffer.lines, lines);
+        }
+
+        if(0 < i)
+        {
+            size_t length = atomic_fetch_add(&object->buffer.length, i) + i;
+
+            buffer_notify_published(&object->buffer, length, i, lines);
+        }
+
+#ifdef BUFFER_ENABLE_HANDLER
+        if(object->buffer.on_new_character)
+        {
+            for(size_t k = 0; k < i; k++)
+            {
+                object->buffer.on_new_character(&object->buffer, src[k]);
+            }
+        }
+
+        if(object->buffer.on_new_line)
+        {
+            for(size_t k = 0; k < lines; k++)
+            {
+                object->buffer.on_new_line(&object->buffer);
+            }
+        }
+#endif
+    }
+
+    atomic_fetch_sub(&object->buffer.state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return i;
+}
+
+size_t buffer_chunk_pool_available(const buffer_chunk_pool_t * pool)
+{
+    if(NULL == pool) { return 0; }
+
+    return atomic_load(&pool->available);
+}
+
+bool buffer_chunk_pool_init(buffer_chunk_pool_t * pool, char * data, size_t sizeof_data, size_t chunk_size)
+{
+    if(NULL == pool){ return false; }
+
+    pool->chunks = NULL;
+    pool->stride = BUFFER_CHUNK_DATA_OFFSET + BUFFER_CHUNK_ALIGN(chunk_size);
+    pool->chunk_size = chunk_size;
+    pool->count = 0;
+    atomic_init(&pool->free, 0);
+    atomic_init(&pool->available, 0);
+
+    if((NULL == data) || (0 == chunk_size)){ return false; }
+
+    // The first chunk is aligned, the bytes before it are not used
+    size_t skip = (size_t)((BUFFER_CHUNK_ALIGNMENT - ((uintptr_t)data & (BUFFER_CHUNK_ALIGNMENT - 1))) & (BUFFER_CHUNK_ALIGNMENT - 1));
+
+    if(sizeof_data < (skip + pool->stride)){ return false; }
+
+    size_t count = (sizeof_data - skip) / pool->stride;
+
+    if(UINT32_MAX <= count) { count = UINT32_MAX - 1; }
+
+    pool->chunks = data + skip;
+    pool->count = count;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        buffer_chunk_t * chunk = buffer_chunk_at(pool, (uint32_t)i);
+
+        atomic_init(&chunk->next, NULL);
+        atomic_init(&chunk->free_next, ((i + 1) < count) ? (uint32_t)(i + 2) : 0);
+    }
+
+    atomic_init(&pool->free, 1);
+    atomic_init(&pool->available, count);
+
+    return true;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
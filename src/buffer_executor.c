@@ -0,0 +1,300 @@
+//! @file
+//! @brief The buffer executor source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_executor.h"
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_executor_sc buffer_executor =
+{
+    buffer_executor_exit,
+    buffer_executor_init,
+    buffer_executor_line_attach,
+    buffer_executor_line_detach,
+    buffer_executor_submit,
+    buffer_executor_task,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static void buffer_executor_line_run(buffer_task_t * task);
+static void buffer_executor_line_wake(buffer_waiter_t * waiter);
+static buffer_task_t * buffer_executor_pop(buffer_executor_t * executor);
+static buffer_task_t * buffer_executor_take(buffer_executor_t * executor);
+static int buffer_executor_worker(void * arg);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Runs the handler and arms the waiter again
+static void buffer_executor_line_run(buffer_task_t * task)
+{
+    buffer_executor_line_t * line = (buffer_executor_line_t *)task->context;
+
+    if(!atomic_load(&line->attached)) { return; }
+
+    line->handler(line->object);
+
+    if(!atomic_load(&line->attached)) { return; }
+
+    if(buffer_waiter_arm(line->object, BUFFER_WAIT_LINE, &line->waiter))
+    {
+        // A detach in the meantime has either removed the waiter or is seen here
+        if(!atomic_load(&line->attached))
+        {
+            buffer_waiter_cancel(line->object, BUFFER_WAIT_LINE, &line->waiter);
+        }
+    }
+    else if((0 < buffer_lines(line->object)) && (BUFFER_FLAGS_IDLE <= atomic_load(&line->object->state)))
+    {
+        // Lines remain, the task is queued behind the other tasks of the executor
+        buffer_executor_submit(line->executor, &line->task);
+    }
+}
+
+//! @brief Called by the producer/set thread when a line was published
+static void buffer_executor_line_wake(buffer_waiter_t * waiter)
+{
+    buffer_executor_line_t * line = (buffer_executor_line_t *)waiter->context;
+
+    buffer_executor_submit(line->executor, &line->task);
+}
+
+//! @brief Removes the oldest task from the queue, must be called with the mutex
+//!
+//! @details The producers only push in front of ::buffer_executor_s::head. If
+//! ::buffer_executor_s::ready is empty, the whole list is taken over with one exchange and
+//! reversed, so that each task is removed in constant time.
+static buffer_task_t * buffer_executor_pop(buffer_executor_t * executor)
+{
+    if(NULL == executor->ready)
+    {
+        buffer_task_t * task = atomic_exchange(&executor->head, NULL);
+
+        while(NULL != task)
+        {
+            buffer_task_t * next = task->next;
+
+            task->next = executor->ready;
+            executor->ready = task;
+            task = next;
+        }
+    }
+
+    buffer_task_t * task = executor->ready;
+
+    if(NULL != task)
+    {
+        executor->ready = task->next;
+        task->next = NULL;
+    }
+
+    return task;
+}
+
+//! @brief Waits for the next task, `NULL` if the executor is stopped
+static buffer_task_t * buffer_executor_take(buffer_executor_t * executor)
+{
+    buffer_task_t * task;
+
+    mtx_lock(&executor->mutex);
+
+    while(true)
+    {
+        task = buffer_executor_pop(executor);
+
+        if((NULL != task) || atomic_load(&executor->stop)) { break; }
+
+        atomic_fetch_add(&executor->sleeping, 1);
+
+        // A task added in the meantime has either seen the sleeping thread or is seen here
+        task = buffer_executor_pop(executor);
+
+        if((NULL != task) || atomic_load(&executor->stop))
+        {
+            atomic_fetch_sub(&executor->sleeping, 1);
+            break;
+        }
+
+        cnd_wait(&executor->condition, &executor->mutex);
+
+        atomic_fetch_sub(&executor->sleeping, 1);
+    }
+
+    mtx_unlock(&executor->mutex);
+
+    return task;
+}
+
+static int buffer_executor_worker(void * arg)
+{
+    buffer_executor_t * executor = (buffer_executor_t *)arg;
+
+    buffer_task_t * task;
+
+    while(NULL != (task = buffer_executor_take(executor)))
+    {
+        // Submissions during the run queue the task again
+        atomic_store(&task->queued, false);
+
+        task->run(task);
+    }
+
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+void buffer_executor_exit(buffer_executor_t * executor)
+{
+    if(NULL == executor) { return; }
+
+    mtx_lock(&executor->mutex);
+    atomic_store(&executor->stop, true);
+    cnd_broadcast(&executor->condition);
+    mtx_unlock(&executor->mutex);
+
+    for(size_t i = 0; i < executor->count; i++)
+    {
+        thrd_join(executor->threads[i], NULL);
+    }
+
+    executor->count = 0;
+
+    cnd_destroy(&executor->condition);
+    mtx_destroy(&executor->mutex);
+}
+
+bool buffer_executor_init(buffer_executor_t * executor, size_t threads)
+{
+    if(NULL == executor) { return false; }
+
+    atomic_init(&executor->head, NULL);
+    executor->ready = NULL;
+    atomic_init(&executor->sleeping, 0);
+    atomic_init(&executor->stop, false);
+    executor->count = 0;
+
+    if(BUFFER_EXECUTOR_THREADS < threads) { threads = BUFFER_EXECUTOR_THREADS; }
+
+    if(thrd_success != mtx_init(&executor->mutex, mtx_plain)) { return false; }
+
+    if(thrd_success != cnd_init(&executor->condition))
+    {
+        mtx_destroy(&executor->mutex);
+        return false;
+    }
+
+    for(size_t i = 0; i < threads; i++)
+    {
+        if(thrd_success != thrd_create(&executor->threads[i], buffer_executor_worker, executor))
+        {
+            buffer_executor_exit(executor);
+            return false;
+        }
+
+        executor->count++;
+    }
+
+    return 0 < executor->count;
+}
+
+bool buffer_executor_line_attach(buffer_executor_t * executor, buffer_executor_line_t * line, buffer_t * object, buffer_executor_handler_t handler)
+{
+    if((NULL == executor) || (NULL == line) || (NULL == object) || (NULL == handler)) { return false; }
+
+    line->waiter.wake = buffer_executor_line_wake;
+    line->waiter.context = line;
+    line->waiter.seen = 0;
+    buffer_executor_task(&line->task, buffer_executor_line_run, line);
+    line->executor = executor;
+    line->object = object;
+    line->handler = handler;
+    atomic_init(&line->attached, true);
+
+    if(!buffer_waiter_arm(object, BUFFER_WAIT_LINE, &line->waiter))
+    {
+        if(0 < buffer_lines(object))
+        {
+            buffer_executor_submit(executor, &line->task);
+        }
+    }
+
+    return true;
+}
+
+bool buffer_executor_line_detach(buffer_executor_line_t * line)
+{
+    if(NULL == line) { return false; }
+
+    atomic_store(&line->attached, false);
+
+    return buffer_waiter_cancel(line->object, BUFFER_WAIT_LINE, &line->waiter);
+}
+
+bool buffer_executor_submit(buffer_executor_t * executor, buffer_task_t * task)
+{
+    if((NULL == executor) || (NULL == task)) { return false; }
+
+    if(atomic_load(&executor->stop)) { return false; }
+
+    // Coalesced, the task is already queued
+    if(atomic_exchange(&task->queued, true)) { return false; }
+
+    buffer_task_t * head = atomic_load(&executor->head);
+    do
+    {
+        task->next = head;
+    }
+    while(!atomic_compare_exchange_weak(&executor->head, &head, task));
+
+    // A mutex is only needed to wake a sleeping worker thread
+    if(0 < atomic_load(&executor->sleeping))
+    {
+        mtx_lock(&executor->mutex);
+        cnd_signal(&executor->condition);
+        mtx_unlock(&executor->mutex);
+    }
+
+    return true;
+}
+
+void buffer_executor_task(buffer_task_t * task, buffer_task_handler_t run, void * context)
+{
+    if(NULL == task) { return; }
+
+    task->next = NULL;
+    task->run = run;
+    task->context = context;
+    atomic_init(&task->queued, false);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
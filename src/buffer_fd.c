@@ -0,0 +1,129 @@
+//! @file
+//! @brief The buffer file descriptor source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_fd.h"
+
+#include <errno.h>  // errno, EINTR, EINVAL, ENOBUFS
+#include <unistd.h> // read, write
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_fd_sc buffer_fd =
+{
+    buffer_drain_to_fd,
+    buffer_fill_from_fd,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+ssize_t buffer_drain_to_fd(buffer_t * object, int fd, size_t max)
+{
+    if(NULL == object) { errno = EINVAL; return -1; }
+
+    size_t total = 0;
+
+    while(total < max)
+    {
+        const char * span;
+        size_t length = buffer_read_span(object, &span);
+
+        if(0 == length) { break; }
+
+        if((max - total) < length) { length = max - total; }
+
+        ssize_t written = write(fd, span, length);
+
+        if(written < 0)
+        {
+            if(EINTR == errno) { continue; }
+
+            // EAGAIN and all other errors end the transfer
+            if(0 < total) { break; }
+
+            return -1;
+        }
+
+        total += buffer_read_consume(object, (size_t)written);
+
+        if((size_t)written < length) { break; } // The file descriptor accepts no more
+    }
+
+    return (ssize_t)total;
+}
+
+ssize_t buffer_fill_from_fd(buffer_t * object, int fd, size_t max)
+{
+    if(NULL == object) { errno = EINVAL; return -1; }
+
+    size_t total = 0;
+
+    while(total < max)
+    {
+        char * span;
+        size_t space = buffer_write_reserve(object, &span);
+
+        if(0 == space)
+        {
+            if(0 < total) { break; }
+
+            errno = ENOBUFS;
+            return -1;
+        }
+
+        if((max - total) < space) { space = max - total; }
+
+        ssize_t received = read(fd, span, space);
+
+        if(received <= 0)
+        {
+            int error = errno;
+
+            buffer_write_commit(object, span, 0);
+
+            if((received < 0) && (EINTR == error)) { continue; }
+
+            // End of file, EAGAIN and all other errors end the transfer
+            if(0 < total) { break; }
+
+            errno = error;
+            return received;
+        }
+
+        total += buffer_write_commit(object, span, (size_t)received);
+
+        if((size_t)received < space) { break; } // The file descriptor has no more
+    }
+
+    return (ssize_t)total;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
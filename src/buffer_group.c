@@ -0,0 +1,299 @@
+//! @file
+//! @brief The buffer group source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE)
+#define _DEFAULT_SOURCE // syscall
+#endif
+
+#include "buffer_group.h"
+#include "buffer_until.h"
+
+#if defined(__linux__)
+  #include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+  #include <sys/syscall.h> // SYS_futex
+  #include <unistd.h>      // syscall
+  #include <time.h>        // timespec
+#else
+  #include <threads.h>     // thrd_sleep
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+//! @brief Number of members per word of the bitmap
+#define BUFFER_GROUP_BITS 64
+
+#if (BUFFER_GROUP_WORDS < 1) || (BUFFER_GROUP_BITS < BUFFER_GROUP_WORDS)
+#error BUFFER_GROUP_WORDS must be between 1 and 64
+#endif
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_group_sc buffer_group =
+{
+    buffer_group_add,
+    buffer_group_exit,
+    buffer_group_init,
+    buffer_group_next,
+    buffer_group_rearm,
+    buffer_group_wait,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static size_t buffer_group_ctz(uint64_t bits);
+static void buffer_group_mark(buffer_group_t * group, size_t index);
+static void buffer_group_sleep(buffer_group_t * group, int sequence, uint64_t timeout);
+static void buffer_group_wake(buffer_waiter_t * waiter);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Returns the position of the lowest set bit, @p bits must not be 0
+static size_t buffer_group_ctz(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(bits);
+#else
+    size_t n = 0;
+
+    while(0 == (bits & 1))
+    {
+        bits >>= 1;
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+//! @brief Sets the bit of a member, called by the producer/set thread
+static void buffer_group_mark(buffer_group_t * group, size_t index)
+{
+    size_t word = index / BUFFER_GROUP_BITS;
+
+    atomic_fetch_or(&group->ready[word], UINT64_C(1) << (index % BUFFER_GROUP_BITS));
+    atomic_fetch_or(&group->summary, UINT64_C(1) << word);
+
+    // Only a sleeping consumer/get thread costs a system call
+    if(0 < atomic_load(&group->sleeping))
+    {
+        atomic_fetch_add(&group->sequence, 1);
+
+#if defined(__linux__)
+        syscall(SYS_futex, (int *)&group->sequence, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+//! @brief Sleeps until ::buffer_group_s::sequence differs from @p sequence or @p timeout nanoseconds have passed
+static void buffer_group_sleep(buffer_group_t * group, int sequence, uint64_t timeout)
+{
+#if defined(__linux__)
+    struct timespec ts = { (time_t)(timeout / UINT64_C(1000000000)), (long)(timeout % UINT64_C(1000000000)) };
+
+    // Returns immediately if a producer/set thread has already changed the value
+    syscall(SYS_futex, (int *)&group->sequence, FUTEX_WAIT_PRIVATE, sequence, &ts, NULL, 0);
+#else
+    (void)group;
+    (void)sequence;
+
+    if(BUFFER_UNTIL_SLEEP_NS < timeout) { timeout = BUFFER_UNTIL_SLEEP_NS; }
+
+    struct timespec ts = { 0, (long)timeout };
+
+    thrd_sleep(&ts, NULL);
+#endif
+}
+
+//! @brief Wake handler of a member, called by the producer/set thread on the transition
+static void buffer_group_wake(buffer_waiter_t * waiter)
+{
+    buffer_group_member_t * member = (buffer_group_member_t *)waiter->context;
+
+    buffer_group_mark(member->group, member->index);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+size_t buffer_group_add(buffer_group_t * group, buffer_t * object, buffer_wait_event_t event)
+{
+    if((NULL == group) || (NULL == object)) { return BUFFER_GROUP_NONE; }
+
+    if((BUFFER_WAIT_DATA != event) && (BUFFER_WAIT_LINE != event)) { return BUFFER_GROUP_NONE; }
+
+    if(BUFFER_GROUP_MEMBERS <= group->count) { return BUFFER_GROUP_NONE; }
+
+    size_t index = group->count;
+
+    buffer_group_member_t * member = &group->members[index];
+    member->waiter.wake = buffer_group_wake;
+    member->waiter.context = member;
+    member->waiter.seen = 0;
+    member->group = group;
+    member->object = object;
+    member->event = event;
+    member->index = index;
+
+    group->count++;
+
+    buffer_group_rearm(group, index);
+
+    return index;
+}
+
+void buffer_group_exit(buffer_group_t * group)
+{
+    if(NULL == group) { return; }
+
+    for(size_t i = 0; i < group->count; i++)
+    {
+        buffer_waiter_cancel(group->members[i].object, group->members[i].event, &group->members[i].waiter);
+    }
+
+    group->count = 0;
+}
+
+bool buffer_group_init(buffer_group_t * group)
+{
+    if(NULL == group) { return false; }
+
+    atomic_init(&group->summary, 0);
+
+    for(size_t i = 0; i < BUFFER_GROUP_WORDS; i++)
+    {
+        atomic_init(&group->ready[i], 0);
+    }
+
+    atomic_init(&group->sequence, 0);
+    atomic_init(&group->sleeping, 0);
+
+    group->count = 0;
+    group->cursor = 0;
+
+    return true;
+}
+
+size_t buffer_group_next(buffer_group_t * group)
+{
+    if(NULL == group) { return BUFFER_GROUP_NONE; }
+
+    uint64_t summary = atomic_load(&group->summary);
+
+    if(0 == summary) { return BUFFER_GROUP_NONE; }
+
+    size_t start = group->cursor / BUFFER_GROUP_BITS;
+    uint64_t from = ~UINT64_C(0) << (group->cursor % BUFFER_GROUP_BITS);
+
+    // The word of the cursor is visited twice, first the members behind the cursor and last the ones before
+    for(size_t i = 0; i <= BUFFER_GROUP_WORDS; i++)
+    {
+        size_t word = (start + i) % BUFFER_GROUP_WORDS;
+
+        if(0 == (summary & (UINT64_C(1) << word))) { continue; }
+
+        uint64_t bits = atomic_load(&group->ready[word]);
+
+        if(0 == i) { bits &= from; }
+        else if(BUFFER_GROUP_WORDS == i) { bits &= ~from; }
+
+        if(0 == bits) { continue; }
+
+        uint64_t mask = UINT64_C(1) << buffer_group_ctz(bits);
+
+        if(0 == (atomic_fetch_and(&group->ready[word], ~mask) & ~mask))
+        {
+            atomic_fetch_and(&group->summary, ~(UINT64_C(1) << word));
+
+            // A member marked in the meantime has either seen the cleared bit or is seen here
+            if(0 != atomic_load(&group->ready[word]))
+            {
+                atomic_fetch_or(&group->summary, UINT64_C(1) << word);
+            }
+        }
+
+        size_t index = (word * BUFFER_GROUP_BITS) + buffer_group_ctz(mask);
+
+        group->cursor = (index + 1) % BUFFER_GROUP_MEMBERS;
+
+        return index;
+    }
+
+    return BUFFER_GROUP_NONE;
+}
+
+bool buffer_group_rearm(buffer_group_t * group, size_t index)
+{
+    if((NULL == group) || (group->count <= index)) { return false; }
+
+    buffer_group_member_t * member = &group->members[index];
+
+    if(buffer_waiter_arm(member->object, member->event, &member->waiter)) { return true; }
+
+    if(BUFFER_FLAGS_IDLE > atomic_load(&member->object->state)) { return false; }
+
+    // The buffer object still has data
+    buffer_group_mark(group, index);
+
+    return true;
+}
+
+size_t buffer_group_wait(buffer_group_t * group, uint64_t deadline)
+{
+    if(NULL == group) { return BUFFER_GROUP_NONE; }
+
+    while(true)
+    {
+        size_t index = buffer_group_next(group);
+
+        if(BUFFER_GROUP_NONE != index) { return index; }
+
+        uint64_t now = buffer_until_now();
+
+        if(deadline <= now) { return BUFFER_GROUP_NONE; }
+
+        atomic_fetch_add(&group->sleeping, 1);
+
+        int sequence = atomic_load(&group->sequence);
+
+        // A member marked in the meantime has either seen the sleeping thread or is seen here
+        index = buffer_group_next(group);
+
+        if(BUFFER_GROUP_NONE == index)
+        {
+            buffer_group_sleep(group, sequence, deadline - now);
+        }
+
+        atomic_fetch_sub(&group->sleeping, 1);
+
+        if(BUFFER_GROUP_NONE != index) { return index; }
+    }
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,290 @@
+//! @file
+//! @brief The buffer latency source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+#endif
+
+#include "buffer_latency.h"
+
+#include <time.h> // clock_gettime, timespec_get
+
+#if defined(BUFFER_LATENCY_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+  #include <x86intrin.h> // __rdtsc
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+#if (0 != (BUFFER_LATENCY_STAMPS & (BUFFER_LATENCY_STAMPS - 1)))
+#error BUFFER_LATENCY_STAMPS must be a power of two
+#endif
+
+//! @brief Adds @p N to a counter, the counter is only written by one thread
+#define BUFFER_LATENCY_ADD(PTR, N) \
+    atomic_store_explicit((PTR), atomic_load_explicit((PTR), memory_order_relaxed) + (N), memory_order_relaxed)
+
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_latency_sc buffer_latency =
+{
+    buffer_latency_attach,
+    buffer_histogram_clear,
+    buffer_histogram_count,
+    buffer_histogram_merge,
+    buffer_latency_now,
+    buffer_histogram_percentile,
+    buffer_histogram_record,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static size_t buffer_histogram_index(uint64_t value);
+static uint64_t buffer_histogram_upper(size_t index);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+static size_t buffer_histogram_index(uint64_t value)
+{
+    if(value < BUFFER_HISTOGRAM_SUB_BUCKETS)
+    {
+        return (size_t)value;
+    }
+
+    size_t exponent = 63;
+    while(0 == (value >> exponent))
+    {
+        exponent--;
+    }
+
+    size_t shift = exponent - BUFFER_HISTOGRAM_SUB_BITS;
+    size_t sub = (size_t)(value >> shift) & (BUFFER_HISTOGRAM_SUB_BUCKETS - 1);
+
+    return ((shift + 1) * BUFFER_HISTOGRAM_SUB_BUCKETS) + sub;
+}
+
+static uint64_t buffer_histogram_upper(size_t index)
+{
+    if(index < BUFFER_HISTOGRAM_SUB_BUCKETS)
+    {
+        return (uint64_t)index;
+    }
+
+    size_t shift = (index / BUFFER_HISTOGRAM_SUB_BUCKETS) - 1;
+    uint64_t sub = (uint64_t)(index % BUFFER_HISTOGRAM_SUB_BUCKETS);
+    uint64_t lower = (BUFFER_HISTOGRAM_SUB_BUCKETS + sub) << shift;
+
+    return lower + ((UINT64_C(1) << shift) - 1);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+void buffer_histogram_clear(buffer_histogram_t * histogram)
+{
+    if(NULL == histogram){ return; }
+
+    for(size_t i = 0; i < BUFFER_HISTOGRAM_BUCKETS; i++)
+    {
+        atomic_init(&histogram->counts[i], 0);
+    }
+    atomic_init(&histogram->total, 0);
+    atomic_init(&histogram->max, 0);
+}
+
+size_t buffer_histogram_count(const buffer_histogram_t * histogram)
+{
+    if(NULL == histogram){ return 0; }
+
+    return atomic_load_explicit(&histogram->total, memory_order_relaxed);
+}
+
+void buffer_histogram_merge(buffer_histogram_t * dest, const buffer_histogram_t * src)
+{
+    if((NULL == dest) || (NULL == src)){ return; }
+
+    size_t total = 0;
+
+    for(size_t i = 0; i < BUFFER_HISTOGRAM_BUCKETS; i++)
+    {
+        size_t count = atomic_load_explicit(&src->counts[i], memory_order_relaxed);
+        if(0 != count)
+        {
+            atomic_fetch_add_explicit(&dest->counts[i], count, memory_order_relaxed);
+            total += count;
+        }
+    }
+
+    atomic_fetch_add_explicit(&dest->total, total, memory_order_relaxed);
+
+    size_t max = atomic_load_explicit(&src->max, memory_order_relaxed);
+    size_t current = atomic_load_explicit(&dest->max, memory_order_relaxed);
+    while(current < max)
+    {
+        if(atomic_compare_exchange_weak(&dest->max, &current, max))
+        {
+            break;
+        }
+    }
+}
+
+uint64_t buffer_histogram_percentile(const buffer_histogram_t * histogram, double percentile)
+{
+    if(NULL == histogram){ return 0; }
+
+    size_t counts[BUFFER_HISTOGRAM_BUCKETS];
+    size_t total = 0;
+
+    // The buckets are read once, the total matches the read buckets
+    for(size_t i = 0; i < BUFFER_HISTOGRAM_BUCKETS; i++)
+    {
+        counts[i] = atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+        total += counts[i];
+    }
+
+    if(0 == total){ return 0; }
+
+    if(percentile < 0.0){ percentile = 0.0; }
+    if(percentile > 100.0){ percentile = 100.0; }
+
+    size_t rank = (size_t)((percentile / 100.0) * (double)total + 0.5);
+    if(0 == rank){ rank = 1; }
+
+    size_t sum = 0;
+    for(size_t i = 0; i < BUFFER_HISTOGRAM_BUCKETS; i++)
+    {
+        sum += counts[i];
+        if(sum >= rank)
+        {
+            uint64_t upper = buffer_histogram_upper(i);
+            uint64_t max = (uint64_t)atomic_load_explicit(&histogram->max, memory_order_relaxed);
+            return (upper < max) ? upper : max;
+        }
+    }
+
+    return (uint64_t)atomic_load_explicit(&histogram->max, memory_order_relaxed);
+}
+
+void buffer_histogram_record(buffer_histogram_t * histogram, uint64_t value)
+{
+    if(NULL == histogram){ return; }
+
+    BUFFER_LATENCY_ADD(&histogram->counts[buffer_histogram_index(value)], 1);
+    BUFFER_LATENCY_ADD(&histogram->total, 1);
+
+    if(value > atomic_load_explicit(&histogram->max, memory_order_relaxed))
+    {
+        atomic_store_explicit(&histogram->max, (size_t)value, memory_order_relaxed);
+    }
+}
+
+bool buffer_latency_attach(buffer_t * object, buffer_latency_t * latency)
+{
+    if(NULL == object){ return false; }
+
+    if(NULL != latency)
+    {
+        for(size_t i = 0; i < BUFFER_LATENCY_STAMPS; i++)
+        {
+            atomic_init(&latency->stamps[i].sequence, 0);
+            atomic_init(&latency->stamps[i].time, 0);
+        }
+
+        latency->published = 0;
+        atomic_init(&latency->consumed, 0);
+        atomic_init(&latency->dropped, 0);
+    }
+
+#ifdef BUFFER_ENABLE_LATENCY
+    object->latency = latency;
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t buffer_latency_now(void)
+{
+#if defined(BUFFER_LATENCY_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+    return (uint64_t)__rdtsc();
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * UINT64_C(1000000000)) + (uint64_t)ts.tv_nsec;
+#else
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ((uint64_t)ts.tv_sec * UINT64_C(1000000000)) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void buffer_latency_publish(buffer_latency_t * latency)
+{
+    size_t line = latency->published;
+
+    latency->published = line + 1;
+
+    // The entry may only be used if the consumer has matched the previous line of this entry
+    if((line - atomic_load_explicit(&latency->consumed, memory_order_acquire)) < BUFFER_LATENCY_STAMPS)
+    {
+        buffer_latency_stamp_t * stamp = &latency->stamps[line & (BUFFER_LATENCY_STAMPS - 1)];
+
+        atomic_store_explicit(&stamp->time, (size_t)buffer_latency_now(), memory_order_relaxed);
+        atomic_store_explicit(&stamp->sequence, line + 1, memory_order_release);
+    }
+    else
+    {
+        BUFFER_LATENCY_ADD(&latency->dropped, 1);
+    }
+}
+
+void buffer_latency_consume(buffer_latency_t * latency)
+{
+    size_t line = atomic_load_explicit(&latency->consumed, memory_order_relaxed);
+
+    buffer_latency_stamp_t * stamp = &latency->stamps[line & (BUFFER_LATENCY_STAMPS - 1)];
+
+    if((line + 1) == atomic_load_explicit(&stamp->sequence, memory_order_acquire))
+    {
+        size_t time = atomic_load_explicit(&stamp->time, memory_order_relaxed);
+
+        // The difference is calculated with the width of the stored time stamp
+        buffer_histogram_record(&latency->histogram, (uint64_t)((size_t)buffer_latency_now() - time));
+    }
+
+    atomic_store_explicit(&latency->consumed, line + 1, memory_order_release);
+}
+
+void buffer_latency_discard(buffer_latency_t * latency, size_t lines)
+{
+    atomic_fetch_add_explicit(&latency->consumed, lines, memory_order_release);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
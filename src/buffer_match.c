@@ -0,0 +1,225 @@
+//! @file
+//! @brief The buffer pattern matcher source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_match.h"
+
+#include <string.h> // memcpy, memset, strlen
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_match_sc buffer_match =
+{
+    buffer_match_init,
+    buffer_match_read_to,
+    buffer_match_reset,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static bool buffer_match_insert(buffer_match_t * matcher, const char * pattern, size_t index);
+static void buffer_match_link(buffer_match_t * matcher);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Adds a pattern to the trie, 0 is used as "no child" because the root is no child
+static bool buffer_match_insert(buffer_match_t * matcher, const char * pattern, size_t index)
+{
+    size_t length = strlen(pattern);
+
+    if(0 == length) { return false; }
+
+    unsigned char state = 0;
+
+    for(size_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)pattern[i];
+
+        if(0 == matcher->next[state][c])
+        {
+            if(BUFFER_MATCH_STATES <= matcher->states) { return false; }
+
+            matcher->next[state][c] = (unsigned char)matcher->states;
+            matcher->states += 1;
+        }
+
+        state = matcher->next[state][c];
+    }
+
+    // A duplicate keeps the first index
+    if(0 == matcher->output[state])
+    {
+        matcher->output[state] = (unsigned char)(index + 1);
+    }
+
+    matcher->lengths[index] = length;
+    return true;
+}
+
+//! @brief Turns the trie into the automaton, the fail links are resolved breadth-first
+//! so that every missing transition is taken over from the fail state
+static void buffer_match_link(buffer_match_t * matcher)
+{
+    unsigned char fail[BUFFER_MATCH_STATES];
+    unsigned char queue[BUFFER_MATCH_STATES];
+    size_t head = 0;
+    size_t tail = 0;
+
+    for(size_t c = 0; c < 256; c++)
+    {
+        unsigned char child = matcher->next[0][c];
+
+        if(0 != child)
+        {
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+
+    while(head < tail)
+    {
+        unsigned char state = queue[head++];
+
+        for(size_t c = 0; c < 256; c++)
+        {
+            unsigned char child = matcher->next[state][c];
+
+            if(0 != child)
+            {
+                fail[child] = matcher->next[fail[state]][c];
+
+                // A pattern ending in the state is longer than the one of its fail state
+                if(0 == matcher->output[child])
+                {
+                    matcher->output[child] = matcher->output[fail[child]];
+                }
+
+                queue[tail++] = child;
+            }
+            else
+            {
+                matcher->next[state][c] = matcher->next[fail[state]][c];
+            }
+        }
+    }
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public: functions
+ *---------------------------------------------------------------------*/
+
+bool buffer_match_init(buffer_match_t * matcher, buffer_t * object, const char * const * patterns, size_t n)
+{
+    if((NULL == matcher) || (NULL == object) || (NULL == patterns) ||
+       (0 == n) || (BUFFER_MATCH_PATTERNS < n))
+    {
+        return false;
+    }
+
+    memset(matcher, 0, sizeof(*matcher));
+    matcher->states = 1;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if((NULL == patterns[i]) || !buffer_match_insert(matcher, patterns[i], i))
+        {
+            memset(matcher, 0, sizeof(*matcher));
+            return false;
+        }
+    }
+
+    buffer_match_link(matcher);
+
+    matcher->patterns = n;
+    matcher->object = object;
+    return true;
+}
+
+bool buffer_match_read_to(buffer_match_t * matcher, char * dest, size_t n, size_t * pattern, size_t * length)
+{
+    if((NULL == matcher) || (NULL == matcher->object)) { return false; }
+
+    const char * span;
+    size_t available = buffer_read_span(matcher->object, &span);
+
+    // Characters were removed by another read function, the scanned characters may have been
+    // removed and new ones written at the same position
+    if((matcher->object->removed != matcher->removed) || (available < matcher->scanned))
+    {
+        matcher->removed = matcher->object->removed;
+        matcher->scanned = 0;
+        matcher->state = 0;
+    }
+
+    unsigned char state = matcher->state;
+
+    for(size_t i = matcher->scanned; i < available; i++)
+    {
+        state = matcher->next[state][(unsigned char)span[i]];
+
+        if(0 != matcher->output[state])
+        {
+            size_t index = (size_t)matcher->output[state] - 1;
+            size_t end = i + 1;
+            size_t start = end - matcher->lengths[index];
+
+            if((NULL != dest) && (0 < n))
+            {
+                size_t copy = (start < n) ? start : (n - 1);
+
+                memcpy(dest, span, copy);
+                dest[copy] = '\0';
+            }
+
+            buffer_read_consume(matcher->object, end);
+            buffer_match_reset(matcher);
+
+            if(NULL != pattern) { *pattern = index; }
+            if(NULL != length)  { *length = start; }
+
+            return true;
+        }
+    }
+
+    matcher->scanned = available;
+    matcher->state = state;
+    return false;
+}
+
+bool buffer_match_reset(buffer_match_t * matcher)
+{
+    if(NULL == matcher) { return false; }
+
+    matcher->removed = (NULL == matcher->object) ? 0 : matcher->object->removed;
+    matcher->scanned = 0;
+    matcher->state = 0;
+    return true;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
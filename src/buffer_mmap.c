@@ -0,0 +1,387 @@
+//! @file
+//! @brief The file-backed persistent buffer source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE)
+#define _DEFAULT_SOURCE // ftruncate, msync, posix_madvise, sysconf
+#endif
+
+#include "buffer_mmap.h"
+#include "buffer_until.h"
+
+#include <errno.h>    // errno, EBADMSG, EINVAL
+#include <fcntl.h>    // open
+#include <string.h>   // memcpy
+#include <sys/mman.h> // mmap, msync, munmap, posix_madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, ftruncate, sysconf
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+//! @brief Start of the ring in the mapping
+#define BUFFER_MMAP_DATA(OBJECT) ((char *)(OBJECT)->shm + (OBJECT)->shm->data_offset)
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_mmap_sc buffer_mmap =
+{
+    buffer_mmap_acknowledge,
+    buffer_mmap_close,
+    buffer_mmap_commit,
+    buffer_mmap_length,
+    buffer_mmap_open,
+    buffer_mmap_read,
+    buffer_mmap_write,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static bool buffer_mmap_due(const buffer_mmap_t * object, uint64_t bytes, uint64_t * time);
+static bool buffer_mmap_flush(const buffer_mmap_t * object, uint64_t from, uint64_t to);
+static bool buffer_mmap_recover(buffer_mmap_t * object);
+static bool buffer_mmap_sync_page(const buffer_mmap_t * object, const char * start, size_t n);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Returns whether a side synchronizes after @p bytes unsynchronized bytes, updates @p time if so
+static bool buffer_mmap_due(const buffer_mmap_t * object, uint64_t bytes, uint64_t * time)
+{
+    if(0 == bytes) { return false; }
+
+    bool due = (BUFFER_MMAP_SYNC_GROUP != object->sync) || (object->group_bytes <= bytes);
+
+    if(!due && (0 != object->group_ns))
+    {
+        uint64_t now = buffer_until_now();
+
+        due = (object->group_ns <= (now - *time));
+    }
+
+    if(due && (0 != object->group_ns)) { *time = buffer_until_now(); }
+
+    return due;
+}
+
+//! @brief Writes the ring between the producer cursors @p from and @p to to the disk
+static bool buffer_mmap_flush(const buffer_mmap_t * object, uint64_t from, uint64_t to)
+{
+    uint64_t size = object->shm->size;
+    uint64_t position = from % size;
+    uint64_t n = to - from;
+    uint64_t first = size - position;
+
+    if(n < first) { first = n; }
+
+    bool synced = buffer_mmap_sync_page(object, BUFFER_MMAP_DATA(object) + position, (size_t)first);
+
+    // The wrapped part at the start of the ring
+    if(first < n)
+    {
+        synced = buffer_mmap_sync_page(object, BUFFER_MMAP_DATA(object), (size_t)(n - first)) && synced;
+    }
+
+    return synced;
+}
+
+//! @brief Restores the ring from the durable cursors of the header
+static bool buffer_mmap_recover(buffer_mmap_t * object)
+{
+    buffer_mmap_header_t * header = (buffer_mmap_header_t *)object->map;
+
+    if(BUFFER_MMAP_MAGIC != header->magic) { return false; }
+
+    if((0 != (header->shm_offset % BUFFER_CACHE_LINE_SIZE)) || (object->size <= header->shm_offset)) { return false; }
+
+    buffer_shm_t * shm = buffer_shm_attach(object->map + header->shm_offset, object->size - header->shm_offset);
+
+    if(NULL == shm) { return false; }
+
+    uint64_t producer = atomic_load(&header->producer_offset);
+    uint64_t consumer = atomic_load(&header->consumer_offset);
+
+    if((producer < consumer) || (shm->size < (producer - consumer))) { return false; }
+
+    object->header = header;
+    object->shm = shm;
+
+    // The live cursors and the futex words of the last run are not used
+    atomic_store(&shm->producer_offset, producer);
+    atomic_store(&shm->consumer_offset, consumer);
+    atomic_store(&shm->data_sequence, 0);
+    atomic_store(&shm->data_sleeping, 0);
+    atomic_store(&shm->space_sequence, 0);
+    atomic_store(&shm->space_sleeping, 0);
+    atomic_store(&shm->running, 1);
+
+    object->producer_synced = producer;
+    object->consumer_offset = consumer;
+    object->recovered = (size_t)(producer - consumer);
+
+    // Only the unread pages are read ahead
+    if(0 != object->recovered)
+    {
+        uint64_t position = consumer % shm->size;
+        uint64_t first = shm->size - position;
+
+        if(object->recovered < first) { first = object->recovered; }
+
+        char * start = BUFFER_MMAP_DATA(object) + position;
+        size_t offset = (size_t)(start - object->map) % (size_t)header->shm_offset;
+
+        posix_madvise(start - offset, (size_t)first + offset, POSIX_MADV_WILLNEED);
+    }
+
+    return true;
+}
+
+//! @brief Writes the pages of a range of the mapping to the disk
+static bool buffer_mmap_sync_page(const buffer_mmap_t * object, const char * start, size_t n)
+{
+    if(0 == n) { return true; }
+
+    size_t page = (size_t)object->header->shm_offset;
+    size_t offset = (size_t)(start - object->map) % page;
+
+    return 0 == msync((void *)(start - offset), n + offset, MS_SYNC);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+bool buffer_mmap_acknowledge(buffer_mmap_t * object)
+{
+    if((NULL == object) || (NULL == object->shm)) { return false; }
+
+    uint64_t consumer = object->consumer_offset;
+    uint64_t acknowledged = atomic_load_explicit(&object->shm->consumer_offset, memory_order_relaxed);
+
+    if(consumer == acknowledged) { return true; }
+
+    atomic_store(&object->header->consumer_offset, consumer);
+
+    bool synced = true;
+
+    if(BUFFER_MMAP_SYNC_NONE != object->sync)
+    {
+        synced = buffer_mmap_sync_page(object, object->map, sizeof(buffer_mmap_header_t));
+    }
+
+    // The space is only returned when the cursor is stored, the producer cannot overwrite unacknowledged data
+    if(synced)
+    {
+        buffer_shm_read_consume(object->shm, (size_t)(consumer - acknowledged));
+    }
+
+    return synced;
+}
+
+bool buffer_mmap_close(buffer_mmap_t * object)
+{
+    if((NULL == object) || (NULL == object->map)) { return false; }
+
+    bool stored = buffer_mmap_commit(object);
+    stored = buffer_mmap_acknowledge(object) && stored;
+
+    munmap(object->map, object->size);
+    close(object->fd);
+
+    object->header = NULL;
+    object->shm = NULL;
+    object->map = NULL;
+    object->fd = -1;
+
+    return stored;
+}
+
+bool buffer_mmap_commit(buffer_mmap_t * object)
+{
+    if((NULL == object) || (NULL == object->shm)) { return false; }
+
+    uint64_t producer = atomic_load_explicit(&object->shm->producer_offset, memory_order_relaxed);
+
+    if(producer == object->producer_synced) { return true; }
+
+    if(BUFFER_MMAP_SYNC_NONE != object->sync)
+    {
+        // The data is on the disk before the cursor that covers it
+        if(!buffer_mmap_flush(object, object->producer_synced, producer)) { return false; }
+    }
+
+    atomic_store(&object->header->producer_offset, producer);
+
+    if(BUFFER_MMAP_SYNC_NONE != object->sync)
+    {
+        if(!buffer_mmap_sync_page(object, object->map, sizeof(buffer_mmap_header_t))) { return false; }
+    }
+
+    object->producer_synced = producer;
+
+    return true;
+}
+
+size_t buffer_mmap_length(const buffer_mmap_t * object)
+{
+    if((NULL == object) || (NULL == object->shm)) { return 0; }
+
+    return (size_t)(atomic_load(&object->shm->producer_offset) - object->consumer_offset);
+}
+
+bool buffer_mmap_open(buffer_mmap_t * object, const char * path, size_t size, buffer_mmap_sync_t sync, size_t group_bytes, uint64_t group_ns)
+{
+    if((NULL == object) || (NULL == path)) { errno = EINVAL; return false; }
+
+    object->header = NULL;
+    object->shm = NULL;
+    object->map = NULL;
+    object->fd = -1;
+    object->sync = sync;
+    object->group_bytes = group_bytes;
+    object->group_ns = group_ns;
+    object->recovered = 0;
+    object->producer_synced = 0;
+    object->producer_time = buffer_until_now();
+    object->consumer_offset = 0;
+    object->consumer_time = object->producer_time;
+
+    long page = sysconf(_SC_PAGESIZE);
+
+    if(page < (long)sizeof(buffer_mmap_header_t)) { errno = EINVAL; return false; }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+
+    if(0 > fd) { return false; }
+
+    struct stat st;
+
+    if(0 != fstat(fd, &st)) { close(fd); return false; }
+
+    if(0 == st.st_size)
+    {
+        if(size <= (size_t)page) { close(fd); errno = EINVAL; return false; }
+
+        if(0 != ftruncate(fd, (off_t)size)) { close(fd); return false; }
+    }
+    else
+    {
+        size = (size_t)st.st_size;
+    }
+
+    char * map = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if(MAP_FAILED == map) { close(fd); return false; }
+
+    object->map = map;
+    object->size = size;
+    object->fd = fd;
+
+    if(0 != st.st_size)
+    {
+        if(buffer_mmap_recover(object)) { return true; }
+
+        // The unread data is kept, the caller decides whether the file is removed
+        buffer_mmap_close(object);
+        errno = EBADMSG;
+        return false;
+    }
+
+    if(!buffer_shm_init(map + page, size - (size_t)page, true))
+    {
+        buffer_mmap_close(object);
+        errno = EINVAL;
+        return false;
+    }
+
+    buffer_mmap_header_t * header = (buffer_mmap_header_t *)map;
+
+    header->magic = 0;
+    header->reserved = 0;
+    header->shm_offset = (uint64_t)page;
+    atomic_init(&header->producer_offset, 0);
+    atomic_init(&header->consumer_offset, 0);
+
+    object->shm = (buffer_shm_t *)(map + page);
+    object->header = header;
+
+    // A header is only valid when the ring behind it is initialized on the disk
+    msync(map, size, MS_SYNC);
+
+    header->magic = BUFFER_MMAP_MAGIC;
+
+    msync(map, (size_t)page, MS_SYNC);
+
+    return true;
+}
+
+size_t buffer_mmap_read(buffer_mmap_t * object, char * dest, size_t n)
+{
+    if((NULL == object) || (NULL == object->shm) || (NULL == dest)) { return 0; }
+
+    uint64_t size = object->shm->size;
+    uint64_t available = atomic_load_explicit(&object->shm->producer_offset, memory_order_acquire) - object->consumer_offset;
+
+    if(available < n) { n = (size_t)available; }
+
+    uint64_t position = object->consumer_offset % size;
+    size_t first = (size_t)(size - position);
+
+    if(n < first) { first = n; }
+
+    memcpy(dest, BUFFER_MMAP_DATA(object) + position, first);
+    memcpy(dest + first, BUFFER_MMAP_DATA(object), n - first);
+
+    object->consumer_offset += n;
+
+    uint64_t acknowledged = atomic_load_explicit(&object->shm->consumer_offset, memory_order_relaxed);
+
+    // A buffer that was read empty is acknowledged, otherwise a waiting producer would never get space
+    if((available == n) || buffer_mmap_due(object, object->consumer_offset - acknowledged, &object->consumer_time))
+    {
+        buffer_mmap_acknowledge(object);
+    }
+
+    return n;
+}
+
+size_t buffer_mmap_write(buffer_mmap_t * object, const char * src, size_t n)
+{
+    if((NULL == object) || (NULL == object->shm)) { return 0; }
+
+    n = buffer_shm_write(object->shm, src, n);
+
+    uint64_t producer = atomic_load_explicit(&object->shm->producer_offset, memory_order_relaxed);
+
+    if(buffer_mmap_due(object, producer - object->producer_synced, &object->producer_time))
+    {
+        buffer_mmap_commit(object);
+    }
+
+    return n;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
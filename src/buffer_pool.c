@@ -0,0 +1,440 @@
+//! @file
+//! @brief The buffer consumer pool source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_pool.h"
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+#if (BUFFER_POOL_DEQUE < 2) || (0 != (BUFFER_POOL_DEQUE & (BUFFER_POOL_DEQUE - 1)))
+#error BUFFER_POOL_DEQUE must be a power of two
+#endif
+
+//! @brief Mask of the position in ::buffer_pool_deque_s::entries
+#define BUFFER_POOL_DEQUE_MASK ((int64_t)BUFFER_POOL_DEQUE - 1)
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_pool_sc buffer_pool =
+{
+    buffer_pool_attach,
+    buffer_pool_detach,
+    buffer_pool_exit,
+    buffer_pool_init,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static buffer_pool_channel_t * buffer_pool_find(buffer_pool_worker_t * worker, bool * pushed);
+static buffer_pool_channel_t * buffer_pool_next(buffer_pool_worker_t * worker);
+static bool buffer_pool_push(buffer_pool_deque_t * deque, buffer_pool_channel_t * channel);
+static void buffer_pool_queue(buffer_pool_channel_t * channel);
+static bool buffer_pool_ready(const buffer_pool_channel_t * channel);
+static void buffer_pool_run(buffer_pool_channel_t * channel);
+static void buffer_pool_signal(buffer_pool_t * pool);
+static buffer_pool_channel_t * buffer_pool_steal(buffer_pool_deque_t * deque);
+static buffer_pool_channel_t * buffer_pool_take(buffer_pool_deque_t * deque);
+static void buffer_pool_wake(buffer_waiter_t * waiter);
+static int buffer_pool_worker(void * arg);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Returns a channel of the own deque, the injection list or another deque
+//!
+//! @details @p pushed is set if channels of the injection list were put into the own deque,
+//! the caller wakes another worker thread for them after it has released the mutex.
+static buffer_pool_channel_t * buffer_pool_find(buffer_pool_worker_t * worker, bool * pushed)
+{
+    buffer_pool_t * pool = worker->pool;
+
+    buffer_pool_channel_t * channel = buffer_pool_take(&worker->deque);
+
+    if(NULL != channel) { return channel; }
+
+    channel = atomic_exchange(&pool->inject, NULL);
+
+    if(NULL != channel)
+    {
+        // The first channel is run, the others can be stolen from the own deque
+        for(buffer_pool_channel_t * list = channel->next; NULL != list; )
+        {
+            buffer_pool_channel_t * next = list->next;
+
+            if(buffer_pool_push(&worker->deque, list))
+            {
+                *pushed = true;
+            }
+            else
+            {
+                buffer_pool_channel_t * head = atomic_load(&pool->inject);
+                do
+                {
+                    list->next = head;
+                }
+                while(!atomic_compare_exchange_weak(&pool->inject, &head, list));
+            }
+
+            list = next;
+        }
+
+        return channel;
+    }
+
+    for(size_t i = 1; i < pool->count; i++)
+    {
+        buffer_pool_worker_t * victim = &pool->workers[(worker->index + i) % pool->count];
+
+        channel = buffer_pool_steal(&victim->deque);
+
+        if(NULL != channel)
+        {
+            atomic_fetch_add(&worker->steals, 1);
+            return channel;
+        }
+    }
+
+    return NULL;
+}
+
+//! @brief Waits for the next channel, `NULL` if the pool is stopped
+static buffer_pool_channel_t * buffer_pool_next(buffer_pool_worker_t * worker)
+{
+    buffer_pool_t * pool = worker->pool;
+
+    while(!atomic_load(&pool->stop))
+    {
+        bool pushed = false;
+
+        buffer_pool_channel_t * channel = buffer_pool_find(worker, &pushed);
+
+        if(NULL == channel)
+        {
+            mtx_lock(&pool->mutex);
+
+            atomic_fetch_add(&pool->sleeping, 1);
+
+            // A channel queued in the meantime has either seen the sleeping thread or is seen here
+            channel = buffer_pool_find(worker, &pushed);
+
+            if((NULL == channel) && !atomic_load(&pool->stop))
+            {
+                cnd_wait(&pool->condition, &pool->mutex);
+            }
+
+            atomic_fetch_sub(&pool->sleeping, 1);
+
+            mtx_unlock(&pool->mutex);
+        }
+
+        // The signal takes the mutex, it is not called while the mutex is held
+        if(pushed) { buffer_pool_signal(pool); }
+
+        if(NULL != channel) { return channel; }
+    }
+
+    return NULL;
+}
+
+//! @brief Puts a channel at the bottom of the deque, only called by the owner
+static bool buffer_pool_push(buffer_pool_deque_t * deque, buffer_pool_channel_t * channel)
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if((int64_t)BUFFER_POOL_DEQUE <= bottom - top) { return false; }
+
+    atomic_store_explicit(&deque->entries[bottom & BUFFER_POOL_DEQUE_MASK], channel, memory_order_relaxed);
+
+    // The entry is visible before the thieves see the new bottom
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+    return true;
+}
+
+//! @brief Claims the channel and puts it into the injection list, can be called in any thread
+static void buffer_pool_queue(buffer_pool_channel_t * channel)
+{
+    // Already queued or running
+    if(atomic_exchange(&channel->claimed, true)) { return; }
+
+    buffer_pool_t * pool = channel->pool;
+
+    buffer_pool_channel_t * head = atomic_load(&pool->inject);
+    do
+    {
+        channel->next = head;
+    }
+    while(!atomic_compare_exchange_weak(&pool->inject, &head, channel));
+
+    buffer_pool_signal(pool);
+}
+
+//! @brief Returns whether the buffer object of the channel has characters for the handler
+static bool buffer_pool_ready(const buffer_pool_channel_t * channel)
+{
+    if(BUFFER_FLAGS_IDLE > atomic_load(&channel->object->state)) { return false; }
+
+    if(BUFFER_WAIT_LINE == channel->event)
+    {
+        return 0 < buffer_lines(channel->object);
+    }
+
+    return 0 < buffer_length(channel->object);
+}
+
+//! @brief Runs the handler, releases the channel and arms the waiter again
+static void buffer_pool_run(buffer_pool_channel_t * channel)
+{
+    if(atomic_load(&channel->attached))
+    {
+        channel->handler(channel);
+    }
+
+    atomic_store(&channel->claimed, false);
+
+    if(!atomic_load(&channel->attached)) { return; }
+
+    if(buffer_waiter_arm(channel->object, channel->event, &channel->waiter))
+    {
+        // A detach in the meantime has either removed the waiter or is seen here
+        if(!atomic_load(&channel->attached))
+        {
+            buffer_waiter_cancel(channel->object, channel->event, &channel->waiter);
+        }
+    }
+    else if(buffer_pool_ready(channel))
+    {
+        // Characters remain, the channel is queued behind the other channels
+        buffer_pool_queue(channel);
+    }
+}
+
+//! @brief Wakes a sleeping worker thread
+static void buffer_pool_signal(buffer_pool_t * pool)
+{
+    // The queued channel is visible before the sleeping threads are counted
+    atomic_thread_fence(memory_order_seq_cst);
+
+    // A mutex is only needed to wake a sleeping worker thread
+    if(0 < atomic_load(&pool->sleeping))
+    {
+        mtx_lock(&pool->mutex);
+        cnd_signal(&pool->condition);
+        mtx_unlock(&pool->mutex);
+    }
+}
+
+//! @brief Takes a channel from the top of another deque
+static buffer_pool_channel_t * buffer_pool_steal(buffer_pool_deque_t * deque)
+{
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    atomic_thread_fence(memory_order_seq_cst);
+
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if(bottom <= top) { return NULL; }
+
+    buffer_pool_channel_t * channel = atomic_load_explicit(&deque->entries[top & BUFFER_POOL_DEQUE_MASK], memory_order_relaxed);
+
+    // Lost against the owner or another thief
+    if(!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        return NULL;
+    }
+
+    return channel;
+}
+
+//! @brief Takes a channel from the bottom of the own deque, only called by the owner
+static buffer_pool_channel_t * buffer_pool_take(buffer_pool_deque_t * deque)
+{
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_seq_cst);
+
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if(bottom < top)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    buffer_pool_channel_t * channel = atomic_load_explicit(&deque->entries[bottom & BUFFER_POOL_DEQUE_MASK], memory_order_relaxed);
+
+    if(top == bottom)
+    {
+        // The last entry, a thief may take it at the same time
+        if(!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            channel = NULL;
+        }
+
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+
+    return channel;
+}
+
+//! @brief Called by the producer/set thread on the transition
+static void buffer_pool_wake(buffer_waiter_t * waiter)
+{
+    buffer_pool_queue((buffer_pool_channel_t *)waiter->context);
+}
+
+static int buffer_pool_worker(void * arg)
+{
+    buffer_pool_worker_t * worker = (buffer_pool_worker_t *)arg;
+
+    buffer_pool_channel_t * channel;
+
+    while(NULL != (channel = buffer_pool_next(worker)))
+    {
+        atomic_fetch_add(&worker->runs, 1);
+
+        buffer_pool_run(channel);
+    }
+
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+bool buffer_pool_attach(buffer_pool_t * pool, buffer_pool_channel_t * channel, buffer_t * object, buffer_wait_event_t event, buffer_pool_handler_t handler, void * context)
+{
+    if((NULL == pool) || (NULL == channel) || (NULL == object) || (NULL == handler)) { return false; }
+
+    if((BUFFER_WAIT_DATA != event) && (BUFFER_WAIT_LINE != event)) { return false; }
+
+    channel->waiter.wake = buffer_pool_wake;
+    channel->waiter.context = channel;
+    channel->waiter.seen = 0;
+    channel->next = NULL;
+    channel->pool = pool;
+    channel->object = object;
+    channel->handler = handler;
+    channel->context = context;
+    channel->event = event;
+    atomic_init(&channel->claimed, false);
+    atomic_init(&channel->attached, true);
+
+    if(!buffer_waiter_arm(object, event, &channel->waiter))
+    {
+        if(buffer_pool_ready(channel))
+        {
+            buffer_pool_queue(channel);
+        }
+    }
+
+    return true;
+}
+
+bool buffer_pool_detach(buffer_pool_channel_t * channel)
+{
+    if(NULL == channel) { return false; }
+
+    atomic_store(&channel->attached, false);
+
+    return buffer_waiter_cancel(channel->object, channel->event, &channel->waiter);
+}
+
+void buffer_pool_exit(buffer_pool_t * pool)
+{
+    if(NULL == pool) { return; }
+
+    mtx_lock(&pool->mutex);
+    atomic_store(&pool->stop, true);
+    cnd_broadcast(&pool->condition);
+    mtx_unlock(&pool->mutex);
+
+    for(size_t i = 0; i < pool->count; i++)
+    {
+        thrd_join(pool->threads[i], NULL);
+    }
+
+    pool->count = 0;
+
+    cnd_destroy(&pool->condition);
+    mtx_destroy(&pool->mutex);
+}
+
+bool buffer_pool_init(buffer_pool_t * pool, size_t threads)
+{
+    if(NULL == pool) { return false; }
+
+    atomic_init(&pool->inject, NULL);
+    atomic_init(&pool->sleeping, 0);
+    atomic_init(&pool->stop, false);
+    pool->count = 0;
+
+    if(BUFFER_POOL_THREADS < threads) { threads = BUFFER_POOL_THREADS; }
+
+    for(size_t i = 0; i < threads; i++)
+    {
+        buffer_pool_worker_t * worker = &pool->workers[i];
+
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        worker->pool = pool;
+        worker->index = i;
+        atomic_init(&worker->runs, 0);
+        atomic_init(&worker->steals, 0);
+    }
+
+    if(thrd_success != mtx_init(&pool->mutex, mtx_plain)) { return false; }
+
+    if(thrd_success != cnd_init(&pool->condition))
+    {
+        mtx_destroy(&pool->mutex);
+        return false;
+    }
+
+    // The deques of all workers are initialized, the count is not changed while they run
+    pool->count = threads;
+
+    for(size_t i = 0; i < threads; i++)
+    {
+        if(thrd_success != thrd_create(&pool->threads[i], buffer_pool_worker, &pool->workers[i]))
+        {
+            pool->count = i;
+            buffer_pool_exit(pool);
+            return false;
+        }
+    }
+
+    return 0 < pool->count;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,314 @@
+//! @file
+//! @brief The sharded buffer source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_shard.h"
+#include "buffer_until.h"
+
+#include <string.h> // memcpy
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+#if (BUFFER_SHARD_COUNT < 1) || (BUFFER_SHARD_BATCH < 1)
+#error BUFFER_SHARD_COUNT and BUFFER_SHARD_BATCH must be at least 1
+#endif
+
+//! @brief Number of bytes of the timestamp in front of the payload
+#define BUFFER_SHARD_TIMESTAMP_SIZE (sizeof(uint64_t))
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Records of a shard read during one drain, they are released together
+typedef struct buffer_shard_cursor_s
+{
+    const char * span; ///< The readable bytes of the shard
+    size_t available;  ///< Number of readable bytes
+    size_t offset;     ///< Number of bytes read
+    size_t records;    ///< Number of records read
+}buffer_shard_cursor_t;
+
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_shard_sc buffer_shard =
+{
+    buffer_shard_drain,
+    buffer_shard_init,
+    buffer_shard_length,
+    buffer_shard_push,
+    buffer_shard_push_at,
+    buffer_shard_stop_force,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static size_t buffer_shard_merge(buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max);
+static bool buffer_shard_next(buffer_shard_cursor_t * cursor, uint64_t * timestamp, const char ** payload, size_t * n);
+static void buffer_shard_open(buffer_shard_t * object, size_t index, buffer_shard_cursor_t * cursor);
+static void buffer_shard_release(buffer_shard_t * object, size_t index, const buffer_shard_cursor_t * cursor);
+static size_t buffer_shard_rotate(buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max);
+static void buffer_shard_skip(buffer_shard_cursor_t * cursor, size_t n);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Reads the records in the order of their timestamps
+static size_t buffer_shard_merge(buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max)
+{
+    buffer_shard_cursor_t cursors[BUFFER_SHARD_COUNT];
+    uint64_t timestamps[BUFFER_SHARD_COUNT];
+    const char * payloads[BUFFER_SHARD_COUNT];
+    size_t lengths[BUFFER_SHARD_COUNT];
+    bool heads[BUFFER_SHARD_COUNT];
+
+    // Each shard is exposed once, afterwards only the cursor of the shard that was read moves
+    for(size_t i = 0; i < object->count; i++)
+    {
+        buffer_shard_open(object, i, &cursors[i]);
+
+        heads[i] = buffer_shard_next(&cursors[i], &timestamps[i], &payloads[i], &lengths[i]);
+    }
+
+    size_t read = 0;
+
+    while(read < max)
+    {
+        size_t oldest = BUFFER_SHARD_COUNT;
+
+        for(size_t i = 0; i < object->count; i++)
+        {
+            if(heads[i] && ((BUFFER_SHARD_COUNT == oldest) || (timestamps[i] < timestamps[oldest])))
+            {
+                oldest = i;
+            }
+        }
+
+        if(BUFFER_SHARD_COUNT == oldest) { break; }
+
+        handler(context, oldest, timestamps[oldest], payloads[oldest], lengths[oldest]);
+
+        buffer_shard_skip(&cursors[oldest], lengths[oldest]);
+        read++;
+
+        heads[oldest] = buffer_shard_next(&cursors[oldest], &timestamps[oldest], &payloads[oldest], &lengths[oldest]);
+    }
+
+    for(size_t i = 0; i < object->count; i++)
+    {
+        buffer_shard_release(object, i, &cursors[i]);
+    }
+
+    return read;
+}
+
+//! @brief Returns the record at the cursor without moving it
+static bool buffer_shard_next(buffer_shard_cursor_t * cursor, uint64_t * timestamp, const char ** payload, size_t * n)
+{
+    while(BUFFER_RECORD_HEADER_SIZE <= (cursor->available - cursor->offset))
+    {
+        const char * ptr = cursor->span + cursor->offset;
+
+        // The records are not aligned in the buffer
+        size_t length;
+        memcpy(&length, ptr, BUFFER_RECORD_HEADER_SIZE);
+
+        if((cursor->available - cursor->offset - BUFFER_RECORD_HEADER_SIZE) < length) { return false; }
+
+        ptr += BUFFER_RECORD_HEADER_SIZE;
+
+        if(BUFFER_SHARD_TIMESTAMP_SIZE <= length)
+        {
+            memcpy(timestamp, ptr, BUFFER_SHARD_TIMESTAMP_SIZE);
+
+            *payload = ptr + BUFFER_SHARD_TIMESTAMP_SIZE;
+            *n = length - BUFFER_SHARD_TIMESTAMP_SIZE;
+
+            return true;
+        }
+
+        // Not written by ::buffer_shard_push_at()
+        cursor->offset += BUFFER_RECORD_HEADER_SIZE + length;
+        cursor->records++;
+    }
+
+    return false;
+}
+
+//! @brief Exposes the readable records of a shard
+static void buffer_shard_open(buffer_shard_t * object, size_t index, buffer_shard_cursor_t * cursor)
+{
+    cursor->available = buffer_read_span(&object->lanes[index].buffer, &cursor->span);
+    cursor->offset = 0;
+    cursor->records = 0;
+}
+
+//! @brief Removes the records read with the cursor at once
+static void buffer_shard_release(buffer_shard_t * object, size_t index, const buffer_shard_cursor_t * cursor)
+{
+    if(0 < cursor->offset)
+    {
+        buffer_pop_records(&object->lanes[index].buffer, cursor->offset, cursor->records);
+    }
+}
+
+//! @brief Reads batches of records shard by shard
+static size_t buffer_shard_rotate(buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max)
+{
+    size_t read = 0;
+
+    for(size_t visited = 0; (visited < object->count) && (read < max); visited++)
+    {
+        size_t index = object->cursor;
+        size_t batch = 0;
+
+        buffer_shard_cursor_t cursor;
+        uint64_t timestamp;
+        const char * payload;
+        size_t n;
+
+        buffer_shard_open(object, index, &cursor);
+
+        while((batch < BUFFER_SHARD_BATCH) && (read < max) && buffer_shard_next(&cursor, &timestamp, &payload, &n))
+        {
+            handler(context, index, timestamp, payload, n);
+
+            buffer_shard_skip(&cursor, n);
+            batch++;
+            read++;
+        }
+
+        buffer_shard_release(object, index, &cursor);
+
+        // A shard that was stopped by the maximum is continued in the next call
+        if((read < max) || (BUFFER_SHARD_BATCH == batch))
+        {
+            object->cursor = (index + 1) % object->count;
+        }
+    }
+
+    return read;
+}
+
+//! @brief Moves the cursor behind the record with a payload of @p n bytes
+static void buffer_shard_skip(buffer_shard_cursor_t * cursor, size_t n)
+{
+    cursor->offset += BUFFER_RECORD_HEADER_SIZE + BUFFER_SHARD_TIMESTAMP_SIZE + n;
+    cursor->records++;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+size_t buffer_shard_drain(buffer_shard_t * object, buffer_shard_handler_t handler, void * context, size_t max)
+{
+    if((NULL == object) || (NULL == handler) || (0 == object->count)) { return 0; }
+
+    if(BUFFER_SHARD_TIMESTAMP == object->order)
+    {
+        return buffer_shard_merge(object, handler, context, max);
+    }
+
+    return buffer_shard_rotate(object, handler, context, max);
+}
+
+bool buffer_shard_init(buffer_shard_t * object, char * data, size_t sizeof_data, size_t count, buffer_shard_order_t order, bool start)
+{
+    if(NULL == object) { return false; }
+
+    object->count = 0;
+    object->cursor = 0;
+    object->order = order;
+
+    if((NULL == data) || (0 == count) || (BUFFER_SHARD_COUNT < count)) { return false; }
+
+    size_t part = sizeof_data / count;
+
+    if(part < (BUFFER_RECORD_HEADER_SIZE + BUFFER_SHARD_TIMESTAMP_SIZE)) { return false; }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        buffer_init(&object->lanes[i].buffer, data + (i * part), part, start);
+    }
+
+    object->count = count;
+
+    return true;
+}
+
+size_t buffer_shard_length(const buffer_shard_t * object)
+{
+    if(NULL == object) { return 0; }
+
+    size_t length = 0;
+
+    for(size_t i = 0; i < object->count; i++)
+    {
+        length += buffer_length(&object->lanes[i].buffer);
+    }
+
+    return length;
+}
+
+bool buffer_shard_push(buffer_shard_t * object, size_t index, const void * src, size_t n)
+{
+    return buffer_shard_push_at(object, index, buffer_until_now(), src, n);
+}
+
+bool buffer_shard_push_at(buffer_shard_t * object, size_t index, uint64_t timestamp, const void * src, size_t n)
+{
+    if((NULL == object) || (object->count <= index)) { return false; }
+
+    if(((NULL == src) && (0 != n)) || (BUFFER_SHARD_RECORD < n)) { return false; }
+
+    buffer_t * lane = &object->lanes[index].buffer;
+
+    // The record is written in place
+    char * record = (char *)buffer_push_record_reserve(lane, BUFFER_SHARD_TIMESTAMP_SIZE + n);
+
+    if(NULL == record) { return false; }
+
+    memcpy(record, &timestamp, BUFFER_SHARD_TIMESTAMP_SIZE);
+
+    if(0 != n) { memcpy(record + BUFFER_SHARD_TIMESTAMP_SIZE, src, n); }
+
+    return buffer_push_record_commit(lane, record);
+}
+
+bool buffer_shard_stop_force(buffer_shard_t * object)
+{
+    if(NULL == object) { return false; }
+
+    bool stopped = true;
+
+    for(size_t i = 0; i < object->count; i++)
+    {
+        stopped = buffer_stop_force(&object->lanes[i].buffer) && stopped;
+    }
+
+    return stopped;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,390 @@
+//! @file
+//! @brief The process-shared buffer source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE)
+#define _DEFAULT_SOURCE // syscall
+#endif
+
+#include "buffer_shm.h"
+
+#include <string.h> // memcpy
+
+#if defined(__linux__)
+  #include <limits.h>      // INT_MAX
+  #include <linux/futex.h> // FUTEX_WAIT, FUTEX_WAKE
+  #include <sys/syscall.h> // SYS_futex
+  #include <unistd.h>      // syscall
+  #include <time.h>        // timespec
+#else
+  #include <threads.h>     // thrd_sleep
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+//! @brief Offset of the ring, the structure rounded up to a cache line
+#define BUFFER_SHM_DATA_OFFSET ((sizeof(buffer_shm_t) + (BUFFER_CACHE_LINE_SIZE - 1)) / BUFFER_CACHE_LINE_SIZE * BUFFER_CACHE_LINE_SIZE)
+
+//! @brief Start of the ring in the address space of the calling process
+#define BUFFER_SHM_DATA(OBJECT) ((char *)(OBJECT) + (OBJECT)->data_offset)
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_shm_sc buffer_shm =
+{
+    buffer_shm_attach,
+    buffer_shm_init,
+    buffer_shm_length,
+    buffer_shm_read,
+    buffer_shm_read_consume,
+    buffer_shm_read_span,
+    buffer_shm_space,
+    buffer_shm_start,
+    buffer_shm_stop,
+    buffer_shm_wait_data,
+    buffer_shm_wait_space,
+    buffer_shm_write,
+    buffer_shm_write_commit,
+    buffer_shm_write_reserve,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static void buffer_shm_notify(volatile _Atomic(uint32_t) * sequence, volatile _Atomic(uint32_t) * sleeping);
+static void buffer_shm_sleep(volatile _Atomic(uint32_t) * sequence, uint32_t value, uint64_t timeout);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Wakes the sleeping threads of the other side, in any process
+static void buffer_shm_notify(volatile _Atomic(uint32_t) * sequence, volatile _Atomic(uint32_t) * sleeping)
+{
+    // The new position is visible before the sleeping threads are counted
+    atomic_thread_fence(memory_order_seq_cst);
+
+    // Only a sleeping thread costs a system call
+    if(0 < atomic_load(sleeping))
+    {
+        atomic_fetch_add(sequence, 1);
+
+#if defined(__linux__)
+        // Not private, the futex is found by the shared page in all processes
+        syscall(SYS_futex, (uint32_t *)sequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+    }
+}
+
+//! @brief Sleeps until @p sequence differs from @p value or @p timeout nanoseconds have passed
+static void buffer_shm_sleep(volatile _Atomic(uint32_t) * sequence, uint32_t value, uint64_t timeout)
+{
+#if defined(__linux__)
+    struct timespec ts = { (time_t)(timeout / UINT64_C(1000000000)), (long)(timeout % UINT64_C(1000000000)) };
+
+    // Returns immediately if the other side has already changed the value
+    syscall(SYS_futex, (uint32_t *)sequence, FUTEX_WAIT, value, &ts, NULL, 0);
+#else
+    (void)sequence;
+    (void)value;
+
+    if(BUFFER_UNTIL_SLEEP_NS < timeout) { timeout = BUFFER_UNTIL_SLEEP_NS; }
+
+    struct timespec ts = { 0, (long)timeout };
+
+    thrd_sleep(&ts, NULL);
+#endif
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+buffer_shm_t * buffer_shm_attach(void * memory, size_t sizeof_memory)
+{
+    if((NULL == memory) || (sizeof_memory < BUFFER_SHM_DATA_OFFSET)) { return NULL; }
+
+    buffer_shm_t * object = (buffer_shm_t *)memory;
+
+    if(BUFFER_SHM_MAGIC != atomic_load(&object->magic)) { return NULL; }
+
+    // The segment of the other process must not be larger than the own mapping
+    if((object->data_offset < BUFFER_SHM_DATA_OFFSET) || (sizeof_memory < object->data_offset) || ((sizeof_memory - object->data_offset) < object->size))
+    {
+        return NULL;
+    }
+
+    return object;
+}
+
+bool buffer_shm_init(void * memory, size_t sizeof_memory, bool start)
+{
+    if((NULL == memory) || (sizeof_memory <= BUFFER_SHM_DATA_OFFSET)) { return false; }
+
+    buffer_shm_t * object = (buffer_shm_t *)memory;
+
+    atomic_init(&object->magic, 0);
+    atomic_init(&object->running, start ? 1 : 0);
+    object->size = sizeof_memory - BUFFER_SHM_DATA_OFFSET;
+    object->data_offset = BUFFER_SHM_DATA_OFFSET;
+    atomic_init(&object->producer_offset, 0);
+    atomic_init(&object->data_sequence, 0);
+    atomic_init(&object->data_sleeping, 0);
+    atomic_init(&object->consumer_offset, 0);
+    atomic_init(&object->space_sequence, 0);
+    atomic_init(&object->space_sleeping, 0);
+
+    // The other process only attaches to a complete structure
+    atomic_store(&object->magic, BUFFER_SHM_MAGIC);
+
+    return true;
+}
+
+size_t buffer_shm_length(const buffer_shm_t * object)
+{
+    if(NULL == object) { return 0; }
+
+    uint64_t consumer = atomic_load(&object->consumer_offset);
+
+    return (size_t)(atomic_load(&object->producer_offset) - consumer);
+}
+
+size_t buffer_shm_read(buffer_shm_t * object, char * dest, size_t n)
+{
+    if((NULL == object) || (NULL == dest)) { return 0; }
+
+    size_t read = 0;
+
+    // At most two spans, the end and the start of the ring
+    for(size_t i = 0; (i < 2) && (read < n); i++)
+    {
+        const char * span;
+        size_t length = buffer_shm_read_span(object, &span);
+
+        if(0 == length) { break; }
+
+        if((n - read) < length) { length = n - read; }
+
+        memcpy(dest + read, span, length);
+
+        read += buffer_shm_read_consume(object, length);
+    }
+
+    return read;
+}
+
+size_t buffer_shm_read_consume(buffer_shm_t * object, size_t n)
+{
+    if((NULL == object) || (0 == n)) { return 0; }
+
+    uint64_t consumer = atomic_load_explicit(&object->consumer_offset, memory_order_relaxed);
+    uint64_t available = atomic_load_explicit(&object->producer_offset, memory_order_acquire) - consumer;
+
+    if(available < n) { n = (size_t)available; }
+
+    // The bytes are read before the producer may overwrite them
+    atomic_store_explicit(&object->consumer_offset, consumer + n, memory_order_release);
+
+    buffer_shm_notify(&object->space_sequence, &object->space_sleeping);
+
+    return n;
+}
+
+size_t buffer_shm_read_span(buffer_shm_t * object, const char ** span)
+{
+    if(NULL == span) { return 0; }
+
+    *span = NULL;
+
+    if((NULL == object) || (0 == atomic_load(&object->running))) { return 0; }
+
+    uint64_t consumer = atomic_load_explicit(&object->consumer_offset, memory_order_relaxed);
+    uint64_t available = atomic_load_explicit(&object->producer_offset, memory_order_acquire) - consumer;
+
+    if(0 == available) { return 0; }
+
+    uint64_t position = consumer % object->size;
+    uint64_t contiguous = object->size - position;
+
+    *span = BUFFER_SHM_DATA(object) + position;
+
+    return (size_t)((available < contiguous) ? available : contiguous);
+}
+
+size_t buffer_shm_space(const buffer_shm_t * object)
+{
+    if(NULL == object) { return 0; }
+
+    uint64_t producer = atomic_load(&object->producer_offset);
+
+    return (size_t)(object->size - (producer - atomic_load(&object->consumer_offset)));
+}
+
+bool buffer_shm_start(buffer_shm_t * object)
+{
+    if(NULL == object) { return false; }
+
+    atomic_store(&object->running, 1);
+
+    return true;
+}
+
+bool buffer_shm_stop(buffer_shm_t * object)
+{
+    if(NULL == object) { return false; }
+
+    bool running = (0 != atomic_exchange(&object->running, 0));
+
+    // The sleeping threads see the stopped buffer
+    buffer_shm_notify(&object->data_sequence, &object->data_sleeping);
+    buffer_shm_notify(&object->space_sequence, &object->space_sleeping);
+
+    return running;
+}
+
+buffer_until_status_t buffer_shm_wait_data(buffer_shm_t * object, uint64_t deadline)
+{
+    if(NULL == object) { return BUFFER_UNTIL_STOPPED; }
+
+    while(true)
+    {
+        if(0 == atomic_load(&object->running)) { return BUFFER_UNTIL_STOPPED; }
+
+        if(0 < buffer_shm_length(object)) { return BUFFER_UNTIL_OK; }
+
+        uint64_t now = buffer_until_now();
+
+        if(deadline <= now) { return BUFFER_UNTIL_TIMEOUT; }
+
+        atomic_fetch_add(&object->data_sleeping, 1);
+
+        uint32_t sequence = atomic_load(&object->data_sequence);
+
+        // Data published in the meantime has either seen the sleeping thread or is seen here
+        if((0 == buffer_shm_length(object)) && (0 != atomic_load(&object->running)))
+        {
+            buffer_shm_sleep(&object->data_sequence, sequence, deadline - now);
+        }
+
+        atomic_fetch_sub(&object->data_sleeping, 1);
+    }
+}
+
+buffer_until_status_t buffer_shm_wait_space(buffer_shm_t * object, size_t n, uint64_t deadline)
+{
+    if((NULL == object) || (object->size < n)) { return BUFFER_UNTIL_STOPPED; }
+
+    while(true)
+    {
+        if(0 == atomic_load(&object->running)) { return BUFFER_UNTIL_STOPPED; }
+
+        if(n <= buffer_shm_space(object)) { return BUFFER_UNTIL_OK; }
+
+        uint64_t now = buffer_until_now();
+
+        if(deadline <= now) { return BUFFER_UNTIL_TIMEOUT; }
+
+        atomic_fetch_add(&object->space_sleeping, 1);
+
+        uint32_t sequence = atomic_load(&object->space_sequence);
+
+        // Space returned in the meantime has either seen the sleeping thread or is seen here
+        if((buffer_shm_space(object) < n) && (0 != atomic_load(&object->running)))
+        {
+            buffer_shm_sleep(&object->space_sequence, sequence, deadline - now);
+        }
+
+        atomic_fetch_sub(&object->space_sleeping, 1);
+    }
+}
+
+size_t buffer_shm_write(buffer_shm_t * object, const char * src, size_t n)
+{
+    if((NULL == object) || (NULL == src)) { return 0; }
+
+    uint64_t producer = atomic_load_explicit(&object->producer_offset, memory_order_relaxed);
+    uint64_t space = object->size - (producer - atomic_load_explicit(&object->consumer_offset, memory_order_acquire));
+
+    if((0 == atomic_load(&object->running)) || (0 == space)) { return 0; }
+
+    if(space < n) { n = (size_t)space; }
+
+    uint64_t position = producer % object->size;
+    size_t first = (size_t)(object->size - position);
+
+    if(n < first) { first = n; }
+
+    memcpy(BUFFER_SHM_DATA(object) + position, src, first);
+    memcpy(BUFFER_SHM_DATA(object), src + first, n - first);
+
+    // Both parts are published with one update
+    atomic_store_explicit(&object->producer_offset, producer + n, memory_order_release);
+
+    buffer_shm_notify(&object->data_sequence, &object->data_sleeping);
+
+    return n;
+}
+
+size_t buffer_shm_write_commit(buffer_shm_t * object, size_t n)
+{
+    if((NULL == object) || (0 == n)) { return 0; }
+
+    uint64_t producer = atomic_load_explicit(&object->producer_offset, memory_order_relaxed);
+    uint64_t space = object->size - (producer - atomic_load_explicit(&object->consumer_offset, memory_order_acquire));
+    uint64_t contiguous = object->size - (producer % object->size);
+
+    if(space < n) { n = (size_t)space; }
+    if(contiguous < n) { n = (size_t)contiguous; }
+
+    // The bytes of the span are visible before the new position
+    atomic_store_explicit(&object->producer_offset, producer + n, memory_order_release);
+
+    buffer_shm_notify(&object->data_sequence, &object->data_sleeping);
+
+    return n;
+}
+
+size_t buffer_shm_write_reserve(buffer_shm_t * object, char ** span)
+{
+    if(NULL == span) { return 0; }
+
+    *span = NULL;
+
+    if((NULL == object) || (0 == atomic_load(&object->running))) { return 0; }
+
+    uint64_t producer = atomic_load_explicit(&object->producer_offset, memory_order_relaxed);
+    uint64_t space = object->size - (producer - atomic_load_explicit(&object->consumer_offset, memory_order_acquire));
+
+    if(0 == space) { return 0; }
+
+    uint64_t position = producer % object->size;
+    uint64_t contiguous = object->size - position;
+
+    *span = BUFFER_SHM_DATA(object) + position;
+
+    return (size_t)((space < contiguous) ? space : contiguous);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,220 @@
+//! @file
+//! @brief The buffer slot queue source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_slot.h"
+
+#include <string.h> // memcpy
+#include <stdint.h> // uintptr_t
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+#if (0 != (BUFFER_SLOT_ALIGNMENT & (BUFFER_SLOT_ALIGNMENT - 1)))
+#error BUFFER_SLOT_ALIGNMENT must be a power of two
+#endif
+
+//! @brief Rounds @p N up to a multiple of ::BUFFER_SLOT_ALIGNMENT
+#define BUFFER_SLOT_ALIGN(N) (((N) + (BUFFER_SLOT_ALIGNMENT - 1)) & ~((size_t)BUFFER_SLOT_ALIGNMENT - 1))
+
+//! @brief Offset of the payload within a slot
+#define BUFFER_SLOT_PAYLOAD_OFFSET BUFFER_SLOT_ALIGN(sizeof(buffer_slot_header_t))
+
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_slot_sc buffer_slot =
+{
+    buffer_slot_count,
+    buffer_slot_init,
+    buffer_slot_pop,
+    buffer_slot_pop_batch,
+    buffer_slot_push,
+    buffer_slot_push_batch,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static buffer_slot_header_t * buffer_slot_at(const buffer_slot_t * object, size_t position);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+static buffer_slot_header_t * buffer_slot_at(const buffer_slot_t * object, size_t position)
+{
+    return (buffer_slot_header_t *)(object->slots + ((position & object->mask) * object->stride));
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+size_t buffer_slot_count(const buffer_slot_t * object)
+{
+    if((NULL == object) || (NULL == object->slots)){ return 0; }
+
+    return object->mask + 1;
+}
+
+bool buffer_slot_init(buffer_slot_t * object, char * data, size_t sizeof_data, size_t payload_size, bool start)
+{
+    if(NULL == object){ return false; }
+
+    object->slots = NULL;
+    object->stride = BUFFER_SLOT_PAYLOAD_OFFSET + BUFFER_SLOT_ALIGN(payload_size);
+    object->payload_size = payload_size;
+    object->mask = 0;
+    object->head = 0;
+    object->tail = 0;
+
+    buffer_init(&object->buffer, data, sizeof_data, false);
+
+    if(NULL == data){ return false; }
+
+    // The first slot is aligned, the bytes before it are not used
+    size_t skip = (size_t)((BUFFER_SLOT_ALIGNMENT - ((uintptr_t)data & (BUFFER_SLOT_ALIGNMENT - 1))) & (BUFFER_SLOT_ALIGNMENT - 1));
+
+    if(sizeof_data < (skip + object->stride)){ return false; }
+
+    size_t count = (sizeof_data - skip) / object->stride;
+
+    size_t slots = 1;
+    while((slots * 2) <= count)
+    {
+        slots *= 2;
+    }
+
+    object->slots = data + skip;
+    object->mask = slots - 1;
+
+    for(size_t i = 0; i < slots; i++)
+    {
+        atomic_init(&buffer_slot_at(object, i)->sequence, i);
+    }
+
+    if(start)
+    {
+        buffer_start(&object->buffer);
+    }
+
+    return true;
+}
+
+bool buffer_slot_pop(buffer_slot_t * object, void * dest)
+{
+    return 1 == buffer_slot_pop_batch(object, dest, 1);
+}
+
+size_t buffer_slot_pop_batch(buffer_slot_t * object, void * dest, size_t n)
+{
+    if((NULL == object) || (NULL == dest)) { return 0; }
+
+    size_t i = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL))
+    {
+        size_t position = object->tail;
+
+        for(i = 0; i < n; i++)
+        {
+            buffer_slot_header_t * slot = buffer_slot_at(object, position);
+
+            if((position + 1) != atomic_load_explicit(&slot->sequence, memory_order_acquire))
+            {
+                break; // Empty
+            }
+
+            memcpy((char *)dest + (i * object->payload_size), (char *)slot + BUFFER_SLOT_PAYLOAD_OFFSET, object->payload_size);
+
+            // The slot is free again for the producer in the next round
+            atomic_store_explicit(&slot->sequence, position + object->mask + 1, memory_order_release);
+
+            position++;
+        }
+
+        object->tail = position;
+
+#ifdef BUFFER_ENABLE_HANDLER
+        if((0 < i) && object->buffer.on_empty)
+        {
+            if((position + 1) != atomic_load_explicit(&buffer_slot_at(object, position)->sequence, memory_order_acquire))
+            {
+                object->buffer.on_empty(&object->buffer);
+            }
+        }
+#endif
+    }
+
+    atomic_fetch_sub(&object->buffer.state, BUFFER_FLAGS_RUNNING_GET_AVAILABLE_OR_NULL);
+    return i;
+}
+
+bool buffer_slot_push(buffer_slot_t * object, const void * src)
+{
+    return 1 == buffer_slot_push_batch(object, src, 1);
+}
+
+size_t buffer_slot_push_batch(buffer_slot_t * object, const void * src, size_t n)
+{
+    if((NULL == object) || (NULL == src)) { return 0; }
+
+    size_t i = 0;
+
+    if(BUFFER_FLAGS_IDLE <= atomic_fetch_add(&object->buffer.state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP))
+    {
+        size_t position = object->head;
+
+        for(i = 0; i < n; i++)
+        {
+            buffer_slot_header_t * slot = buffer_slot_at(object, position);
+
+            if(position != atomic_load_explicit(&slot->sequence, memory_order_acquire))
+            {
+#ifdef BUFFER_ENABLE_HANDLER
+                if(object->buffer.on_full) { object->buffer.on_full(&object->buffer, '\0'); }
+#endif
+                break; // Full
+            }
+
+            memcpy((char *)slot + BUFFER_SLOT_PAYLOAD_OFFSET, (const char *)src + (i * object->payload_size), object->payload_size);
+
+            atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+            position++;
+
+#ifdef BUFFER_ENABLE_HANDLER
+            if(object->buffer.on_new_line) { object->buffer.on_new_line(&object->buffer); }
+#endif
+        }
+
+        object->head = position;
+    }
+
+    atomic_fetch_sub(&object->buffer.state, BUFFER_FLAGS_RUNNING_SET_POSSIBLE_OR_SKIP);
+    return i;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,263 @@
+//! @file
+//! @brief The buffer pipeline stage source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_stage.h"
+#include "buffer_until.h"
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_stage_sc buffer_stage =
+{
+    buffer_stage_attach,
+    buffer_stage_detach,
+    buffer_stage_init,
+    buffer_stage_stats,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static void buffer_stage_arm(buffer_stage_t * stage, buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter);
+static void buffer_stage_run(buffer_task_t * task);
+static void buffer_stage_wake(buffer_waiter_t * waiter);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Arms a waiter of the stage, queues the stage if the condition is already fulfilled
+static void buffer_stage_arm(buffer_stage_t * stage, buffer_t * object, buffer_wait_event_t event, buffer_waiter_t * waiter)
+{
+    if(buffer_waiter_arm(object, event, waiter))
+    {
+        // A detach in the meantime has either removed the waiter or is seen here
+        if(!atomic_load(&stage->attached))
+        {
+            buffer_waiter_cancel(object, event, waiter);
+        }
+    }
+    else if(BUFFER_FLAGS_IDLE <= atomic_load(&object->state))
+    {
+        buffer_executor_submit(stage->executor, &stage->task);
+    }
+}
+
+//! @brief Passes the input to the transform function until the input is empty, the output is full or the batch is done
+static void buffer_stage_run(buffer_task_t * task)
+{
+    buffer_stage_t * stage = (buffer_stage_t *)task->context;
+
+    if(!atomic_load(&stage->attached)) { return; }
+
+    uint64_t start = buffer_until_now();
+
+    size_t bytes_in = 0;
+    size_t bytes_out = 0;
+    size_t seen = 0;
+    size_t room = 0;
+    bool full = false;
+
+    while(bytes_in < BUFFER_STAGE_BATCH)
+    {
+        const char * src;
+        size_t n = buffer_read_span(stage->input, &src);
+
+        if(0 == n) { break; }
+
+        char * dest = NULL;
+        size_t space = 0;
+
+        if(NULL != stage->output)
+        {
+            space = buffer_write_reserve(stage->output, &dest);
+
+            // The input is left unread, the previous stage is slowed down by it
+            if(0 == space)
+            {
+                full = true;
+                break;
+            }
+        }
+
+        size_t consumed = 0;
+        size_t written = stage->transform(stage, src, n, dest, space, &consumed);
+
+        if(space < written) { written = space; }
+        if(n < consumed) { consumed = n; }
+
+        if(NULL != stage->output)
+        {
+            buffer_write_commit(stage->output, dest, written);
+        }
+
+        buffer_read_consume(stage->input, consumed);
+
+        bytes_in += consumed;
+        bytes_out += written;
+
+        if((0 == consumed) && (0 == written) && (NULL != stage->output))
+        {
+            // The result does not fit into the rest of the output, its space is only returned
+            // when the next stage has read it empty
+            if(!buffer_is_empty(stage->output))
+            {
+                room = space;
+                full = true;
+                break;
+            }
+
+            // The output was read empty and reset during the transform
+            if(space < buffer_space(stage->output)) { continue; }
+        }
+
+        // The transform needs more input, e.g. the rest of a record
+        if(0 == consumed)
+        {
+            seen = n;
+            break;
+        }
+    }
+
+    uint64_t duration = buffer_until_now() - start;
+
+    atomic_fetch_add(&stage->runs, 1);
+    atomic_fetch_add(&stage->bytes_in, bytes_in);
+    atomic_fetch_add(&stage->bytes_out, bytes_out);
+    atomic_fetch_add(&stage->busy_ns, duration);
+
+    // Only the worker thread of the stage writes the maximum
+    if(atomic_load(&stage->max_ns) < duration) { atomic_store(&stage->max_ns, duration); }
+
+    if(!atomic_load(&stage->attached)) { return; }
+
+    if(full)
+    {
+        atomic_fetch_add(&stage->stalls, 1);
+
+        // Only more free space wakes the stage
+        stage->waiter_output.seen = room;
+
+        buffer_stage_arm(stage, stage->output, BUFFER_WAIT_SPACE, &stage->waiter_output);
+    }
+    else if(BUFFER_STAGE_BATCH <= bytes_in)
+    {
+        // The stage is queued behind the other stages of the executor
+        buffer_executor_submit(stage->executor, &stage->task);
+    }
+    else
+    {
+        // Only further characters wake the stage, the same input is not passed again
+        if(0 != seen) { atomic_fetch_add(&stage->stalls, 1); }
+
+        stage->waiter_input.seen = seen;
+
+        buffer_stage_arm(stage, stage->input, BUFFER_WAIT_DATA, &stage->waiter_input);
+    }
+}
+
+//! @brief Called on a transition of the input or the output
+static void buffer_stage_wake(buffer_waiter_t * waiter)
+{
+    buffer_stage_t * stage = (buffer_stage_t *)waiter->context;
+
+    buffer_executor_submit(stage->executor, &stage->task);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+bool buffer_stage_attach(buffer_stage_t * stage, buffer_executor_t * executor)
+{
+    if((NULL == stage) || (NULL == executor) || (NULL == stage->input)) { return false; }
+
+    stage->executor = executor;
+    stage->waiter_input.seen = 0;
+    atomic_store(&stage->attached, true);
+
+    buffer_stage_arm(stage, stage->input, BUFFER_WAIT_DATA, &stage->waiter_input);
+
+    return true;
+}
+
+bool buffer_stage_detach(buffer_stage_t * stage)
+{
+    if((NULL == stage) || (NULL == stage->input)) { return false; }
+
+    atomic_store(&stage->attached, false);
+
+    bool idle = buffer_waiter_cancel(stage->input, BUFFER_WAIT_DATA, &stage->waiter_input);
+
+    if(NULL != stage->output)
+    {
+        idle = buffer_waiter_cancel(stage->output, BUFFER_WAIT_SPACE, &stage->waiter_output) || idle;
+    }
+
+    return idle;
+}
+
+bool buffer_stage_init(buffer_stage_t * stage, buffer_t * input, buffer_stage_handler_t transform, buffer_t * output, void * context)
+{
+    if((NULL == stage) || (NULL == input) || (NULL == transform) || (input == output)) { return false; }
+
+    stage->waiter_input.wake = buffer_stage_wake;
+    stage->waiter_input.context = stage;
+    stage->waiter_input.seen = 0;
+    stage->waiter_output.wake = buffer_stage_wake;
+    stage->waiter_output.context = stage;
+    stage->waiter_output.seen = 0;
+    buffer_executor_task(&stage->task, buffer_stage_run, stage);
+    stage->executor = NULL;
+    stage->input = input;
+    stage->output = output;
+    stage->transform = transform;
+    stage->context = context;
+    atomic_init(&stage->attached, false);
+
+    atomic_init(&stage->runs, 0);
+    atomic_init(&stage->bytes_in, 0);
+    atomic_init(&stage->bytes_out, 0);
+    atomic_init(&stage->stalls, 0);
+    atomic_init(&stage->busy_ns, 0);
+    atomic_init(&stage->max_ns, 0);
+
+    return true;
+}
+
+void buffer_stage_stats(const buffer_stage_t * stage, buffer_stage_stats_t * dest)
+{
+    if((NULL == stage) || (NULL == dest)) { return; }
+
+    dest->runs = atomic_load(&stage->runs);
+    dest->bytes_in = atomic_load(&stage->bytes_in);
+    dest->bytes_out = atomic_load(&stage->bytes_out);
+    dest->stalls = atomic_load(&stage->stalls);
+    dest->busy_ns = atomic_load(&stage->busy_ns);
+    dest->max_ns = atomic_load(&stage->max_ns);
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,254 @@
+//! @file
+//! @brief The buffer deadline source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE)
+#define _DEFAULT_SOURCE // clock_gettime, syscall
+#endif
+
+#include "buffer_until.h"
+
+#include <time.h> // clock_gettime, timespec_get
+
+#if defined(__linux__)
+  #include <linux/futex.h> // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+  #include <sys/syscall.h> // SYS_futex
+  #include <unistd.h>      // syscall
+#endif
+
+#include <threads.h> // thrd_sleep, thrd_yield
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+//! @brief Nanoseconds per second
+#define BUFFER_UNTIL_NS UINT64_C(1000000000)
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+
+//! @brief Waiter of a sleeping thread, lives on its stack
+typedef struct buffer_until_sleeper_s
+{
+    buffer_waiter_t waiter;       ///< Armed for the transition
+    volatile _Atomic(int) woken;  ///< Set by the wake handler as its last access
+}buffer_until_sleeper_t;
+
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_until_sc buffer_until =
+{
+    buffer_until_after,
+    buffer_get_until,
+    buffer_until_now,
+    buffer_read_line_until,
+    buffer_set_until,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static bool buffer_until_stopped(const buffer_t * object);
+static void buffer_until_sleep(buffer_until_sleeper_t * sleeper, uint64_t timeout);
+static buffer_until_status_t buffer_until_wait(buffer_t * object, buffer_wait_event_t event, uint64_t deadline);
+static void buffer_until_wake(buffer_waiter_t * waiter);
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+static bool buffer_until_stopped(const buffer_t * object)
+{
+    return BUFFER_FLAGS_IDLE > atomic_load(&object->state);
+}
+
+//! @brief Sleeps until the sleeper is woken or @p timeout nanoseconds have passed
+static void buffer_until_sleep(buffer_until_sleeper_t * sleeper, uint64_t timeout)
+{
+#if defined(__linux__)
+    struct timespec ts = { (time_t)(timeout / BUFFER_UNTIL_NS), (long)(timeout % BUFFER_UNTIL_NS) };
+
+    // Returns immediately if the wake handler has already set the value
+    syscall(SYS_futex, (int *)&sleeper->woken, FUTEX_WAIT_PRIVATE, 0, &ts, NULL, 0);
+#else
+    (void)sleeper;
+
+    if(BUFFER_UNTIL_SLEEP_NS < timeout) { timeout = BUFFER_UNTIL_SLEEP_NS; }
+
+    struct timespec ts = { 0, (long)timeout };
+
+    thrd_sleep(&ts, NULL);
+#endif
+}
+
+//! @brief Waits for a transition
+//!
+//! @return ::BUFFER_UNTIL_OK if the condition should be checked again
+static buffer_until_status_t buffer_until_wait(buffer_t * object, buffer_wait_event_t event, uint64_t deadline)
+{
+    uint64_t now = buffer_until_now();
+
+    if(deadline <= now) { return BUFFER_UNTIL_TIMEOUT; }
+
+    buffer_until_sleeper_t sleeper;
+    sleeper.waiter.wake = buffer_until_wake;
+    sleeper.waiter.context = &sleeper;
+    sleeper.waiter.seen = 0;
+    atomic_init(&sleeper.woken, 0);
+
+    // Not armed, the condition is fulfilled or the buffer is stopped
+    if(!buffer_waiter_arm(object, event, &sleeper.waiter)) { return BUFFER_UNTIL_OK; }
+
+    while(0 == atomic_load(&sleeper.woken))
+    {
+        if(deadline <= now)
+        {
+            if(buffer_waiter_cancel(object, event, &sleeper.waiter)) { return BUFFER_UNTIL_TIMEOUT; }
+
+            // The wake handler is running, the sleeper must stay valid until it is finished
+            while(0 == atomic_load(&sleeper.woken))
+            {
+                thrd_yield();
+            }
+
+            break;
+        }
+
+        buffer_until_sleep(&sleeper, deadline - now);
+
+        now = buffer_until_now();
+    }
+
+    return BUFFER_UNTIL_OK;
+}
+
+//! @brief Wake handler of the sleeper, called by the thread that causes the transition
+static void buffer_until_wake(buffer_waiter_t * waiter)
+{
+    buffer_until_sleeper_t * sleeper = (buffer_until_sleeper_t *)waiter->context;
+
+    atomic_store(&sleeper->woken, 1);
+
+#if defined(__linux__)
+    // The sleeper may already be gone, a futex wake on its address is harmless
+    syscall(SYS_futex, (int *)&sleeper->woken, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+buffer_until_status_t buffer_get_until(buffer_t * object, char * c, uint64_t deadline)
+{
+    if((NULL == object) || (NULL == c)) { return BUFFER_UNTIL_STOPPED; }
+
+    for(size_t spin = 0; ; spin++)
+    {
+        const char * span;
+
+        // As buffer_get(), the character '\0' is read like every other character
+        if(0 < buffer_read_span(object, &span))
+        {
+            *c = *span;
+            buffer_read_consume(object, 1);
+            return BUFFER_UNTIL_OK;
+        }
+
+        if(buffer_until_stopped(object)) { return BUFFER_UNTIL_STOPPED; }
+
+        if(spin < BUFFER_UNTIL_SPIN) { continue; }
+
+        buffer_until_status_t status = buffer_until_wait(object, BUFFER_WAIT_DATA, deadline);
+
+        if(BUFFER_UNTIL_OK != status) { return status; }
+    }
+}
+
+buffer_until_status_t buffer_read_line_until(buffer_t * object, char * dest, size_t n, size_t * length, uint64_t deadline)
+{
+    if((NULL == object) || (NULL == dest) || (0 == n)) { return BUFFER_UNTIL_STOPPED; }
+
+    for(size_t spin = 0; ; spin++)
+    {
+        if(0 < atomic_load(&object->lines))
+        {
+            size_t read = buffer_read_line(object, dest, n);
+
+            if(NULL != length) { *length = read; }
+
+            return BUFFER_UNTIL_OK;
+        }
+
+        if(buffer_until_stopped(object)) { return BUFFER_UNTIL_STOPPED; }
+
+        if(spin < BUFFER_UNTIL_SPIN) { continue; }
+
+        buffer_until_status_t status = buffer_until_wait(object, BUFFER_WAIT_LINE, deadline);
+
+        if(BUFFER_UNTIL_OK != status) { return status; }
+    }
+}
+
+buffer_until_status_t buffer_set_until(buffer_t * object, char c, uint64_t deadline)
+{
+    if(NULL == object) { return BUFFER_UNTIL_STOPPED; }
+
+    for(size_t spin = 0; ; spin++)
+    {
+        // The space is checked first, a full buffer is not reported to buffer_s::on_full
+        if((0 < buffer_space(object)) && buffer_set_possible_or_skip(object, c))
+        {
+            return BUFFER_UNTIL_OK;
+        }
+
+        if(buffer_until_stopped(object)) { return BUFFER_UNTIL_STOPPED; }
+
+        if(spin < BUFFER_UNTIL_SPIN) { continue; }
+
+        buffer_until_status_t status = buffer_until_wait(object, BUFFER_WAIT_SPACE, deadline);
+
+        if(BUFFER_UNTIL_OK != status) { return status; }
+    }
+}
+
+uint64_t buffer_until_after(uint64_t timeout)
+{
+    uint64_t now = buffer_until_now();
+
+    return (BUFFER_UNTIL_FOREVER - now < timeout) ? BUFFER_UNTIL_FOREVER : (now + timeout);
+}
+
+uint64_t buffer_until_now(void)
+{
+    struct timespec ts;
+
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+
+    return ((uint64_t)ts.tv_sec * BUFFER_UNTIL_NS) + (uint64_t)ts.tv_nsec;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
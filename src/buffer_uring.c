@@ -0,0 +1,342 @@
+//! @file
+//! @brief The buffer io_uring source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_uring.h"
+#include "buffer_fd.h"
+#include "buffer_until.h"
+
+#include <errno.h>   // errno, EAGAIN, ECANCELED, EINTR, ENOBUFS
+#include <stdint.h>  // SIZE_MAX
+#include <threads.h> // thrd_sleep
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+
+const struct buffer_uring_sc buffer_uring =
+{
+    buffer_uring_channel,
+    buffer_uring_exit,
+    buffer_uring_init,
+    buffer_uring_poll,
+};
+
+
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+
+static size_t buffer_uring_fallback(buffer_uring_t * uring);
+
+#ifdef BUFFER_ENABLE_IO_URING
+static size_t buffer_uring_complete(buffer_uring_channel_t * channel, int result);
+static bool buffer_uring_post(buffer_uring_t * uring, buffer_uring_channel_t * channel);
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+//! @brief Services all channels with ::buffer_fill_from_fd() and ::buffer_drain_to_fd()
+static size_t buffer_uring_fallback(buffer_uring_t * uring)
+{
+    size_t total = 0;
+
+    for(size_t i = 0; i < uring->count; i++)
+    {
+        buffer_uring_channel_t * channel = &uring->channels[i];
+
+        if(channel->closed) { continue; }
+
+        ssize_t n = channel->egress ?
+            buffer_drain_to_fd(channel->object, channel->fd, SIZE_MAX) :
+            buffer_fill_from_fd(channel->object, channel->fd, SIZE_MAX);
+
+        if(0 < n)
+        {
+            total += (size_t)n;
+        }
+        else if((0 == n) && !channel->egress)
+        {
+            channel->closed = true; // End of file
+        }
+        else if((n < 0) && (EAGAIN != errno) && (EWOULDBLOCK != errno) && (ENOBUFS != errno) && (EINTR != errno))
+        {
+            channel->closed = true;
+            channel->error = errno;
+        }
+    }
+
+    return total;
+}
+
+#ifdef BUFFER_ENABLE_IO_URING
+
+//! @brief Publishes or removes the characters of a completed request
+static size_t buffer_uring_complete(buffer_uring_channel_t * channel, int result)
+{
+    size_t n = (0 < result) ? (size_t)result : 0;
+
+    if(channel->egress)
+    {
+        n = buffer_read_consume(channel->object, n);
+    }
+    else
+    {
+        n = buffer_write_commit(channel->object, channel->span, n);
+    }
+
+    channel->pending = 0;
+    channel->span = NULL;
+
+    if((0 == result) && !channel->egress)
+    {
+        channel->closed = true; // End of file
+    }
+    else if((result < 0) && (-EAGAIN != result) && (-EINTR != result) && (-ECANCELED != result))
+    {
+        channel->closed = true;
+        channel->error = -result;
+    }
+
+    return n;
+}
+
+//! @brief Posts a request into the free space or from the readable characters
+static bool buffer_uring_post(buffer_uring_t * uring, buffer_uring_channel_t * channel)
+{
+    size_t length;
+
+    if(channel->egress)
+    {
+        const char * span;
+        length = buffer_read_span(channel->object, &span);
+        channel->span = (char *)span;
+    }
+    else
+    {
+        length = buffer_write_reserve(channel->object, &channel->span);
+    }
+
+    if(0 == length) { return false; }
+
+    struct io_uring_sqe * sqe = io_uring_get_sqe(&uring->ring);
+
+    if(NULL == sqe)
+    {
+        if(!channel->egress) { buffer_write_commit(channel->object, channel->span, 0); }
+        channel->span = NULL;
+        return false;
+    }
+
+    // The offset -1 uses the current position, as read() and write() do
+    if(channel->egress)
+    {
+        io_uring_prep_write(sqe, channel->fd, channel->span, (unsigned)length, (__u64)-1);
+    }
+    else
+    {
+        io_uring_prep_read(sqe, channel->fd, channel->span, (unsigned)length, (__u64)-1);
+    }
+
+    io_uring_sqe_set_data(sqe, channel);
+
+    channel->pending = length;
+
+    return true;
+}
+
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+bool buffer_uring_channel(buffer_uring_channel_t * channel, buffer_t * object, int fd, bool egress)
+{
+    if((NULL == channel) || (NULL == object)) { return false; }
+
+    channel->object = object;
+    channel->fd = fd;
+    channel->egress = egress;
+    channel->closed = false;
+    channel->error = 0;
+    channel->span = NULL;
+    channel->pending = 0;
+
+    return true;
+}
+
+void buffer_uring_exit(buffer_uring_t * uring)
+{
+    if(NULL == uring) { return; }
+
+#ifdef BUFFER_ENABLE_IO_URING
+    if(uring->active)
+    {
+        unsigned inflight = 0;
+
+        for(size_t i = 0; i < uring->count; i++)
+        {
+            buffer_uring_channel_t * channel = &uring->channels[i];
+
+            if(0 == channel->pending) { continue; }
+
+            // The submission queue is empty after each poll, so every channel finds an entry
+            struct io_uring_sqe * sqe = io_uring_get_sqe(&uring->ring);
+
+            if(NULL != sqe)
+            {
+                io_uring_prep_cancel(sqe, channel, 0);
+                io_uring_sqe_set_data(sqe, NULL);
+            }
+
+            inflight++;
+        }
+
+        if(0 < inflight) { io_uring_submit(&uring->ring); }
+
+        // A posted request may still write into the buffer until its completion is reaped,
+        // canceled or not each one completes exactly once
+        while(0 < inflight)
+        {
+            struct io_uring_cqe * cqe;
+            int result = io_uring_wait_cqe(&uring->ring, &cqe);
+
+            if(-EINTR == result) { continue; }
+            if(0 != result) { break; }
+
+            buffer_uring_channel_t * channel = (buffer_uring_channel_t *)io_uring_cqe_get_data(cqe);
+
+            if(NULL != channel)
+            {
+                buffer_uring_complete(channel, cqe->res);
+                inflight--;
+            }
+
+            io_uring_cqe_seen(&uring->ring, cqe);
+        }
+
+        io_uring_queue_exit(&uring->ring);
+
+        uring->active = false;
+
+        // Only left if the completions could not be reaped
+        for(size_t i = 0; i < uring->count; i++)
+        {
+            buffer_uring_channel_t * channel = &uring->channels[i];
+
+            if((0 < channel->pending) && !channel->egress)
+            {
+                buffer_write_commit(channel->object, channel->span, 0);
+            }
+
+            channel->pending = 0;
+            channel->span = NULL;
+        }
+    }
+#endif
+}
+
+bool buffer_uring_init(buffer_uring_t * uring, buffer_uring_channel_t * channels, size_t count)
+{
+    if((NULL == uring) || (NULL == channels)) { return false; }
+
+    uring->channels = channels;
+    uring->count = count;
+    uring->active = false;
+
+#ifdef BUFFER_ENABLE_IO_URING
+    // Each channel has at most one posted request
+    unsigned entries = (0 < count) ? (unsigned)count : 1u;
+
+    uring->active = (0 == io_uring_queue_init(entries, &uring->ring, 0));
+#endif
+
+    return true;
+}
+
+size_t buffer_uring_poll(buffer_uring_t * uring, bool wait)
+{
+    if(NULL == uring) { return 0; }
+
+    if(!uring->active)
+    {
+        return buffer_uring_fallback(uring);
+    }
+
+    size_t total = 0;
+
+#ifdef BUFFER_ENABLE_IO_URING
+    size_t posted = 0;
+
+    while(true)
+    {
+        bool open = false;
+
+        for(size_t i = 0; i < uring->count; i++)
+        {
+            buffer_uring_channel_t * channel = &uring->channels[i];
+
+            if(!channel->closed && (0 == channel->pending))
+            {
+                buffer_uring_post(uring, channel);
+            }
+
+            if(0 < channel->pending) { posted++; }
+
+            if(!channel->closed && (BUFFER_FLAGS_IDLE <= atomic_load(&channel->object->state))) { open = true; }
+        }
+
+        if((0 < posted) || !wait || !open) { break; }
+
+        // Nothing to submit, the other threads have to publish characters or free space first
+        struct timespec ts = { 0, BUFFER_UNTIL_SLEEP_NS };
+
+        thrd_sleep(&ts, NULL);
+    }
+
+    if(0 == posted) { return 0; }
+
+    // All new requests with one system call
+    io_uring_submit_and_wait(&uring->ring, wait ? 1 : 0);
+
+    struct io_uring_cqe * cqe;
+    unsigned head;
+    unsigned seen = 0;
+
+    io_uring_for_each_cqe(&uring->ring, head, cqe)
+    {
+        total += buffer_uring_complete((buffer_uring_channel_t *)io_uring_cqe_get_data(cqe), cqe->res);
+        seen++;
+    }
+
+    io_uring_cq_advance(&uring->ring, seen);
+#else
+    (void)wait;
+#endif
+
+    return total;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -0,0 +1,21 @@
+#ifndef INC_BUFFER_BENCHMARK_H_
+#define INC_BUFFER_BENCHMARK_H_
+
+//! @brief Runs the throughput and latency benchmark of the buffer operations
+//!
+//! @details Measures the single-thread operations, the cross-thread throughput
+//! and the round-trip (ping-pong) latency for a sweep of buffer sizes, message
+//! sizes and core placements. Each measurement is written as one JSON object
+//! per line to the file @p path.
+//!
+//! @param path The output file, `NULL` selects `bench_output.txt`
+//! @return Returns the number of errors, e.g. the output file could not be opened
+extern int buffer_benchmark(const char * path);
+
+
+#endif /* INC_BUFFER_BENCHMARK_H_ */
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
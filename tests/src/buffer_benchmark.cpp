@@ -0,0 +1,478 @@
+//! @file
+//! @brief The buffer benchmark source file.
+
+
+/*---------------------------------------------------------------------*
+ *  private: include files
+ *---------------------------------------------------------------------*/
+
+#include "buffer_benchmark.h"
+#include "buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  private: definitions
+ *---------------------------------------------------------------------*/
+
+#define LENGTH(ARRAY) (sizeof(ARRAY)/sizeof(ARRAY[0]))
+
+#ifndef BUFFER_BENCHMARK_BYTES
+//! @brief Number of bytes moved per single-thread and cross-thread measurement
+#define BUFFER_BENCHMARK_BYTES (1024u * 1024u)
+#endif
+
+#ifndef BUFFER_BENCHMARK_PING_PONG
+//! @brief Number of round trips per latency measurement
+#define BUFFER_BENCHMARK_PING_PONG (20000u)
+#endif
+
+
+/*---------------------------------------------------------------------*
+ *  private: typedefs
+ *---------------------------------------------------------------------*/
+
+typedef std::chrono::steady_clock benchmark_clock_t;
+
+typedef enum benchmark_placement_e
+{
+    BENCHMARK_PLACEMENT_UNPINNED, ///< The scheduler decides
+    BENCHMARK_PLACEMENT_SAME_CORE, ///< Producer and consumer share one core
+    BENCHMARK_PLACEMENT_CROSS_CORE, ///< Producer and consumer use two different cores
+}benchmark_placement_t;
+
+typedef struct benchmark_result_s
+{
+    const char * benchmark;
+    const char * op;
+    size_t buffer_size;
+    size_t message_size;
+    benchmark_placement_t placement;
+    bool pinned;
+    uint64_t ops;
+    uint64_t bytes;
+    double seconds;
+}benchmark_result_t;
+
+//! @brief Affinity of a thread before benchmark_pin(), threads created later inherit it
+typedef struct benchmark_affinity_s
+{
+    bool saved;
+#ifdef __linux__
+    cpu_set_t set;
+#endif
+}benchmark_affinity_t;
+
+
+/*---------------------------------------------------------------------*
+ *  private: variables
+ *---------------------------------------------------------------------*/
+
+static const size_t benchmark_buffer_sizes[] = { 64, 4096, 65536 };
+
+static const size_t benchmark_message_sizes[] = { 1, 16, 64, 1024 };
+
+static const benchmark_placement_t benchmark_placements[] =
+{
+    BENCHMARK_PLACEMENT_UNPINNED,
+    BENCHMARK_PLACEMENT_SAME_CORE,
+    BENCHMARK_PLACEMENT_CROSS_CORE,
+};
+
+static const char * const benchmark_placement_names[] = { "unpinned", "same_core", "cross_core" };
+
+
+/*---------------------------------------------------------------------*
+ *  public:  variables
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: function prototypes
+ *---------------------------------------------------------------------*/
+/*---------------------------------------------------------------------*
+ *  private: functions
+ *---------------------------------------------------------------------*/
+
+static double benchmark_seconds(benchmark_clock_t::time_point start, benchmark_clock_t::time_point stop)
+{
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+//! @brief Pins the calling thread to one core, returns whether it worked
+//!
+//! @details The previous affinity is stored in @p saved if it is not `NULL`, see benchmark_unpin().
+static bool benchmark_pin(benchmark_placement_t placement, unsigned int role, benchmark_affinity_t * saved)
+{
+    if(NULL != saved){ saved->saved = false; }
+
+#ifdef __linux__
+    if(BENCHMARK_PLACEMENT_UNPINNED == placement){ return false; }
+
+    unsigned int cores = std::thread::hardware_concurrency();
+    if(0 == cores){ return false; }
+
+    unsigned int core = 0;
+    if(BENCHMARK_PLACEMENT_CROSS_CORE == placement)
+    {
+        if(cores < 2){ return false; }
+        core = role % cores;
+    }
+
+    if(NULL != saved)
+    {
+        saved->saved = (0 == pthread_getaffinity_np(pthread_self(), sizeof(saved->set), &saved->set));
+        if(!saved->saved){ return false; }
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return 0 == pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)placement;
+    (void)role;
+    return false;
+#endif
+}
+
+//! @brief Restores the affinity of the calling thread stored by benchmark_pin()
+static void benchmark_unpin(const benchmark_affinity_t * saved)
+{
+#ifdef __linux__
+    if(saved->saved)
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved->set), &saved->set);
+    }
+#else
+    (void)saved;
+#endif
+}
+
+#ifdef BUFFER_ENABLE_HANDLER
+
+//! @brief Gives the peer a chance to run if both threads share one core
+static char benchmark_wait_yield(buffer_t * object)
+{
+    (void)object;
+    std::this_thread::yield();
+    return 0;
+}
+
+#endif
+
+static buffer_t * benchmark_allocate(size_t buffer_size, benchmark_placement_t placement)
+{
+    buffer_t * object = buffer.ObjectAllocate(NULL, buffer_size, true);
+
+#ifdef BUFFER_ENABLE_HANDLER
+    bool shared = (BENCHMARK_PLACEMENT_SAME_CORE == placement) || (std::thread::hardware_concurrency() < 2);
+    if((NULL != object) && shared)
+    {
+        object->on_wait_set = benchmark_wait_yield;
+        object->on_wait_get = benchmark_wait_yield;
+    }
+#else
+    (void)placement;
+#endif
+
+    return object;
+}
+
+//! @brief Fills a message with printable characters and the given terminator
+static void benchmark_message(std::vector<char> & message, size_t message_size, const char * end, size_t end_length)
+{
+    message.assign(message_size + 1, '\0');
+    for(size_t i = 0; i < message_size; i++)
+    {
+        message[i] = (char)('a' + (i % 26));
+    }
+    if(end_length <= message_size)
+    {
+        memcpy(&message[message_size - end_length], end, end_length);
+    }
+}
+
+static void benchmark_print(FILE * file, const benchmark_result_t * result)
+{
+    double seconds = (0.0 < result->seconds) ? result->seconds : 1e-12;
+
+    fprintf(file,
+        "{\"benchmark\":\"%s\",\"op\":\"%s\",\"buffer_size\":%zu,\"message_size\":%zu,"
+        "\"placement\":\"%s\",\"pinned\":%s,\"ops\":%llu,\"bytes\":%llu,\"seconds\":%.9f,"
+        "\"ops_per_sec\":%.1f,\"bytes_per_sec\":%.1f}\n",
+        result->benchmark, result->op, result->buffer_size, result->message_size,
+        benchmark_placement_names[result->placement], result->pinned ? "true" : "false",
+        (unsigned long long)result->ops, (unsigned long long)result->bytes, result->seconds,
+        (double)result->ops / seconds, (double)result->bytes / seconds);
+}
+
+static int benchmark_single_thread(FILE * file, size_t buffer_size, size_t message_size)
+{
+    static const char * const ops[] = { "set_get", "write_read", "read_line", "read_to" };
+
+    int errors = 0;
+
+    buffer_t * object = benchmark_allocate(buffer_size, BENCHMARK_PLACEMENT_UNPINNED);
+    if(NULL == object){ return 1; }
+
+    std::vector<char> message;
+    std::vector<char> dest(message_size + 1);
+    uint64_t iterations = BUFFER_BENCHMARK_BYTES / message_size;
+
+    for(size_t op = 0; op < LENGTH(ops); op++)
+    {
+        if((0 == op) && (1 != message_size)){ continue; }
+        if((3 == op) && (message_size < 2)){ continue; }
+
+        benchmark_message(message, message_size, (3 == op) ? "\r\n" : "\n", (1 == op) ? 0 : ((3 == op) ? 2 : 1));
+        buffer.Clear(object);
+
+        uint64_t moved = 0;
+        benchmark_clock_t::time_point start = benchmark_clock_t::now();
+
+        for(uint64_t i = 0; i < iterations; i++)
+        {
+            switch(op)
+            {
+            case 0:
+                buffer.Set(object, 'x');
+                moved += ('x' == buffer.Get(object)) ? 1 : 0;
+                break;
+            case 1:
+                buffer.Write(object, message.data(), message_size);
+                moved += buffer.Read(object, dest.data(), dest.size());
+                break;
+            case 2:
+                buffer.Write(object, message.data(), message_size);
+                moved += buffer.ReadLine(object, dest.data(), dest.size()) + 1;
+                break;
+            default:
+                buffer.Write(object, message.data(), message_size);
+                moved += buffer.ReadTo(object, dest.data(), dest.size(), "\r\n", 2) + 2;
+                break;
+            }
+        }
+
+        benchmark_clock_t::time_point stop = benchmark_clock_t::now();
+
+        if((iterations * message_size) != moved){ errors += 1; }
+
+        benchmark_result_t result = { "single_thread", ops[op], buffer_size, message_size,
+            BENCHMARK_PLACEMENT_UNPINNED, false, iterations, moved, benchmark_seconds(start, stop) };
+        benchmark_print(file, &result);
+    }
+
+    buffer.ObjectFree(object);
+
+    return errors;
+}
+
+static int benchmark_cross_thread(FILE * file, size_t buffer_size, size_t message_size, benchmark_placement_t placement)
+{
+    buffer_t * object = benchmark_allocate(buffer_size, placement);
+    if(NULL == object){ return 1; }
+
+    std::vector<char> message;
+    benchmark_message(message, message_size, "", 0);
+
+    uint64_t total = (BUFFER_BENCHMARK_BYTES / message_size) * message_size;
+    uint64_t received = 0;
+    std::atomic<bool> producer_pinned(false);
+    bool consumer_pinned;
+
+    benchmark_clock_t::time_point start = benchmark_clock_t::now();
+
+    std::thread producer([&]()
+    {
+        producer_pinned = benchmark_pin(placement, 1, NULL);
+
+        for(uint64_t sent = 0; sent < total; )
+        {
+            if(1 == message_size)
+            {
+                sent += buffer.Set(object, 'x') ? 1 : 0;
+            }
+            else
+            {
+                size_t written = buffer.Write(object, message.data(), message_size);
+                sent += written;
+                if(written < message_size)
+                {
+                    // Send the rest of the message, waiting for space if necessary
+                    for(size_t i = written; i < message_size; i++)
+                    {
+                        sent += buffer.Set(object, message[i]) ? 1 : 0;
+                    }
+                }
+            }
+        }
+    });
+
+    // The calling thread runs the following measurements, its affinity is restored afterwards
+    benchmark_affinity_t affinity;
+    consumer_pinned = benchmark_pin(placement, 0, &affinity);
+
+    if(1 == message_size)
+    {
+        for(; received < total; received++)
+        {
+            buffer.Get(object);
+        }
+    }
+    else
+    {
+        std::vector<char> dest(message_size + 1);
+        while(received < total)
+        {
+            size_t read = buffer.Read(object, dest.data(), dest.size());
+            if(0 == read)
+            {
+                dest[0] = buffer.Get(object);
+                read = 1;
+            }
+            received += read;
+        }
+    }
+
+    producer.join();
+
+    benchmark_clock_t::time_point stop = benchmark_clock_t::now();
+
+    benchmark_unpin(&affinity);
+
+    benchmark_result_t result = { "cross_thread", (1 == message_size) ? "set_get" : "write_read",
+        buffer_size, message_size, placement, producer_pinned && consumer_pinned,
+        total / message_size, received, benchmark_seconds(start, stop) };
+    benchmark_print(file, &result);
+
+    buffer.ObjectFree(object);
+
+    return (total == received) ? 0 : 1;
+}
+
+static int benchmark_ping_pong(FILE * file, size_t buffer_size, benchmark_placement_t placement)
+{
+    buffer_t * ping = benchmark_allocate(buffer_size, placement);
+    buffer_t * pong = benchmark_allocate(buffer_size, placement);
+    if((NULL == ping) || (NULL == pong))
+    {
+        buffer.ObjectFree(ping);
+        buffer.ObjectFree(pong);
+        return 1;
+    }
+
+    std::vector<uint64_t> samples(BUFFER_BENCHMARK_PING_PONG);
+    std::atomic<bool> peer_pinned(false);
+    bool pinned;
+    int errors = 0;
+
+    std::thread peer([&]()
+    {
+        peer_pinned = benchmark_pin(placement, 1, NULL);
+
+        for(size_t i = 0; i < samples.size(); i++)
+        {
+            buffer.Set(pong, buffer.Get(ping));
+        }
+    });
+
+    benchmark_affinity_t affinity;
+    pinned = benchmark_pin(placement, 0, &affinity);
+
+    benchmark_clock_t::time_point start = benchmark_clock_t::now();
+
+    for(size_t i = 0; i < samples.size(); i++)
+    {
+        benchmark_clock_t::time_point sent = benchmark_clock_t::now();
+        buffer.Set(ping, 'p');
+        if('p' != buffer.Get(pong)){ errors += 1; }
+        samples[i] = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(benchmark_clock_t::now() - sent).count();
+    }
+
+    benchmark_clock_t::time_point stop = benchmark_clock_t::now();
+
+    peer.join();
+
+    benchmark_unpin(&affinity);
+
+    std::sort(samples.begin(), samples.end());
+
+    double seconds = benchmark_seconds(start, stop);
+    size_t n = samples.size();
+
+    fprintf(file,
+        "{\"benchmark\":\"ping_pong\",\"op\":\"set_get\",\"buffer_size\":%zu,\"message_size\":1,"
+        "\"placement\":\"%s\",\"pinned\":%s,\"samples\":%zu,\"seconds\":%.9f,"
+        "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu}\n",
+        buffer_size, benchmark_placement_names[placement], (pinned && peer_pinned) ? "true" : "false",
+        n, seconds,
+        (unsigned long long)samples[(n * 50) / 100],
+        (unsigned long long)samples[(n * 90) / 100],
+        (unsigned long long)samples[(n * 99) / 100],
+        (unsigned long long)samples[(n * 999) / 1000],
+        (unsigned long long)samples[n - 1]);
+
+    buffer.ObjectFree(ping);
+    buffer.ObjectFree(pong);
+
+    return errors;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  public:  functions
+ *---------------------------------------------------------------------*/
+
+int buffer_benchmark(const char * path)
+{
+    int errors = 0;
+
+    FILE * file = fopen((NULL != path) ? path : "bench_output.txt", "w");
+    if(NULL == file){ return 1; }
+
+    for(size_t b = 0; b < LENGTH(benchmark_buffer_sizes); b++)
+    {
+        size_t buffer_size = benchmark_buffer_sizes[b];
+
+        for(size_t m = 0; m < LENGTH(benchmark_message_sizes); m++)
+        {
+            size_t message_size = benchmark_message_sizes[m];
+            if(buffer_size < message_size){ continue; }
+
+            errors += benchmark_single_thread(file, buffer_size, message_size);
+
+            for(size_t p = 0; p < LENGTH(benchmark_placements); p++)
+            {
+                errors += benchmark_cross_thread(file, buffer_size, message_size, benchmark_placements[p]);
+            }
+        }
+
+        for(size_t p = 0; p < LENGTH(benchmark_placements); p++)
+        {
+            errors += benchmark_ping_pong(file, buffer_size, benchmark_placements[p]);
+        }
+    }
+
+    fclose(file);
+
+    return errors;
+}
+
+
+/*---------------------------------------------------------------------*
+ *  eof
+ *---------------------------------------------------------------------*/
@@ -2,8 +2,38 @@
  *  private: include files
  *---------------------------------------------------------------------*/
 
+#if !defined(_DEFAULT_SOURCE) && !defined(_GNU_SOURCE)
+#define _DEFAULT_SOURCE // fileno, ftruncate, mkstemp
+#endif
+
 #include "buffer_testbench.h"
 #include "buffer.h"
+#include "buffer_chain.h"
+#include "buffer_crc.h"
+#include "buffer_executor.h"
+#include "buffer_group.h"
+#include "buffer_match.h"
+#include "buffer_mmap.h"
+#include "buffer_pool.h"
+#include "buffer_shard.h"
+#include "buffer_shm.h"
+#include "buffer_slot.h"
+#include "buffer_stage.h"
+#include "buffer_until.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "buffer_fd.h"
+#include "buffer_uring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef BUFFER_ENABLE_LATENCY
+#include "buffer_latency.h"
+#endif
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -1438,6 +1468,1270 @@ static int buffer_test_buffer_read_line(void)
     return errors;
 }
 
+static int buffer_test_line_index(void)
+{
+    int errors = 0;
+    char buf_set[30];
+    char buf_get[30];
+    const char * line;
+    size_t size;
+    buffer_line_index_t index;
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+    // The position of a line that is already in the buffer is not stored, the line is searched
+    buffer_write(&obj, "I\n", 30);
+    if(true != buffer_line_index_attach(&obj, &index)){ errors += 1; }
+
+    size = buffer_write(&obj, "You\n\nHe", 30);
+    if(7 != size ){ errors += 1; }
+    if(3 != index.published){ errors += 1; }
+
+    size = buffer_look_line(&obj, &line);
+    if((1 != size) || (buf_set != line)){ errors += 1; }
+
+    size = buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if((1 != size) || (0 != strcmp(buf_get, "I"))){ errors += 1; }
+
+    // The line does not fit, the End-Of-Line character remains
+    size = buffer_read_line(&obj, buf_get, 3);
+    if((2 != size) || (0 != strcmp(buf_get, "Yo"))){ errors += 1; }
+    size = buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if((1 != size) || (0 != strcmp(buf_get, "u"))){ errors += 1; }
+    if(2 != atomic_load(&index.consumed)){ errors += 1; }
+
+    if(true != buffer_skip_line(&obj)){ errors += 1; }
+    if(false != buffer_skip_line(&obj)){ errors += 1; }
+    if(0 != buffer_look_line(&obj, &line) || (NULL != line)){ errors += 1; }
+
+    buffer_set(&obj, '\n');
+    if(1 != buffer_lines(&obj)){ errors += 1; }
+    size = buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if((2 != size) || (0 != strcmp(buf_get, "He"))){ errors += 1; }
+    if(true != buffer_is_empty(&obj)){ errors += 1; }
+
+    // The side ring is used more than once
+    for(size_t i = 0; i < (BUFFER_LINE_INDEX_ENTRIES + 2); i++)
+    {
+        buffer_write(&obj, "a\n", 30);
+        if(1 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    }
+    if(true != buffer_is_empty(&obj)){ errors += 1; }
+
+    if(true != buffer_line_index_attach(&obj, NULL)){ errors += 1; }
+    if(NULL != obj.line_index){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_record(void)
+{
+    int errors = 0;
+    char buf_set[40];
+    char buf_get[20];
+    const void * record;
+    size_t size;
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+    if(0 != buffer_pop_record(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+
+    if(true != buffer_push_record(&obj, "Hello\n", 6)){ errors += 1; }
+    if(false != buffer_push_record(&obj, NULL, 0)){ errors += 1; }
+    if(false != buffer_push_record(&obj, "", 0)){ errors += 1; }
+    if(true != buffer_push_record(&obj, "!", 1)){ errors += 1; }
+    if((7 + (2 * BUFFER_RECORD_HEADER_SIZE)) != buffer_length(&obj)){ errors += 1; }
+    if(0 != buffer_lines(&obj)){ errors += 1; }
+
+    // Not enough space, the record is skipped as a whole
+    if(false != buffer_push_record(&obj, "0123456789012345678901234567890123456789", 40)){ errors += 1; }
+
+    size = buffer_peek_record(&obj, &record);
+    if((6 != size) || (0 != memcmp(record, "Hello\n", 6))){ errors += 1; }
+
+    // Does not fit, the record remains
+    if(0 != buffer_pop_record(&obj, buf_get, 5)){ errors += 1; }
+    if(6 != buffer_pop_record(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != memcmp(buf_get, "Hello\n", 6)){ errors += 1; }
+
+    size = buffer_peek_record(&obj, &record);
+    if((1 != size) || (0 != memcmp(record, "!", 1))){ errors += 1; }
+    if(1 != buffer_pop_record(&obj, NULL, 0)){ errors += 1; }
+
+    size = buffer_peek_record(&obj, &record);
+    if((0 != size) || (NULL != record)){ errors += 1; }
+    if(true != buffer_is_empty(&obj)){ errors += 1; }
+
+    // Written in place and released as a batch, binary payloads are not counted as lines
+    char * reserved = (char *)buffer_push_record_reserve(&obj, 3);
+    if(NULL == reserved){ return errors + 1; }
+    memcpy(reserved, "a\nb", 3);
+    if(0 != buffer_length(&obj)){ errors += 1; }
+    if(true != buffer_push_record_commit(&obj, reserved)){ errors += 1; }
+    if(true != buffer_push_record(&obj, "\n\n", 2)){ errors += 1; }
+    if(NULL != buffer_push_record_reserve(&obj, 40)){ errors += 1; }
+    if(NULL != buffer_push_record_reserve(&obj, 0)){ errors += 1; }
+
+    const char * span;
+    size = buffer_read_span(&obj, &span);
+    if((5 + (2 * BUFFER_RECORD_HEADER_SIZE)) != size){ errors += 1; }
+    if(0 != buffer_pop_records(&obj, size + 1, 2)){ errors += 1; }
+    if(size != buffer_pop_records(&obj, size, 2)){ errors += 1; }
+    if((0 != buffer_lines(&obj)) || (true != buffer_is_empty(&obj))){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_slot(void)
+{
+    int errors = 0;
+
+    typedef struct { uint32_t id; char text[20]; } message_t;
+
+    static char data[300];
+    message_t in[4] = { { 1, "one" }, { 2, "two" }, { 3, "three" }, { 4, "four" } };
+    message_t out[4];
+    buffer_slot_t queue;
+
+    if(false != buffer_slot_init(&queue, data, 16, sizeof(message_t), true)){ errors += 1; }
+    if(true != buffer_slot_init(&queue, data, sizeof(data), sizeof(message_t), false)){ errors += 1; }
+    if(4 != buffer_slot_count(&queue)){ errors += 1; }
+    if(0 != ((uintptr_t)queue.slots % BUFFER_SLOT_ALIGNMENT)){ errors += 1; }
+
+    // Stopped
+    if(false != buffer_slot_push(&queue, &in[0])){ errors += 1; }
+    if(true != buffer_start(&queue.buffer)){ errors += 1; }
+
+    if(true != buffer_slot_push(&queue, &in[0])){ errors += 1; }
+    if(3 != buffer_slot_push_batch(&queue, &in[1], 3)){ errors += 1; }
+    if(false != buffer_slot_push(&queue, &in[0])){ errors += 1; }
+
+    if(true != buffer_slot_pop(&queue, &out[0])){ errors += 1; }
+    if(0 != memcmp(&out[0], &in[0], sizeof(message_t))){ errors += 1; }
+
+    // The slot is used in the next round
+    if(true != buffer_slot_push(&queue, &in[0])){ errors += 1; }
+    if(4 != buffer_slot_pop_batch(&queue, out, 4)){ errors += 1; }
+    if(0 != memcmp(&out[0], &in[1], 3 * sizeof(message_t))){ errors += 1; }
+    if(0 != memcmp(&out[3], &in[0], sizeof(message_t))){ errors += 1; }
+    if(0 != buffer_slot_pop_batch(&queue, out, 4)){ errors += 1; }
+
+    if(true != buffer_stop_try(&queue.buffer)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_span(void)
+{
+    int errors = 0;
+    char buf_set[10];
+    char * span;
+    const char * read;
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+    if(10 != buffer_write_reserve(&obj, &span)){ errors += 1; }
+    if(0 != buffer_space(&obj)){ errors += 1; }
+    memcpy(span, "a\nb\n", 4);
+    if(4 != buffer_write_commit(&obj, span, 4)){ errors += 1; }
+    if(6 != buffer_space(&obj)){ errors += 1; }
+    if(2 != buffer_lines(&obj)){ errors += 1; }
+
+    if(4 != buffer_read_span(&obj, &read)){ errors += 1; }
+    if(0 != memcmp(read, "a\nb\n", 4)){ errors += 1; }
+    if(2 != buffer_read_consume(&obj, 2)){ errors += 1; }
+    if(1 != buffer_lines(&obj)){ errors += 1; }
+    if(2 != buffer_read_consume(&obj, 5)){ errors += 1; }
+    if(0 != buffer_lines(&obj)){ errors += 1; }
+    if(true != buffer_is_empty(&obj)){ errors += 1; }
+    if(0 != buffer_read_span(&obj, &read) || (NULL != read)){ errors += 1; }
+
+    // A reservation blocks the reset of the buffer read empty, it is done when it is released unused
+    if(8 != buffer_write(&obj, "abcdefgh", 8)){ errors += 1; }
+    if(2 != buffer_write_reserve(&obj, &span)){ errors += 1; }
+    if(8 != buffer_read_consume(&obj, 8)){ errors += 1; }
+    if(0 != buffer_space(&obj)){ errors += 1; }
+    if(0 != buffer_write_commit(&obj, span, 0)){ errors += 1; }
+    if(10 != buffer_space(&obj)){ errors += 1; }
+    if(NULL != atomic_load(&obj.rewind_ptr)){ errors += 1; }
+
+    return errors;
+}
+
+static volatile _Atomic(size_t) buffer_test_executor_lines;
+
+static void buffer_test_executor_handler(buffer_t * object)
+{
+    char line[10];
+
+    while(0 < buffer_lines(object))
+    {
+        buffer_read_line(object, line, sizeof(line));
+        atomic_fetch_add(&buffer_test_executor_lines, 1);
+    }
+}
+
+static bool buffer_test_executor_wait(size_t lines)
+{
+    for(size_t i = 0; i < 100000; i++)
+    {
+        if(lines <= atomic_load(&buffer_test_executor_lines)) { return true; }
+        thrd_yield();
+    }
+
+    return false;
+}
+
+static int buffer_test_executor(void)
+{
+    int errors = 0;
+    char buf_set[10];
+    buffer_executor_t executor;
+    buffer_executor_line_t line;
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+    atomic_store(&buffer_test_executor_lines, 0);
+
+    if(true != buffer_executor_init(&executor, 2)){ errors += 1; }
+
+    // The line that already exists is passed immediately
+    if(2 != buffer_write(&obj, "a\n", 2)){ errors += 1; }
+    if(true != buffer_executor_line_attach(&executor, &line, &obj, buffer_test_executor_handler)){ errors += 1; }
+    if(true != buffer_test_executor_wait(1)){ errors += 1; }
+
+    if(4 != buffer_write(&obj, "b\nc\n", 4)){ errors += 1; }
+    if(true != buffer_test_executor_wait(3)){ errors += 1; }
+
+    buffer_executor_line_detach(&line);
+    buffer_executor_exit(&executor);
+
+    // Not passed after the detach
+    if(2 != buffer_write(&obj, "d\n", 2)){ errors += 1; }
+    if(1 != buffer_lines(&obj)){ errors += 1; }
+    if(3 != atomic_load(&buffer_test_executor_lines)){ errors += 1; }
+
+    return errors;
+}
+
+#ifdef BUFFER_ENABLE_HANDLER
+
+static int buffer_test_watermark_high;
+static int buffer_test_watermark_low;
+
+static void buffer_test_watermark_on_high(buffer_t * object)
+{
+    (void)object;
+    buffer_test_watermark_high++;
+}
+
+static void buffer_test_watermark_on_low(buffer_t * object)
+{
+    (void)object;
+    buffer_test_watermark_low++;
+}
+
+#endif
+
+static int buffer_test_watermark(void)
+{
+    int errors = 0;
+    char buf_set[10];
+    char buf_get[10];
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+#ifdef BUFFER_ENABLE_HANDLER
+    buffer_test_watermark_high = 0;
+    buffer_test_watermark_low = 0;
+    obj.on_watermark_high = buffer_test_watermark_on_high;
+    obj.on_watermark_low = buffer_test_watermark_on_low;
+#endif
+
+    if(false != buffer_watermark(&obj, 6, 6)){ errors += 1; }
+    if(false != buffer_watermark(&obj, 2, 11)){ errors += 1; }
+    if(true != buffer_watermark(&obj, 2, 6)){ errors += 1; }
+
+    if(5 != buffer_write(&obj, "abcde", 5)){ errors += 1; }
+    if(false != buffer_watermark_is_high(&obj)){ errors += 1; }
+
+    // Rising edge
+    if(2 != buffer_write(&obj, "fg", 2)){ errors += 1; }
+    if(true != buffer_watermark_is_high(&obj)){ errors += 1; }
+
+    // Between the watermarks nothing is signaled
+    if(4 != buffer_read(&obj, buf_get, 5)){ errors += 1; }
+    if(true != buffer_watermark_is_high(&obj)){ errors += 1; }
+
+    // Falling edge
+    if(1 != buffer_read(&obj, buf_get, 2)){ errors += 1; }
+    if(false != buffer_watermark_is_high(&obj)){ errors += 1; }
+    if(2 != buffer_read(&obj, buf_get, 3)){ errors += 1; }
+
+    // Clearing is a falling edge
+    if(6 != buffer_write(&obj, "abcdef", 6)){ errors += 1; }
+    if(true != buffer_watermark_is_high(&obj)){ errors += 1; }
+    if(true != buffer_clear(&obj)){ errors += 1; }
+    if(false != buffer_watermark_is_high(&obj)){ errors += 1; }
+
+#ifdef BUFFER_ENABLE_HANDLER
+    if(2 != buffer_test_watermark_high){ errors += 1; }
+    if(2 != buffer_test_watermark_low){ errors += 1; }
+#endif
+
+    // Disabled
+    if(true != buffer_watermark(&obj, 0, 0)){ errors += 1; }
+    if(10 != buffer_write(&obj, "0123456789", 10)){ errors += 1; }
+    if(false != buffer_watermark_is_high(&obj)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_until_writer(void * arg)
+{
+    struct timespec ts = { 0, 2000000 };
+    thrd_sleep(&ts, NULL);
+
+    buffer_write((buffer_t *)arg, "xy\n", 3);
+
+    return 0;
+}
+
+static int buffer_test_until(void)
+{
+    int errors = 0;
+    char buf_set[4];
+    char buf_get[10];
+    char c = 0;
+    size_t length = 0;
+    thrd_t thread;
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+    // Timeout
+    uint64_t start = buffer_until_now();
+    if(BUFFER_UNTIL_TIMEOUT != buffer_get_until(&obj, &c, buffer_until_after(1000000))){ errors += 1; }
+    if(buffer_until_now() - start < 1000000){ errors += 1; }
+    if(BUFFER_UNTIL_TIMEOUT != buffer_read_line_until(&obj, buf_get, sizeof(buf_get), &length, buffer_until_now())){ errors += 1; }
+
+    if(BUFFER_UNTIL_OK != buffer_set_until(&obj, 'a', buffer_until_now())){ errors += 1; }
+    if(BUFFER_UNTIL_OK != buffer_get_until(&obj, &c, buffer_until_now()) || ('a' != c)){ errors += 1; }
+
+    // As buffer_get(), the character '\0' is read
+    if(BUFFER_UNTIL_OK != buffer_set_until(&obj, '\0', buffer_until_now())){ errors += 1; }
+    if(BUFFER_UNTIL_OK != buffer_get_until(&obj, &c, buffer_until_now()) || ('\0' != c)){ errors += 1; }
+
+    // Full until the buffer was read empty
+    if(4 != buffer_write(&obj, "bcd\n", 4)){ errors += 1; }
+    if(BUFFER_UNTIL_TIMEOUT != buffer_set_until(&obj, 'e', buffer_until_after(1000000))){ errors += 1; }
+    if(BUFFER_UNTIL_OK != buffer_read_line_until(&obj, buf_get, sizeof(buf_get), &length, BUFFER_UNTIL_FOREVER)){ errors += 1; }
+    if((3 != length) || (0 != strcmp(buf_get, "bcd"))){ errors += 1; }
+
+    // Woken by the producer
+    if(thrd_success != thrd_create(&thread, buffer_test_until_writer, &obj)){ errors += 1; }
+    if(BUFFER_UNTIL_OK != buffer_read_line_until(&obj, buf_get, sizeof(buf_get), &length, buffer_until_after(5000000000))){ errors += 1; }
+    if((2 != length) || (0 != strcmp(buf_get, "xy"))){ errors += 1; }
+    thrd_join(thread, NULL);
+
+    // Stopped
+    if(true != buffer_stop_try(&obj)){ errors += 1; }
+    if(BUFFER_UNTIL_STOPPED != buffer_get_until(&obj, &c, BUFFER_UNTIL_FOREVER)){ errors += 1; }
+    if(BUFFER_UNTIL_STOPPED != buffer_set_until(&obj, 'a', BUFFER_UNTIL_FOREVER)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_chain(void)
+{
+    int errors = 0;
+    static char data[4 * 64];
+    char buf_get[20];
+    buffer_chunk_pool_t pool;
+    buffer_chain_t chain;
+    buffer_chain_t other;
+
+    if(true != buffer_chunk_pool_init(&pool, data, sizeof(data), 8)){ errors += 1; }
+    size_t count = buffer_chunk_pool_available(&pool);
+    if(count < 4){ errors += 1; }
+
+    if(true != buffer_chain_init(&chain, &pool, 3, true)){ errors += 1; }
+    if(true != buffer_chain_init(&other, &pool, 1, true)){ errors += 1; }
+    if((count - 2) != buffer_chunk_pool_available(&pool)){ errors += 1; }
+
+    // The waiters and watermarks of the embedded buffer are signaled
+    static buffer_group_t group;
+    if(true != buffer_group_init(&group)){ errors += 1; }
+    if(0 != buffer_group_add(&group, &chain.buffer, BUFFER_WAIT_LINE)){ errors += 1; }
+    if(true != buffer_watermark(&chain.buffer, 2, 6)){ errors += 1; }
+    if(BUFFER_GROUP_NONE != buffer_group_next(&group)){ errors += 1; }
+
+    // Grows over the chunk boundaries up to the maximum
+    if(13 != buffer_chain_write(&chain, "first\nsecond\n", 13)){ errors += 1; }
+    if(2 != buffer_chain_chunks(&chain)){ errors += 1; }
+    if(0 != buffer_group_next(&group)){ errors += 1; }
+    if(true != buffer_watermark_is_high(&chain.buffer)){ errors += 1; }
+    if(13 != buffer_length(&chain.buffer)){ errors += 1; }
+    if(2 != buffer_lines(&chain.buffer)){ errors += 1; }
+    if(11 != buffer_chain_write(&chain, "0123456789abcdef", 16)){ errors += 1; }
+    if(3 != buffer_chain_chunks(&chain)){ errors += 1; }
+    if(false != buffer_chain_set(&chain, 'x')){ errors += 1; }
+
+    if(5 != buffer_chain_read_line(&chain, buf_get, sizeof(buf_get)) || (0 != strcmp(buf_get, "first"))){ errors += 1; }
+
+    // The line crosses a chunk boundary, the first chunk is returned
+    if(6 != buffer_chain_read_line(&chain, buf_get, sizeof(buf_get)) || (0 != strcmp(buf_get, "second"))){ errors += 1; }
+    if(2 != buffer_chain_chunks(&chain)){ errors += 1; }
+    if(0 != buffer_lines(&chain.buffer)){ errors += 1; }
+
+    if('0' != buffer_chain_get(&chain)){ errors += 1; }
+    if(10 != buffer_chain_read(&chain, buf_get, sizeof(buf_get)) || (0 != strcmp(buf_get, "123456789a"))){ errors += 1; }
+    if(0 != buffer_length(&chain.buffer)){ errors += 1; }
+    if('\0' != buffer_chain_get(&chain)){ errors += 1; }
+    if(false != buffer_watermark_is_high(&chain.buffer)){ errors += 1; }
+
+    buffer_group_exit(&group);
+
+    buffer_chain_exit(&chain);
+    buffer_chain_exit(&other);
+    if(count != buffer_chunk_pool_available(&pool)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_group(void)
+{
+    int errors = 0;
+    char buf_set[3][8];
+    char buf_get[10];
+    static buffer_group_t group;
+    thrd_t thread;
+
+    buffer_t obj[3] =
+    {
+        BUFFER_INIT(buf_set[0], sizeof(buf_set[0]), true),
+        BUFFER_INIT(buf_set[1], sizeof(buf_set[1]), true),
+        BUFFER_INIT(buf_set[2], sizeof(buf_set[2]), true),
+    };
+
+    if(2 != buffer_write(&obj[2], "ab", 2)){ errors += 1; }
+
+    if(true != buffer_group_init(&group)){ errors += 1; }
+    if(0 != buffer_group_add(&group, &obj[0], BUFFER_WAIT_LINE)){ errors += 1; }
+    if(1 != buffer_group_add(&group, &obj[1], BUFFER_WAIT_LINE)){ errors += 1; }
+    if(BUFFER_GROUP_NONE != buffer_group_add(&group, &obj[2], BUFFER_WAIT_SPACE)){ errors += 1; }
+    if(2 != buffer_group_add(&group, &obj[2], BUFFER_WAIT_DATA)){ errors += 1; }
+
+    // Marked at once
+    if(2 != buffer_group_next(&group)){ errors += 1; }
+    if(BUFFER_GROUP_NONE != buffer_group_next(&group)){ errors += 1; }
+
+    // Not marked until rearmed, then marked at once if data remains
+    if(2 != buffer_write(&obj[0], "x\n", 2)){ errors += 1; }
+    if(1 != buffer_write(&obj[1], "y", 1)){ errors += 1; }
+    if(1 != buffer_write(&obj[2], "c", 1)){ errors += 1; }
+    if(0 != buffer_group_next(&group)){ errors += 1; }
+    if(true != buffer_group_rearm(&group, 2)){ errors += 1; }
+    if(2 != buffer_group_next(&group)){ errors += 1; }
+    if(3 != buffer_read(&obj[2], buf_get, sizeof(buf_get))){ errors += 1; }
+    if(true != buffer_group_rearm(&group, 2)){ errors += 1; }
+    if(BUFFER_GROUP_NONE != buffer_group_next(&group)){ errors += 1; }
+
+    // The members are returned in turn
+    if(1 != buffer_write(&obj[1], "\n", 1)){ errors += 1; }
+    if(true != buffer_group_rearm(&group, 0)){ errors += 1; }
+    if(0 != buffer_group_next(&group)){ errors += 1; }
+    if(1 != buffer_group_next(&group)){ errors += 1; }
+    if(1 != buffer_read_line(&obj[0], buf_get, sizeof(buf_get))){ errors += 1; }
+    if(1 != buffer_read_line(&obj[1], buf_get, sizeof(buf_get))){ errors += 1; }
+    if(true != buffer_group_rearm(&group, 0)){ errors += 1; }
+    if(true != buffer_group_rearm(&group, 1)){ errors += 1; }
+
+    // Timeout
+    if(BUFFER_GROUP_NONE != buffer_group_wait(&group, buffer_until_after(1000000))){ errors += 1; }
+
+    // Woken by the producer
+    if(thrd_success != thrd_create(&thread, buffer_test_until_writer, &obj[1])){ errors += 1; }
+    if(1 != buffer_group_wait(&group, buffer_until_after(5000000000))){ errors += 1; }
+    thrd_join(thread, NULL);
+
+    buffer_group_exit(&group);
+
+    return errors;
+}
+
+static size_t buffer_test_stage_upper(buffer_stage_t * stage, const char * src, size_t n, char * dest, size_t space, size_t * consumed)
+{
+    (void)stage;
+
+    size_t count = (n < space) ? n : space;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        dest[i] = (('a' <= src[i]) && (src[i] <= 'z')) ? (char)(src[i] - 'a' + 'A') : src[i];
+    }
+
+    *consumed = count;
+    return count;
+}
+
+static size_t buffer_test_stage_lines(buffer_stage_t * stage, const char * src, size_t n, char * dest, size_t space, size_t * consumed)
+{
+    (void)dest;
+    (void)space;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if('\n' == src[i]){ *(size_t *)stage->context += 1; }
+    }
+
+    *consumed = n;
+
+    return 0;
+}
+
+static int buffer_test_stage_writer(void * arg)
+{
+    for(size_t i = 0; i < 100; i++)
+    {
+        for(const char * c = "line\n"; '\0' != *c; c++)
+        {
+            buffer_set_until((buffer_t *)arg, *c, BUFFER_UNTIL_FOREVER);
+        }
+    }
+
+    return 0;
+}
+
+static int buffer_test_stage(void)
+{
+    int errors = 0;
+    char buf_raw[16];
+    char buf_upper[16];
+    static volatile size_t lines;
+    buffer_executor_t executor;
+    buffer_stage_t upper;
+    buffer_stage_t counter;
+    buffer_stage_stats_t stats;
+    thrd_t thread;
+
+    buffer_t raw = BUFFER_INIT(buf_raw, sizeof(buf_raw), true);
+    buffer_t out = BUFFER_INIT(buf_upper, sizeof(buf_upper), true);
+
+    lines = 0;
+
+    if(false != buffer_stage_init(&upper, &raw, buffer_test_stage_upper, &raw, NULL)){ errors += 1; }
+    if(true != buffer_stage_init(&upper, &raw, buffer_test_stage_upper, &out, NULL)){ errors += 1; }
+    if(true != buffer_stage_init(&counter, &out, buffer_test_stage_lines, NULL, (void *)&lines)){ errors += 1; }
+
+    // Already available characters are processed at once
+    if(3 != buffer_write(&raw, "ab\n", 3)){ errors += 1; }
+
+    if(true != buffer_executor_init(&executor, 2)){ return errors + 1; }
+    if(true != buffer_stage_attach(&upper, &executor)){ errors += 1; }
+    if(true != buffer_stage_attach(&counter, &executor)){ errors += 1; }
+
+    // The small buffers slow the writer down
+    if(thrd_success != thrd_create(&thread, buffer_test_stage_writer, &raw)){ errors += 1; }
+    thrd_join(thread, NULL);
+
+    uint64_t deadline = buffer_until_after(5000000000);
+    while((101 != lines) && (buffer_until_now() < deadline))
+    {
+        thrd_yield();
+    }
+
+    buffer_stage_detach(&upper);
+    buffer_stage_detach(&counter);
+    buffer_executor_exit(&executor);
+
+    if(101 != lines){ errors += 1; }
+
+    buffer_stage_stats(&upper, &stats);
+    if((503 != stats.bytes_in) || (503 != stats.bytes_out)){ errors += 1; }
+    if((0 == stats.runs) || (stats.busy_ns < stats.max_ns)){ errors += 1; }
+
+    buffer_stage_stats(&counter, &stats);
+    if((503 != stats.bytes_in) || (0 != stats.bytes_out)){ errors += 1; }
+
+    return errors;
+}
+
+static size_t buffer_test_stage_words(buffer_stage_t * stage, const char * src, size_t n, char * dest, size_t space, size_t * consumed)
+{
+    (void)src;
+    (void)dest;
+    (void)space;
+
+    // Only complete words of 4 characters are read
+    *(size_t *)stage->context += n / 4;
+    *consumed = n - (n % 4);
+
+    return 0;
+}
+
+static int buffer_test_stage_partial(void)
+{
+    int errors = 0;
+    char buf[16];
+    static volatile size_t words;
+    buffer_executor_t executor;
+    buffer_stage_t stage;
+    buffer_stage_stats_t stats;
+
+    buffer_t input = BUFFER_INIT(buf, sizeof(buf), true);
+
+    words = 0;
+
+    // The incomplete word does not queue the stage again and again, it is written before the
+    // stage is attached because buffer_write() publishes each character on its own
+    if(2 != buffer_write(&input, "ab", 2)){ errors += 1; }
+
+    if(true != buffer_stage_init(&stage, &input, buffer_test_stage_words, NULL, (void *)&words)){ errors += 1; }
+    if(true != buffer_executor_init(&executor, 1)){ return errors + 1; }
+    if(true != buffer_stage_attach(&stage, &executor)){ errors += 1; }
+
+    struct timespec ts = { 0, 20000000 };
+    thrd_sleep(&ts, NULL);
+
+    buffer_stage_stats(&stage, &stats);
+    if((1 != stats.runs) || (1 != stats.stalls)){ errors += 1; }
+
+    // The rest of the word is published at once
+    char * span;
+    if(buffer_write_reserve(&input, &span) < 2){ errors += 1; }
+    memcpy(span, "cd", 2);
+    if(2 != buffer_write_commit(&input, span, 2)){ errors += 1; }
+
+    uint64_t deadline = buffer_until_after(5000000000);
+    while((1 != words) && (buffer_until_now() < deadline))
+    {
+        thrd_yield();
+    }
+
+    buffer_stage_detach(&stage);
+    buffer_executor_exit(&executor);
+
+    if(1 != words){ errors += 1; }
+    if(0 != buffer_length(&input)){ errors += 1; }
+
+    buffer_stage_stats(&stage, &stats);
+    if((4 != stats.bytes_in) || (2 != stats.runs)){ errors += 1; }
+
+    return errors;
+}
+
+static size_t buffer_test_stage_expand(buffer_stage_t * stage, const char * src, size_t n, char * dest, size_t space, size_t * consumed)
+{
+    (void)stage;
+
+    // Each character becomes a unit of 4 characters, only whole units are written
+    size_t count = (n < (space / 4)) ? n : (space / 4);
+
+    for(size_t i = 0; i < (4 * count); i++)
+    {
+        dest[i] = src[i / 4];
+    }
+
+    *consumed = count;
+    return 4 * count;
+}
+
+static int buffer_test_stage_output(void)
+{
+    int errors = 0;
+    char buf_in[16];
+    char buf_out[10];
+    char buf_get[16];
+    buffer_executor_t executor;
+    buffer_stage_t stage;
+    buffer_stage_stats_t stats;
+
+    buffer_t input = BUFFER_INIT(buf_in, sizeof(buf_in), true);
+    buffer_t output = BUFFER_INIT(buf_out, sizeof(buf_out), true);
+
+    // The third unit does not fit into the rest of the output
+    if(3 != buffer_write(&input, "abc", 3)){ errors += 1; }
+
+    if(true != buffer_stage_init(&stage, &input, buffer_test_stage_expand, &output, NULL)){ errors += 1; }
+    if(true != buffer_executor_init(&executor, 1)){ return errors + 1; }
+    if(true != buffer_stage_attach(&stage, &executor)){ errors += 1; }
+
+    uint64_t deadline = buffer_until_after(5000000000);
+    while((8 != buffer_length(&output)) && (buffer_until_now() < deadline))
+    {
+        thrd_yield();
+    }
+
+    // The stage may write the third unit as soon as the output is reset
+    if(8 != buffer_read(&output, buf_get, 9)){ errors += 1; }
+    if(0 != strcmp(buf_get, "aaaabbbb")){ errors += 1; }
+
+    // Reading the output empty wakes the stage, no further input is needed
+    deadline = buffer_until_after(5000000000);
+    while((4 != buffer_length(&output)) && (buffer_until_now() < deadline))
+    {
+        thrd_yield();
+    }
+
+    buffer_stage_detach(&stage);
+    buffer_executor_exit(&executor);
+
+    if(4 != buffer_read(&output, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != strcmp(buf_get, "cccc")){ errors += 1; }
+    if(0 != buffer_length(&input)){ errors += 1; }
+
+    buffer_stage_stats(&stage, &stats);
+    if((3 != stats.bytes_in) || (12 != stats.bytes_out)){ errors += 1; }
+
+    return errors;
+}
+
+static volatile _Atomic(size_t) buffer_test_pool_lines;
+static volatile _Atomic(size_t) buffer_test_pool_overlaps;
+
+static void buffer_test_pool_handler(buffer_pool_channel_t * channel)
+{
+    volatile _Atomic(bool) * inside = (volatile _Atomic(bool) *)channel->context;
+    char buf_get[16];
+
+    // At most one worker thread drains a channel
+    if(atomic_exchange(inside, true)){ atomic_fetch_add(&buffer_test_pool_overlaps, 1); }
+
+    while(0 < buffer_lines(channel->object))
+    {
+        buffer_read_line(channel->object, buf_get, sizeof(buf_get));
+        atomic_fetch_add(&buffer_test_pool_lines, 1);
+    }
+
+    atomic_store(inside, false);
+}
+
+static int buffer_test_pool(void)
+{
+    int errors = 0;
+    // A multiple of the line length, the linear buffers are read empty
+    static char buf_set[16][30];
+    static buffer_t obj[16];
+    static buffer_pool_channel_t channels[16];
+    static volatile _Atomic(bool) inside[16];
+    static buffer_pool_t pool;
+    size_t expected = 0;
+
+    atomic_init(&buffer_test_pool_lines, 0);
+    atomic_init(&buffer_test_pool_overlaps, 0);
+
+    for(size_t i = 0; i < 16; i++)
+    {
+        buffer_init(&obj[i], buf_set[i], sizeof(buf_set[i]), true);
+        atomic_init(&inside[i], false);
+    }
+
+    // Already available lines are passed at once
+    if(3 != buffer_write(&obj[5], "ab\n", 3)){ errors += 1; }
+    expected += 1;
+
+    if(true != buffer_pool_init(&pool, 4)){ return errors + 1; }
+
+    if(false != buffer_pool_attach(&pool, &channels[0], &obj[0], BUFFER_WAIT_SPACE, buffer_test_pool_handler, (void *)&inside[0])){ errors += 1; }
+
+    for(size_t i = 0; i < 16; i++)
+    {
+        if(true != buffer_pool_attach(&pool, &channels[i], &obj[i], BUFFER_WAIT_LINE, buffer_test_pool_handler, (void *)&inside[i])){ errors += 1; }
+    }
+
+    // Skewed load, most lines go to the first channels
+    for(size_t n = 0; n < 2000; n++)
+    {
+        size_t i = (0 == (n % 4)) ? (n % 16) : (n % 2);
+
+        for(const char * c = "line\n"; '\0' != *c; c++)
+        {
+            if(BUFFER_UNTIL_OK != buffer_set_until(&obj[i], *c, buffer_until_after(5000000000))){ errors += 1; }
+        }
+
+        expected += 1;
+    }
+
+    uint64_t deadline = buffer_until_after(5000000000);
+    while((expected != atomic_load(&buffer_test_pool_lines)) && (buffer_until_now() < deadline))
+    {
+        thrd_yield();
+    }
+
+    for(size_t i = 0; i < 16; i++)
+    {
+        buffer_pool_detach(&channels[i]);
+    }
+
+    buffer_pool_exit(&pool);
+
+    if(expected != atomic_load(&buffer_test_pool_lines)){ errors += 1; }
+    if(0 != atomic_load(&buffer_test_pool_overlaps)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_grow(void)
+{
+    int errors = 0;
+    char buf_get[20];
+
+    buffer_t * obj = buffer_object_allocate(NULL, 4, true);
+    if(NULL == obj){ return 1; }
+
+    if(false != buffer_grow(obj, 4)){ errors += 1; }
+    if(4 != buffer_write(obj, "abcd", 4)){ errors += 1; }
+    if(0 != buffer_space(obj)){ errors += 1; }
+
+    // Pending until the full buffer was read empty
+    if(true != buffer_grow(obj, 16)){ errors += 1; }
+    if(true != buffer_grow(obj, 32)){ errors += 1; }
+    if(2 != buffer_read(obj, buf_get, 3)){ errors += 1; }
+    if(0 != buffer_space(obj)){ errors += 1; }
+    if(2 != buffer_read(obj, buf_get, 3) || (0 != strcmp(buf_get, "cd"))){ errors += 1; }
+    if(16 != buffer_space(obj)){ errors += 1; }
+    if(NULL != atomic_load(&obj->region_pending)){ errors += 1; }
+
+    if(16 != buffer_write(obj, "0123456789abcdef", 16)){ errors += 1; }
+    if(true != buffer_grow(obj, 32)){ errors += 1; }
+    if(16 != buffer_read(obj, buf_get, sizeof(buf_get)) || (0 != strcmp(buf_get, "0123456789abcdef"))){ errors += 1; }
+    if(32 != buffer_space(obj)){ errors += 1; }
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    // The replaced region is kept while a snapshot copies the unread characters
+    atomic_store(&obj->versions.readers, 1);
+    if(false != buffer_grow(obj, 8)){ errors += 1; }
+    if(NULL == atomic_load(&obj->region_retired)){ errors += 1; }
+    atomic_store(&obj->versions.readers, 0);
+#endif
+
+    // The replaced region is freed by the producer
+    if(NULL == atomic_load(&obj->region_retired)){ errors += 1; }
+    if(false != buffer_grow(obj, 8)){ errors += 1; }
+    if(NULL != atomic_load(&obj->region_retired)){ errors += 1; }
+
+    if(3 != buffer_write(obj, "xy\n", 3)){ errors += 1; }
+    if(2 != buffer_read_line(obj, buf_get, sizeof(buf_get)) || (0 != strcmp(buf_get, "xy"))){ errors += 1; }
+
+    // A copy does not own the region
+    buffer_t copy;
+    buffer_copy(obj, &copy);
+    if(NULL != copy.region){ errors += 1; }
+    if(true != buffer_equal(obj, &copy)){ errors += 1; }
+    buffer_grow_free(&copy);
+    if(NULL == obj->region){ errors += 1; }
+
+    buffer_object_free(obj);
+
+    return errors;
+}
+
+typedef struct buffer_test_shard_s
+{
+    char text[64];
+    size_t length;
+    size_t records;
+    size_t disorder;
+    uint64_t last[4];
+}buffer_test_shard_t;
+
+typedef struct buffer_test_shard_writer_s
+{
+    buffer_shard_t * object;
+    size_t index;
+}buffer_test_shard_writer_t;
+
+static void buffer_test_shard_handler(void * context, size_t index, uint64_t timestamp, const void * record, size_t n)
+{
+    buffer_test_shard_t * result = (buffer_test_shard_t *)context;
+
+    if((result->length + n) < sizeof(result->text))
+    {
+        memcpy(&result->text[result->length], record, n);
+        result->length += n;
+        result->text[result->length] = '\0';
+    }
+
+    // Each shard stays in order
+    if(timestamp < result->last[index]){ result->disorder += 1; }
+    result->last[index] = timestamp;
+    result->records += 1;
+}
+
+static int buffer_test_shard_writer(void * arg)
+{
+    buffer_test_shard_writer_t * writer = (buffer_test_shard_writer_t *)arg;
+
+    for(size_t n = 0; n < 1000; )
+    {
+        if(buffer_shard_push(writer->object, writer->index, "x", 1)){ n++; }
+        else { thrd_yield(); }
+    }
+
+    return 0;
+}
+
+static int buffer_test_shard(void)
+{
+    int errors = 0;
+    static char data[4 * 256];
+    buffer_shard_t object;
+    buffer_test_shard_t result;
+
+    if(false != buffer_shard_init(&object, data, sizeof(data), BUFFER_SHARD_COUNT + 1, BUFFER_SHARD_TIMESTAMP, true)){ errors += 1; }
+    if(false != buffer_shard_init(&object, data, 8, 2, BUFFER_SHARD_TIMESTAMP, true)){ errors += 1; }
+
+    // The oldest record of all shards first
+    if(true != buffer_shard_init(&object, data, sizeof(data), 3, BUFFER_SHARD_TIMESTAMP, true)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 0, 10, "a", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 0, 40, "d", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 1, 20, "b", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 2, 30, "c", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 2, 50, "", 0)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 1, 60, "ef", 2)){ errors += 1; }
+    if(false != buffer_shard_push_at(&object, 3, 70, "g", 1)){ errors += 1; }
+
+    memset(&result, 0, sizeof(result));
+    if(3 != buffer_shard_drain(&object, buffer_test_shard_handler, &result, 3)){ errors += 1; }
+    if(3 != buffer_shard_drain(&object, buffer_test_shard_handler, &result, 10)){ errors += 1; }
+    if(0 != strcmp(result.text, "abcdef")){ errors += 1; }
+    if(0 != buffer_shard_length(&object)){ errors += 1; }
+
+    // A batch of each shard in turn
+    if(true != buffer_shard_init(&object, data, sizeof(data), 2, BUFFER_SHARD_ROUND_ROBIN, true)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 1, 1, "1", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 0, 2, "a", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 1, 3, "2", 1)){ errors += 1; }
+    if(true != buffer_shard_push_at(&object, 0, 4, "b", 1)){ errors += 1; }
+
+    memset(&result, 0, sizeof(result));
+    if(1 != buffer_shard_drain(&object, buffer_test_shard_handler, &result, 1)){ errors += 1; }
+    if(3 != buffer_shard_drain(&object, buffer_test_shard_handler, &result, 10)){ errors += 1; }
+    if(0 != strcmp(result.text, "ab12")){ errors += 1; }
+
+    buffer_shard_stop_force(&object);
+    if(false != buffer_shard_push_at(&object, 0, 5, "c", 1)){ errors += 1; }
+
+    // One producer thread per shard
+    thrd_t threads[4];
+    buffer_test_shard_writer_t writers[4];
+
+    if(true != buffer_shard_init(&object, data, sizeof(data), 4, BUFFER_SHARD_TIMESTAMP, true)){ errors += 1; }
+    memset(&result, 0, sizeof(result));
+
+    for(size_t i = 0; i < 4; i++)
+    {
+        writers[i].object = &object;
+        writers[i].index = i;
+        if(thrd_success != thrd_create(&threads[i], buffer_test_shard_writer, &writers[i])){ errors += 1; }
+    }
+
+    uint64_t deadline = buffer_until_after(5000000000);
+    while((4000 != result.records) && (buffer_until_now() < deadline))
+    {
+        if(0 == buffer_shard_drain(&object, buffer_test_shard_handler, &result, 100)){ thrd_yield(); }
+    }
+
+    for(size_t i = 0; i < 4; i++)
+    {
+        thrd_join(threads[i], NULL);
+    }
+
+    if(4000 != result.records){ errors += 1; }
+    if(0 != result.disorder){ errors += 1; }
+
+    return errors;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+static int buffer_test_shm_reader(void * arg)
+{
+    return (int)buffer_shm_wait_data((buffer_shm_t *)arg, BUFFER_UNTIL_FOREVER);
+}
+
+static int buffer_test_shm(void)
+{
+    int errors = 0;
+    char buf_get[16];
+    const char * span;
+    char * reserved;
+    thrd_t thread;
+    int result = -1;
+    size_t size = 4096;
+
+    FILE * file = tmpfile();
+    if(NULL == file){ return 1; }
+    if(0 != ftruncate(fileno(file), (off_t)size)){ fclose(file); return 1; }
+
+    // Two mappings of the same segment at different addresses, like two processes
+    char * first = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(file), 0);
+    char * second = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(file), 0);
+    if((MAP_FAILED == first) || (MAP_FAILED == second) || (first == second))
+    {
+        if(MAP_FAILED != first){ munmap(first, size); }
+        if((MAP_FAILED != second) && (first != second)){ munmap(second, size); }
+        fclose(file);
+        return 1;
+    }
+
+    if(NULL != buffer_shm_attach(second, size)){ errors += 1; }
+    if(false != buffer_shm_init(first, 16, true)){ errors += 1; }
+    if(true != buffer_shm_init(first, size, true)){ errors += 1; }
+    if(NULL != buffer_shm_attach(second, 64)){ errors += 1; }
+
+    buffer_shm_t * producer = (buffer_shm_t *)first;
+    buffer_shm_t * consumer = buffer_shm_attach(second, size);
+    if(NULL == consumer)
+    {
+        munmap(first, size);
+        munmap(second, size);
+        fclose(file);
+        return errors + 1;
+    }
+
+    size_t capacity = buffer_shm_space(producer);
+    if((0 == capacity) || (capacity != (size_t)consumer->size)){ errors += 1; }
+
+    // Written in one mapping, read in the other
+    if(5 != buffer_shm_write(producer, "hello", 5)){ errors += 1; }
+    if(5 != buffer_shm_length(consumer)){ errors += 1; }
+    if(5 != buffer_shm_read_span(consumer, &span) || (0 != memcmp(span, "hello", 5))){ errors += 1; }
+    if((second + consumer->data_offset) != span){ errors += 1; }
+    if(2 != buffer_shm_read_consume(consumer, 2)){ errors += 1; }
+    if(3 != buffer_shm_read(consumer, buf_get, sizeof(buf_get)) || (0 != memcmp(buf_get, "llo", 3))){ errors += 1; }
+
+    // Up to 3 bytes before the end of the ring, the next write wraps around
+    while(3 < buffer_shm_write_reserve(producer, &reserved))
+    {
+        size_t n = buffer_shm_write_reserve(producer, &reserved) - 3;
+        memset(reserved, 'x', n);
+        if(n != buffer_shm_write_commit(producer, n)){ errors += 1; }
+        while(0 != buffer_shm_read_span(consumer, &span)){ buffer_shm_read_consume(consumer, 4096); }
+    }
+
+    if(6 != buffer_shm_write(producer, "abcdef", 6)){ errors += 1; }
+    if(3 != buffer_shm_read_span(consumer, &span) || (0 != memcmp(span, "abc", 3))){ errors += 1; }
+    if(6 != buffer_shm_read(consumer, buf_get, sizeof(buf_get)) || (0 != memcmp(buf_get, "abcdef", 6))){ errors += 1; }
+
+    // Full
+    while(0 != buffer_shm_write(producer, "0123456789", 10)){}
+    if(0 != buffer_shm_space(producer)){ errors += 1; }
+    if(BUFFER_UNTIL_TIMEOUT != buffer_shm_wait_space(producer, 1, buffer_until_after(1000000))){ errors += 1; }
+    if(BUFFER_UNTIL_STOPPED != buffer_shm_wait_space(producer, capacity + 1, BUFFER_UNTIL_FOREVER)){ errors += 1; }
+    while(0 != buffer_shm_read(consumer, buf_get, sizeof(buf_get))){}
+    if(BUFFER_UNTIL_OK != buffer_shm_wait_space(producer, capacity, BUFFER_UNTIL_FOREVER)){ errors += 1; }
+
+    // The sleeping consumer is woken through the other mapping
+    if(BUFFER_UNTIL_TIMEOUT != buffer_shm_wait_data(consumer, buffer_until_after(1000000))){ errors += 1; }
+    if(thrd_success != thrd_create(&thread, buffer_test_shm_reader, consumer)){ errors += 1; }
+    struct timespec ts = { 0, 2000000 };
+    thrd_sleep(&ts, NULL);
+    if(1 != buffer_shm_write(producer, "z", 1)){ errors += 1; }
+    thrd_join(thread, &result);
+    if(BUFFER_UNTIL_OK != result){ errors += 1; }
+
+    if(1 != buffer_shm_read(consumer, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(thrd_success != thrd_create(&thread, buffer_test_shm_reader, consumer)){ errors += 1; }
+    thrd_sleep(&ts, NULL);
+    if(true != buffer_shm_stop(producer)){ errors += 1; }
+    thrd_join(thread, &result);
+    if(BUFFER_UNTIL_STOPPED != result){ errors += 1; }
+    if(0 != buffer_shm_write(producer, "z", 1)){ errors += 1; }
+
+    munmap(first, size);
+    munmap(second, size);
+    fclose(file);
+
+    return errors;
+}
+
+static void buffer_test_mmap_crash(buffer_mmap_t * object)
+{
+    // Ends the mapping without commit or acknowledge, like a crash of the process
+    munmap(object->map, object->size);
+    close(object->fd);
+}
+
+static int buffer_test_mmap(void)
+{
+    int errors = 0;
+    char buf_get[16];
+    char path[] = "/tmp/buffer_test_mmap_XXXXXX";
+    buffer_mmap_t object;
+
+    int fd = mkstemp(path);
+    if(0 > fd){ return 1; }
+    close(fd);
+
+    if(false != buffer_mmap_open(&object, path, 1, BUFFER_MMAP_SYNC_ALWAYS, 0, 0)){ errors += 1; }
+    if(true != buffer_mmap_open(&object, path, 16384, BUFFER_MMAP_SYNC_ALWAYS, 0, 0)){ unlink(path); return errors + 1; }
+    if(0 != object.recovered){ errors += 1; }
+
+    if(6 != buffer_mmap_write(&object, "first\n", 6)){ errors += 1; }
+    if(7 != buffer_mmap_write(&object, "second\n", 7)){ errors += 1; }
+    if(6 != buffer_mmap_read(&object, buf_get, 6) || (0 != memcmp(buf_get, "first\n", 6))){ errors += 1; }
+    buffer_test_mmap_crash(&object);
+
+    // The unread line survives
+    if(true != buffer_mmap_open(&object, path, 0, BUFFER_MMAP_SYNC_GROUP, 1000, 0)){ unlink(path); return errors + 1; }
+    if((7 != object.recovered) || (7 != buffer_mmap_length(&object))){ errors += 1; }
+    if(7 != buffer_mmap_read(&object, buf_get, sizeof(buf_get)) || (0 != memcmp(buf_get, "second\n", 7))){ errors += 1; }
+
+    // Not committed yet, the group is not full
+    if(5 != buffer_mmap_write(&object, "third", 5)){ errors += 1; }
+    if(13 != atomic_load(&object.header->producer_offset)){ errors += 1; }
+    buffer_test_mmap_crash(&object);
+
+    if(true != buffer_mmap_open(&object, path, 0, BUFFER_MMAP_SYNC_NONE, 0, 0)){ unlink(path); return errors + 1; }
+    if(0 != object.recovered){ errors += 1; }
+
+    // Without msync the cursors are still stored
+    if(6 != buffer_mmap_write(&object, "fourth", 6)){ errors += 1; }
+    buffer_test_mmap_crash(&object);
+
+    if(true != buffer_mmap_open(&object, path, 0, BUFFER_MMAP_SYNC_GROUP, 64, 0)){ unlink(path); return errors + 1; }
+    if(6 != object.recovered){ errors += 1; }
+    if(6 != buffer_mmap_read(&object, buf_get, sizeof(buf_get)) || (0 != memcmp(buf_get, "fourth", 6))){ errors += 1; }
+
+    // The space is returned when the buffer was read empty
+    size_t written = 0;
+    while(0 != buffer_mmap_write(&object, "0123456789abcdef", 16)){ written += 16; }
+    if((written != buffer_mmap_length(&object)) || (0 == written)){ errors += 1; }
+    while(0 != buffer_mmap_read(&object, buf_get, sizeof(buf_get))){}
+    if(0 != buffer_mmap_length(&object)){ errors += 1; }
+    if(16 != buffer_mmap_write(&object, "0123456789abcdef", 16)){ errors += 1; }
+    if(true != buffer_mmap_close(&object)){ errors += 1; }
+
+    if(true != buffer_mmap_open(&object, path, 0, BUFFER_MMAP_SYNC_ALWAYS, 0, 0)){ unlink(path); return errors + 1; }
+    if(16 != object.recovered){ errors += 1; }
+
+    // An invalid header is reported, the file is not initialized again
+    object.header->magic = 0;
+    buffer_test_mmap_crash(&object);
+
+    errno = 0;
+    if(false != buffer_mmap_open(&object, path, 0, BUFFER_MMAP_SYNC_ALWAYS, 0, 0)){ errors += 1; }
+    if(EBADMSG != errno){ errors += 1; }
+
+    // A new buffer is only created in place of a removed file
+    unlink(path);
+    if(true != buffer_mmap_open(&object, path, 16384, BUFFER_MMAP_SYNC_ALWAYS, 0, 0)){ unlink(path); return errors + 1; }
+    if((0 != object.recovered) || (0 != buffer_mmap_length(&object))){ errors += 1; }
+    if(true != buffer_mmap_close(&object)){ errors += 1; }
+
+    unlink(path);
+
+    return errors;
+}
+
+static int buffer_test_fd(void)
+{
+    int errors = 0;
+    char buf_set[8];
+    char buf_get[30];
+    int fds[2];
+
+    buffer_t obj = BUFFER_INIT(buf_set, sizeof(buf_set), true);
+
+    if(0 != pipe(fds)){ return 1; }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    // Nothing to read
+    if((-1 != buffer_fill_from_fd(&obj, fds[0], 100)) || (EAGAIN != errno)){ errors += 1; }
+
+    if(11 != write(fds[1], "I\nYou\nHe\nIt", 11)){ errors += 1; }
+    if(8 != buffer_fill_from_fd(&obj, fds[0], 100)){ errors += 1; }
+    if(2 != buffer_lines(&obj)){ errors += 1; }
+
+    // The buffer is full
+    if((-1 != buffer_fill_from_fd(&obj, fds[0], 100)) || (ENOBUFS != errno)){ errors += 1; }
+
+    if(true != buffer_skip_line(&obj)){ errors += 1; }
+    if(2 != buffer_drain_to_fd(&obj, fds[1], 2)){ errors += 1; }
+    if(4 != buffer_drain_to_fd(&obj, fds[1], 100)){ errors += 1; }
+    if(0 != buffer_drain_to_fd(&obj, fds[1], 100)){ errors += 1; }
+
+    // The pipe contains the rest "\nIt" and the drained "You\nHe"
+    close(fds[1]);
+    if(8 != buffer_fill_from_fd(&obj, fds[0], 100)){ errors += 1; }
+    if(0 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(5 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != strcmp(buf_get, "ItYou")){ errors += 1; }
+    if(1 != buffer_read(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(1 != buffer_fill_from_fd(&obj, fds[0], 100)){ errors += 1; }
+
+    // End of file
+    if(0 != buffer_fill_from_fd(&obj, fds[0], 100)){ errors += 1; }
+
+    close(fds[0]);
+
+    return errors;
+}
+
+static int buffer_test_uring(void)
+{
+    int errors = 0;
+    char buf_in[16];
+    char buf_out[16];
+    char buf_get[16] = { 0 };
+    int in[2];
+    int out[2];
+    buffer_uring_channel_t channels[2];
+    buffer_uring_t uring;
+
+    buffer_t obj_in = BUFFER_INIT(buf_in, sizeof(buf_in), true);
+    buffer_t obj_out = BUFFER_INIT(buf_out, sizeof(buf_out), true);
+
+    if((0 != pipe(in)) || (0 != pipe(out))){ return 1; }
+    fcntl(in[0], F_SETFL, fcntl(in[0], F_GETFL) | O_NONBLOCK);
+
+    buffer_uring_channel(&channels[0], &obj_in, in[0], false);
+    buffer_uring_channel(&channels[1], &obj_out, out[1], true);
+    if(true != buffer_uring_init(&uring, channels, 2)){ errors += 1; }
+
+    buffer_write(&obj_out, "Hello\n", 16);
+    if(6 != write(in[1], "World\n", 6)){ errors += 1; }
+
+    size_t total = 0;
+    for(int i = 0; (i < 10) && (total < 12); i++)
+    {
+        total += buffer_uring_poll(&uring, true);
+    }
+    if(12 != total){ errors += 1; }
+    if(1 != buffer_lines(&obj_in)){ errors += 1; }
+    if(true != buffer_is_empty(&obj_out)){ errors += 1; }
+    if(6 != read(out[0], buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != memcmp(buf_get, "Hello\n", 6)){ errors += 1; }
+
+    buffer_uring_exit(&uring);
+
+    // Waits until the producer publishes characters for the egress channel
+    thrd_t thread;
+
+    if(true != buffer_uring_init(&uring, &channels[1], 1)){ errors += 1; }
+    if(thrd_success != thrd_create(&thread, buffer_test_until_writer, &obj_out)){ errors += 1; }
+
+    total = buffer_uring_poll(&uring, true);
+    if(uring.active && (3 != total)){ errors += 1; }
+
+    thrd_join(thread, NULL);
+
+    // Without io_uring the characters are only written now
+    total += buffer_uring_poll(&uring, false);
+    if(3 != total){ errors += 1; }
+    if(3 != read(out[0], buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != memcmp(buf_get, "xy\n", 3)){ errors += 1; }
+
+    buffer_uring_exit(&uring);
+
+    close(in[0]); close(in[1]); close(out[0]); close(out[1]);
+
+    return errors;
+}
+
+#endif
+
 static int buffer_test_buffer_read_to(void)
 {
     int errors = 0;
@@ -1640,6 +2934,451 @@ static int buffer_test_buffer_object_allocate_null_free(void)
     return errors;
 }
 
+#ifdef BUFFER_ENABLE_STATS
+
+static int buffer_test_stats(void)
+{
+    int errors = 0;
+
+    char buf[4];
+    buffer_stats_snapshot_t stats;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+
+    buffer_stats_snapshot(&obj, &stats);
+    if(0 != stats.set_ops){ errors += 1; }
+    if(0 != stats.peak){ errors += 1; }
+    if(0 != stats.resets){ errors += 1; }
+
+    buffer_set(&obj, '1');
+    buffer_set(&obj, '2');
+    buffer_set_possible_or_skip(&obj, '3');
+    buffer_set_possible_or_skip(&obj, '4');
+    buffer_set_possible_or_skip(&obj, '5');
+    buffer_set_possible_or_skip(&obj, '6');
+
+    buffer_stats_snapshot(&obj, &stats);
+    if(4 != stats.set_ops){ errors += 1; }
+    if(4 != stats.bytes_in){ errors += 1; }
+    if(2 != stats.full){ errors += 1; }
+    if(2 != stats.skip){ errors += 1; }
+    if(4 != stats.peak){ errors += 1; }
+
+    buffer_get(&obj);
+    buffer_get(&obj);
+    buffer_get_available_or_null(&obj);
+    buffer_get_available_or_null(&obj);
+    buffer_get_available_or_null(&obj);
+
+    buffer_stats_snapshot(&obj, &stats);
+    if(4 != stats.get_ops){ errors += 1; }
+    if(4 != stats.bytes_out){ errors += 1; }
+    if(1 != stats.resets){ errors += 1; }
+    if(4 != stats.peak){ errors += 1; }
+
+    buffer_test_set_get_blocking_wait_counter = 0;
+    obj.on_wait_get = buffer_test_set_get_blocking_wait;
+    buffer_get(&obj);
+    obj.on_wait_get = NULL;
+
+    buffer_stats_snapshot(&obj, &stats);
+    if(11 != stats.wait_get){ errors += 1; }
+
+    buffer_reset(&obj, true);
+    buffer_stats_snapshot(&obj, &stats);
+    if(0 != stats.set_ops){ errors += 1; }
+    if(0 != stats.wait_get){ errors += 1; }
+
+    return errors;
+}
+
+#endif
+
+#ifdef BUFFER_ENABLE_LATENCY
+
+static int buffer_test_latency(void)
+{
+    int errors = 0;
+
+    char buf[30];
+    char buf_get[30];
+    static buffer_latency_t latency;
+    static buffer_histogram_t merged;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+
+    buffer_histogram_clear(&latency.histogram);
+    buffer_histogram_clear(&merged);
+    if(true != buffer_latency_attach(&obj, &latency)){ errors += 1; }
+
+    buffer_write(&obj, "I\nYou\nHe\n", 30);
+    if(3 != latency.published){ errors += 1; }
+
+    buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if(2 != buffer_histogram_count(&latency.histogram)){ errors += 1; }
+
+    // The remaining line is removed without being read
+    buffer_clear(&obj);
+    buffer_write(&obj, "She\n", 30);
+    buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if(3 != buffer_histogram_count(&latency.histogram)){ errors += 1; }
+    if(4 != atomic_load(&latency.consumed)){ errors += 1; }
+
+    buffer_histogram_merge(&merged, &latency.histogram);
+    buffer_histogram_merge(&merged, &latency.histogram);
+    if(6 != buffer_histogram_count(&merged)){ errors += 1; }
+
+    buffer_histogram_clear(&merged);
+    for(uint64_t i = 1; i <= 1000; i++)
+    {
+        buffer_histogram_record(&merged, i);
+    }
+    uint64_t p50 = buffer_histogram_percentile(&merged, 50.0);
+    uint64_t p99 = buffer_histogram_percentile(&merged, 99.0);
+    if((p50 < 500) || (p50 > 563)){ errors += 1; }
+    if((p99 < 990) || (p99 > 1000)){ errors += 1; }
+    if(1000 != buffer_histogram_percentile(&merged, 100.0)){ errors += 1; }
+    if(1 != buffer_histogram_percentile(&merged, 0.1)){ errors += 1; }
+
+    return errors;
+}
+
+#endif
+
+static int buffer_test_delimiters(void)
+{
+    int errors = 0;
+    char buf[64];
+    char buf_get[16];
+    buffer_delimiters_t delimiters;
+    buffer_delimiters_t wide;
+    const char * line;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+
+    if(false != buffer_delimiters_init(&delimiters, NULL, NULL)){ errors += 1; }
+    if(false != buffer_delimiters_init(&delimiters, NULL, "123456789")){ errors += 1; }
+    if(true != buffer_delimiters_init(&delimiters, ";", "\r\n")){ errors += 1; }
+    if(2 != delimiters.count){ errors += 1; }
+
+    buffer_write(&obj, "x", 1);
+    if(false != buffer_delimiters_attach(&obj, &delimiters)){ errors += 1; }
+    buffer_clear(&obj);
+    if(true != buffer_delimiters_attach(&obj, &delimiters)){ errors += 1; }
+
+    // Characters and spans count the same lines, only the complete terminator ends a line and is removed from it
+    buffer_write(&obj, "a;bc\r\nd\n", 64);
+    if(2 != buffer_lines(&obj)){ errors += 1; }
+    if(1 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != strcmp(buf_get, "a")){ errors += 1; }
+    if(2 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != strcmp(buf_get, "bc")){ errors += 1; }
+    if(0 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(2 != buffer_length(&obj)){ errors += 1; }
+
+    // The terminator is split over two writes
+    buffer_write(&obj, "\r", 64);
+    if(0 != buffer_lines(&obj)){ errors += 1; }
+    if(true != buffer_set(&obj, '\n')){ errors += 1; }
+    if(1 != buffer_lines(&obj)){ errors += 1; }
+    if(2 != buffer_read_line(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(0 != strcmp(buf_get, "d\n")){ errors += 1; }
+
+    buffer_write(&obj, "efghijklmnopqrstuvwxyz;", 64);
+    if(1 != buffer_lines(&obj)){ errors += 1; }
+    if(22 != buffer_look_line(&obj, &line)){ errors += 1; }
+    if(true != buffer_skip_line(&obj)){ errors += 1; }
+    if((0 != buffer_lines(&obj)) || (0 != buffer_length(&obj))){ errors += 1; }
+
+    // The consumer has removed the first character of the terminator before the last one is written
+    buffer_write(&obj, "gh\r", 64);
+    if('g' != buffer_get(&obj)){ errors += 1; }
+    if('h' != buffer_get_available_or_null(&obj)){ errors += 1; }
+    if('\r' != buffer_get(&obj)){ errors += 1; }
+    buffer_write(&obj, "\n", 64);
+    if(1 != buffer_lines(&obj)){ errors += 1; }
+    if('\n' != buffer_get(&obj)){ errors += 1; }
+    if(0 != buffer_lines(&obj)){ errors += 1; }
+
+    const char * crlf = "\r\n\n";
+    if((crlf + 1) != buffer_find_line_end(&obj, 0, crlf, 3)){ errors += 1; }
+    if(NULL != buffer_find_line_end(&obj, 0, crlf + 1, 2)){ errors += 1; }
+    if((crlf + 1) != buffer_find_line_end(&obj, buffer_line_tail(0, crlf, 1), crlf + 1, 2)){ errors += 1; }
+    if(0x0d0a0aULL != buffer_line_tail(0, crlf, 3)){ errors += 1; }
+    buffer_clear(&obj);
+
+    // More than eight high nibbles share a bucket, the candidates are checked
+    if(true != buffer_delimiters_init(&wide, "\t\x1b !0@P`p\x83", NULL)){ errors += 1; }
+    if(true != buffer_delimiters_attach(&obj, &wide)){ errors += 1; }
+    const char * text = "sssssssssssssssssssssssssssssssss\x83sss";
+    if(NULL != buffer_find_end_of_line(&obj, text, 33)){ errors += 1; }
+    if((text + 33) != buffer_find_end_of_line(&obj, text, 37)){ errors += 1; }
+    if((text + 33) != buffer_find_end_of_line(&obj, text + 33, 4)){ errors += 1; }
+
+    if(true != buffer_delimiters_attach(&obj, NULL)){ errors += 1; }
+    if(NULL != buffer_find_end_of_line(&obj, text, 37)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_match(void)
+{
+    int errors = 0;
+    char buf[64];
+    char buf_get[8];
+    buffer_match_t matcher;
+    size_t pattern;
+    size_t length;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+
+    const char * const responses[] = { "OK\r\n", "ERROR\r\n", "+CME ERROR", "> " };
+    const char * const empty[] = { "OK", "" };
+    const char * const overlap[] = { "he", "she", "his", "hers" };
+    const char * const wide[] = { "0123456789012345678901234567890123456789012345678901234567890123456789" };
+
+    if(false != buffer_match_init(&matcher, &obj, empty, 2)){ errors += 1; }
+    if(false != buffer_match_init(&matcher, &obj, wide, 1)){ errors += 1; }
+    if(false != buffer_match_init(&matcher, &obj, responses, BUFFER_MATCH_PATTERNS + 1)){ errors += 1; }
+    if(true != buffer_match_init(&matcher, &obj, responses, 4)){ errors += 1; }
+
+    // The state is kept between the polls, a pattern may be split
+    buffer_write(&obj, "AT\r\r\nO", 64);
+    if(false != buffer_match_read_to(&matcher, buf_get, sizeof(buf_get), &pattern, &length)){ errors += 1; }
+    if(6 != buffer_length(&obj)){ errors += 1; }
+    buffer_write(&obj, "K\r\n+CME ERROR: 10\r\n", 64);
+    if(true != buffer_match_read_to(&matcher, buf_get, sizeof(buf_get), &pattern, &length)){ errors += 1; }
+    if((0 != pattern) || (5 != length)){ errors += 1; }
+    if(0 != strcmp(buf_get, "AT\r\r\n")){ errors += 1; }
+    if(true != buffer_match_read_to(&matcher, NULL, 0, &pattern, &length)){ errors += 1; }
+    if((2 != pattern) || (0 != length)){ errors += 1; }
+    if(6 != buffer_length(&obj)){ errors += 1; }
+
+    // Characters removed by another read function restart the automaton
+    buffer_clear(&obj);
+    buffer_write(&obj, "ER", 64);
+    if(false != buffer_match_read_to(&matcher, NULL, 0, NULL, NULL)){ errors += 1; }
+    if('E' != buffer_get(&obj)){ errors += 1; }
+    buffer_write(&obj, "ROR\r\n", 64);
+    if(false != buffer_match_read_to(&matcher, NULL, 0, NULL, NULL)){ errors += 1; }
+    if(true != buffer_match_reset(&matcher)){ errors += 1; }
+    buffer_write(&obj, "long text> ", 64);
+    if(true != buffer_match_read_to(&matcher, buf_get, sizeof(buf_get), &pattern, &length)){ errors += 1; }
+    if((3 != pattern) || (15 != length)){ errors += 1; }
+    if(0 != strcmp(buf_get, "RROR\r\nl")){ errors += 1; }
+    if(0 != buffer_length(&obj)){ errors += 1; }
+
+    // The buffer was read empty and written again at the same position
+    if(true != buffer_match_init(&matcher, &obj, empty, 1)){ errors += 1; }
+    buffer_write(&obj, "abcde", 64);
+    if(false != buffer_match_read_to(&matcher, NULL, 0, NULL, NULL)){ errors += 1; }
+    if(5 != buffer_read(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    buffer_write(&obj, "OKxyz", 64);
+    if(true != buffer_match_read_to(&matcher, buf_get, sizeof(buf_get), &pattern, &length)){ errors += 1; }
+    if((0 != pattern) || (0 != length)){ errors += 1; }
+    if(3 != buffer_length(&obj)){ errors += 1; }
+    buffer_clear(&obj);
+
+    // The pattern ending first wins, on the same character the longest
+    if(true != buffer_match_init(&matcher, &obj, overlap, 4)){ errors += 1; }
+    buffer_write(&obj, "ushers", 64);
+    if(true != buffer_match_read_to(&matcher, buf_get, sizeof(buf_get), &pattern, &length)){ errors += 1; }
+    if((1 != pattern) || (1 != length)){ errors += 1; }
+    if(0 != strcmp(buf_get, "u")){ errors += 1; }
+    if(false != buffer_match_read_to(&matcher, buf_get, sizeof(buf_get), &pattern, &length)){ errors += 1; }
+    if(2 != buffer_length(&obj)){ errors += 1; }
+
+    return errors;
+}
+
+static int buffer_test_crc(void)
+{
+    int errors = 0;
+    char buf[32];
+    uint32_t value = 0;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+
+    if(0xe3069283u != buffer_crc32c(0, "123456789", 9)){ errors += 1; }
+    if(0xe3069283u != buffer_crc32c(buffer_crc32c(0, "1234", 4), "56789", 5)){ errors += 1; }
+    if(0 != buffer_crc32c(0, NULL, 0)){ errors += 1; }
+
+    // The longer input uses the wide steps and the remaining bytes
+    if(buffer_crc32c(0, "abcdefghijklmnopqrstuvwxyz", 26) != buffer_crc32c(buffer_crc32c(0, "abcdefghijklm", 13), "nopqrstuvwxyz", 13)){ errors += 1; }
+
+    buffer_write(&obj, "x123456789y", 32);
+    if(true != buffer_crc_range(&obj, 1, 9, &value)){ errors += 1; }
+    if(0xe3069283u != value){ errors += 1; }
+    if(false != buffer_crc_range(&obj, 3, 9, &value)){ errors += 1; }
+    buffer_clear(&obj);
+
+#ifdef BUFFER_ENABLE_CRC
+    static buffer_crc_t crc;
+    char buf_get[32];
+    char * span;
+    const char record[] = { '1', '2', '\n', '3' };
+
+    if(true != buffer_crc_attach(&obj, &crc)){ errors += 1; }
+    if(false != buffer_crc_frame(&obj, &value)){ errors += 1; }
+
+    // Single characters and spans give the same values, the End-Of-Line character is not included
+    buffer_write(&obj, "123456789\nab", 32);
+    if(true != buffer_crc_frame(&obj, &value)){ errors += 1; }
+    if(0xe3069283u != value){ errors += 1; }
+
+    if(buffer_write_reserve(&obj, &span) < 4){ errors += 1; }
+    memcpy(span, "c\nd\n", 4);
+    buffer_write_commit(&obj, span, 4);
+    if(3 != atomic_load(&crc.published)){ errors += 1; }
+
+    buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if((true != buffer_crc_frame(&obj, &value)) || (buffer_crc32c(0, "abc", 3) != value)){ errors += 1; }
+    buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if((true != buffer_crc_frame(&obj, &value)) || (buffer_crc32c(0, "d", 1) != value)){ errors += 1; }
+    buffer_read_line(&obj, buf_get, sizeof(buf_get));
+    if(false != buffer_crc_frame(&obj, &value)){ errors += 1; }
+
+    // A record is one frame, its data may contain the End-Of-Line character
+    if(true != buffer_push_record(&obj, record, sizeof(record))){ errors += 1; }
+    if((true != buffer_crc_frame(&obj, &value)) || (buffer_crc32c(0, record, sizeof(record)) != value)){ errors += 1; }
+    if(sizeof(record) != buffer_pop_record(&obj, buf_get, sizeof(buf_get))){ errors += 1; }
+    if(false != buffer_crc_frame(&obj, &value)){ errors += 1; }
+
+    // Removed frames are released
+    buffer_write(&obj, "e\nf\n", 32);
+    buffer_clear(&obj);
+    buffer_write(&obj, "g\n", 32);
+    if((true != buffer_crc_frame(&obj, &value)) || (buffer_crc32c(0, "g", 1) != value)){ errors += 1; }
+
+    buffer_crc_attach(&obj, NULL);
+#endif
+
+    return errors;
+}
+
+#ifdef BUFFER_ENABLE_SNAPSHOT
+
+static int buffer_test_snapshot_reader(void * arg)
+{
+    char c;
+
+    // All characters of buffer_test_stage_writer()
+    for(size_t i = 0; i < 500; i++)
+    {
+        buffer_get_until((buffer_t *)arg, &c, BUFFER_UNTIL_FOREVER);
+    }
+
+    return 0;
+}
+
+typedef struct buffer_test_snapshot_grow_s
+{
+    buffer_t * object;
+    volatile _Atomic(bool) done;
+}buffer_test_snapshot_grow_t;
+
+static int buffer_test_snapshot_grow(void * arg)
+{
+    buffer_test_snapshot_grow_t * context = (buffer_test_snapshot_grow_t *)arg;
+    char text[512];
+    char buf_get[520];
+
+    memset(text, 'x', sizeof(text));
+
+    // Each round moves the buffer to a larger region and frees the region of the round before
+    for(size_t size = 16; size <= 512; size += 8)
+    {
+        buffer_write(context->object, text, buffer_space(context->object));
+        buffer_grow(context->object, size);
+        buffer_read(context->object, buf_get, sizeof(buf_get));
+    }
+
+    atomic_store(&context->done, true);
+
+    return 0;
+}
+
+static int buffer_test_snapshot(void)
+{
+    int errors = 0;
+    char buf[16];
+    char unread[16];
+    buffer_snapshot_t snapshot;
+    thrd_t writer;
+    thrd_t reader;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+
+    if(false != buffer_snapshot(&obj, NULL, NULL, 0)){ errors += 1; }
+    if(false != buffer_snapshot(&obj, &snapshot, NULL, 1)){ errors += 1; }
+
+    buffer_write(&obj, "ab\ncd", 16);
+    buffer_get(&obj);
+
+    if(true != buffer_snapshot(&obj, &snapshot, unread, 2)){ errors += 1; }
+    if(16 != snapshot.capacity){ errors += 1; }
+    if((1 != snapshot.consumer_offset) || (5 != snapshot.producer_offset)){ errors += 1; }
+    if((4 != snapshot.length) || (1 != snapshot.lines)){ errors += 1; }
+    if((2 != snapshot.copied) || (0 != memcmp(unread, "b\n", 2))){ errors += 1; }
+    if((0 == snapshot.producer_version) || (0 != (snapshot.producer_version & 1))){ errors += 1; }
+    if((0 == snapshot.consumer_version) || (0 != (snapshot.consumer_version & 1))){ errors += 1; }
+
+    // The metadata of a running pipeline always matches
+    buffer_clear(&obj);
+
+    if(thrd_success != thrd_create(&writer, buffer_test_stage_writer, &obj)){ errors += 1; }
+    if(thrd_success != thrd_create(&reader, buffer_test_snapshot_reader, &obj)){ errors += 1; }
+
+    size_t consistent = 0;
+
+    for(size_t i = 0; i < 10000; i++)
+    {
+        if(!buffer_snapshot(&obj, &snapshot, unread, sizeof(unread))) { continue; }
+
+        consistent++;
+
+        size_t lines = 0;
+
+        for(size_t k = 0; k < snapshot.copied; k++)
+        {
+            if('\n' == unread[k]) { lines++; }
+        }
+
+        if((snapshot.producer_offset - snapshot.consumer_offset) != snapshot.length){ errors += 1; break; }
+        if((snapshot.copied != snapshot.length) || (lines != snapshot.lines)){ errors += 1; break; }
+    }
+
+    thrd_join(writer, NULL);
+    thrd_join(reader, NULL);
+
+    if(0 == consistent){ errors += 1; }
+
+    if(true != buffer_snapshot(&obj, &snapshot, NULL, 0)){ errors += 1; }
+    if((0 != snapshot.length) || (0 != snapshot.lines) || (0 != snapshot.copied)){ errors += 1; }
+
+    // The unread characters are copied while the producer frees replaced regions
+    buffer_test_snapshot_grow_t grow = { buffer_object_allocate(NULL, 8, true), false };
+    if(NULL == grow.object){ return errors + 1; }
+
+    if(thrd_success != thrd_create(&writer, buffer_test_snapshot_grow, &grow)){ errors += 1; }
+
+    while(!atomic_load(&grow.done))
+    {
+        buffer_snapshot(grow.object, &snapshot, unread, sizeof(unread));
+    }
+
+    thrd_join(writer, NULL);
+
+    if(512 != buffer_space(grow.object)){ errors += 1; }
+
+    buffer_object_free(grow.object);
+
+    return errors;
+}
+
+#endif
+
 static void buffer_run_example_handler(buffer_t * object)
 {
     char buf[10];
@@ -1730,9 +3469,42 @@ int buffer_testbench(void)
     errors += buffer_test_buffer_write();
     errors += buffer_test_buffer_read();
     errors += buffer_test_buffer_read_line();
+    errors += buffer_test_line_index();
+    errors += buffer_test_record();
+    errors += buffer_test_slot();
+    errors += buffer_test_span();
+    errors += buffer_test_executor();
+    errors += buffer_test_watermark();
+    errors += buffer_test_until();
+    errors += buffer_test_chain();
+    errors += buffer_test_group();
+    errors += buffer_test_stage();
+    errors += buffer_test_stage_partial();
+    errors += buffer_test_stage_output();
+    errors += buffer_test_pool();
+    errors += buffer_test_grow();
+    errors += buffer_test_shard();
+#if defined(__unix__) || defined(__APPLE__)
+    errors += buffer_test_fd();
+    errors += buffer_test_shm();
+    errors += buffer_test_mmap();
+    errors += buffer_test_uring();
+#endif
     errors += buffer_test_buffer_read_to();
     errors += buffer_test_buffer_object_allocate_free();
     errors += buffer_test_buffer_object_allocate_null_free();
+#ifdef BUFFER_ENABLE_STATS
+    errors += buffer_test_stats();
+#endif
+#ifdef BUFFER_ENABLE_LATENCY
+    errors += buffer_test_latency();
+#endif
+    errors += buffer_test_delimiters();
+    errors += buffer_test_match();
+    errors += buffer_test_crc();
+#ifdef BUFFER_ENABLE_SNAPSHOT
+    errors += buffer_test_snapshot();
+#endif
 
     buffer_run_example_1();
     buffer_run_example_2();
@@ -13,6 +13,10 @@
 #include <iostream>
 #include <thread>
 
+#if defined(__cpp_impl_coroutine)
+#include "buffer_coro.hpp"
+#endif
+
 
 /*---------------------------------------------------------------------*
  *  private: definitions
@@ -117,6 +121,99 @@ static int buffer_test_threads(void)
     return errors;
 }
 
+#if defined(__cpp_impl_coroutine)
+
+// Coroutine without result, starts immediately
+struct buffer_test_task
+{
+    struct promise_type
+    {
+        buffer_test_task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+};
+
+static buffer_test_task buffer_test_coro_reader(buffer_coro::channel channel, std::string * lines)
+{
+    char line[16];
+
+    while(auto size = co_await channel.read_line(line))
+    {
+        lines->append(line, *size);
+        lines->push_back('|');
+    }
+}
+
+static buffer_test_task buffer_test_coro_read_to(buffer_coro::channel channel, std::string * text)
+{
+    char dest[16];
+
+    if(auto size = co_await channel.read_to("eot", dest))
+    {
+        text->append(dest, *size);
+    }
+}
+
+static buffer_test_task buffer_test_coro_writer(buffer_coro::channel channel, std::string_view text, size_t * written)
+{
+    *written = co_await channel.write(text);
+}
+
+static int buffer_test_coro(void)
+{
+    int errors = 0;
+
+    char buf[8];
+    char dest[16];
+    std::string lines;
+    size_t written = 0;
+
+    buffer_t obj = BUFFER_INIT(buf, sizeof(buf), true);
+    buffer_coro::channel channel(&obj);
+
+    // Suspends until the producer publishes a line
+    buffer_test_coro_reader(channel, &lines);
+    if(!lines.empty()){ errors += 1; }
+
+    buffer.Write(&obj, "Hi\nYou", 7);
+    if("Hi|" != lines){ errors += 1; }
+
+    buffer.Write(&obj, "\n", 1);
+    if("Hi|You|" != lines){ errors += 1; }
+
+    // The reader completes because the buffer is stopped
+    buffer.StopForce(&obj);
+    buffer.Start(&obj);
+
+    // Suspends until the consumer has made space, the reset continues the write
+    buffer_test_coro_writer(channel, "0123456789ABCDEF", &written);
+    if(0 != written){ errors += 1; }
+    if(8 != buffer.Read(&obj, dest, 9)){ errors += 1; }
+    if(16 != written){ errors += 1; }
+    if(8 != buffer.Read(&obj, dest, 9)){ errors += 1; }
+    if(0 != strcmp(dest, "89ABCDEF")){ errors += 1; }
+
+    // The pattern is split over several writes, each wake only searches the new characters
+    std::string text;
+
+    buffer_test_coro_read_to(channel, &text);
+    buffer.Write(&obj, "ab", 2);
+    buffer.Write(&obj, "ce", 2);
+    buffer.Write(&obj, "o", 1);
+    if(!text.empty()){ errors += 1; }
+
+    buffer.Write(&obj, "t", 1);
+    if("abc" != text){ errors += 1; }
+    if(0 != buffer.Length(&obj)){ errors += 1; }
+
+    return errors;
+}
+
+#endif
+
 
 /*---------------------------------------------------------------------*
  *  public:  functions
@@ -128,6 +225,9 @@ int buffer_testbench_cpp(void)
 
     errors += buffer_test_some_working_nothing_special();
     errors += buffer_test_threads();
+#if defined(__cpp_impl_coroutine)
+    errors += buffer_test_coro();
+#endif
 
     return errors;
 }